@@ -0,0 +1,49 @@
+#ifndef HALMET_SRC_ADS1115_RANGE_H_
+#define HALMET_SRC_ADS1115_RANGE_H_
+
+#include <math.h>
+
+namespace halmet {
+
+// Full-scale input ranges of the ADS1115 PGA settings, in volts, from the
+// lowest gain (2/3) to the highest (16)
+constexpr float kADS1115FullScale[] = {6.144, 4.096, 2.048, 1.024, 0.512,
+                                       0.256};
+constexpr int kADS1115Ranges =
+    sizeof(kADS1115FullScale) / sizeof(kADS1115FullScale[0]);
+
+// A reading above this fraction of full scale may have clipped
+constexpr float kADS1115ClipFraction = 0.95;
+// Switch to a higher gain only if the reading stays below this fraction of
+// the higher gain's full scale. The gap to kADS1115ClipFraction is the
+// hysteresis that keeps the range from toggling on a noisy input.
+constexpr float kADS1115UpshiftFraction = 0.8;
+
+/**
+ * @brief Select the ADS1115 range for the next reading of a channel.
+ *
+ * Returns the index into kADS1115FullScale with the highest gain that the
+ * reading volts, taken in range current, fits in with margin. A reading
+ * that may have clipped says nothing about the real input, so that returns
+ * the widest normal range, widest, to start over from, or one step wider
+ * if the reading was already taken at widest or wider.
+ */
+inline int SelectADS1115Range(int current, float volts, int widest = 1) {
+  float magnitude = fabsf(volts);
+  if (magnitude >= kADS1115ClipFraction * kADS1115FullScale[current]) {
+    if (current > widest) {
+      return widest;
+    }
+    return current > 0 ? current - 1 : 0;
+  }
+  int range = current;
+  while (range + 1 < kADS1115Ranges &&
+         magnitude < kADS1115UpshiftFraction * kADS1115FullScale[range + 1]) {
+    range++;
+  }
+  return range;
+}
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_ADS1115_RANGE_H_
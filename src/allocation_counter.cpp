@@ -0,0 +1,134 @@
+#include "allocation_counter.h"
+
+#include "graph_arena.h"
+#include "sensesp/ui/status_page_item.h"
+#include "sensesp_base_app.h"
+
+#ifdef ENABLE_ALLOCATION_COUNTER
+
+// Only the watched task writes the counters, so no lock is needed
+static TaskHandle_t watched_task = nullptr;
+static volatile uint32_t allocation_counts[halmet::kNumAllocationSources] = {};
+static volatile halmet::AllocationSource allocation_source =
+    halmet::AllocationSource::kOther;
+
+static inline void CountAllocation() {
+  if (watched_task != nullptr &&
+      xTaskGetCurrentTaskHandle() == watched_task) {
+    size_t source = static_cast<size_t>(allocation_source);
+    allocation_counts[source] = allocation_counts[source] + 1;
+  }
+}
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  CountAllocation();
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+  CountAllocation();
+  return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  CountAllocation();
+  return __real_realloc(ptr, size);
+}
+}
+
+#endif
+
+namespace halmet {
+
+#ifdef ENABLE_ALLOCATION_COUNTER
+AllocationSource CurrentAllocationSource() { return allocation_source; }
+
+void SetAllocationSource(AllocationSource source) {
+  allocation_source = source;
+}
+#endif
+
+uint32_t LoopAllocationCount(AllocationSource source) {
+#ifdef ENABLE_ALLOCATION_COUNTER
+  return allocation_counts[static_cast<size_t>(source)];
+#else
+  return 0;
+#endif
+}
+
+uint32_t LoopAllocationCount() {
+  uint32_t count = 0;
+  for (size_t i = 0; i < kNumAllocationSources; i++) {
+    count += LoopAllocationCount(static_cast<AllocationSource>(i));
+  }
+  return count;
+}
+
+AllocationMonitor::AllocationMonitor(unsigned int warm_up,
+                                     unsigned int report_interval)
+    : failed_{false} {
+#ifdef ENABLE_ALLOCATION_COUNTER
+  watched_task = xTaskGetCurrentTaskHandle();
+#else
+  debugW("AllocationMonitor: built without ENABLE_ALLOCATION_COUNTER");
+#endif
+  sensesp::event_loop()->onTick([this]() { this->ticks_++; });
+  sensesp::event_loop()->onDelay(warm_up, [this, report_interval]() {
+    start_interval();
+    sensesp::event_loop()->onRepeat(report_interval,
+                                    [this]() { this->report(); });
+  });
+}
+
+void AllocationMonitor::start_interval() {
+  for (size_t i = 0; i < kNumAllocationSources; i++) {
+    last_counts_[i] = LoopAllocationCount(static_cast<AllocationSource>(i));
+  }
+  ticks_ = 0;
+}
+
+void AllocationMonitor::report() {
+  uint32_t allocations[kNumAllocationSources];
+  uint32_t total = 0;
+  for (size_t i = 0; i < kNumAllocationSources; i++) {
+    allocations[i] = LoopAllocationCount(static_cast<AllocationSource>(i)) -
+                     last_counts_[i];
+    total += allocations[i];
+  }
+  uint32_t sample =
+      allocations[static_cast<size_t>(AllocationSource::kSample)];
+  uint32_t signalk =
+      allocations[static_cast<size_t>(AllocationSource::kSignalK)];
+  uint32_t other = allocations[static_cast<size_t>(AllocationSource::kOther)];
+  if (sample > 0) {
+    debugE("Event loop: %u heap allocations in the sample code in %u ticks "
+           "after warm-up (%u Signal K, %u other)",
+           sample, ticks_, signalk, other);
+    if (!failed_.get()) {
+      failed_.set(true);
+    }
+  } else {
+    debugI("Event loop: %u heap allocations in %u ticks, none in the sample "
+           "code (%u Signal K, %u other)",
+           total, ticks_, signalk, other);
+  }
+  allocations_.set(total);
+  // Count from after this report, which allocates for logging
+  start_interval();
+}
+
+AllocationMonitor* ConnectAllocationMonitor() {
+  auto monitor = GraphNew<AllocationMonitor>();
+  monitor->allocations_.connect_to(GraphNew<sensesp::StatusPageItem<int>>(
+      "Loop heap allocations", 0, "Diagnostics", 2020));
+  monitor->failed_.connect_to(GraphNew<sensesp::StatusPageItem<bool>>(
+      "Sample code allocates after warm-up", false, "Diagnostics", 2021));
+  return monitor;
+}
+
+}  // namespace halmet
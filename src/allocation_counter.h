@@ -0,0 +1,58 @@
+#ifndef HALMET_SRC_ALLOCATION_COUNTER_H_
+#define HALMET_SRC_ALLOCATION_COUNTER_H_
+
+#include <Arduino.h>
+
+#include "allocation_scope.h"
+#include "sensesp/system/observablevalue.h"
+
+namespace halmet {
+
+/// Number of malloc, calloc and realloc calls made so far by the task that
+/// constructed the AllocationMonitor. Always 0 before that.
+uint32_t LoopAllocationCount();
+
+/// The part of LoopAllocationCount() made inside AllocationScopes of source,
+/// or outside any scope for AllocationSource::kOther.
+uint32_t LoopAllocationCount(AllocationSource source);
+
+/**
+ * @brief Heap allocations made by the event loop once the graph has warmed up.
+ *
+ * Needs ENABLE_ALLOCATION_COUNTER and the linker flags
+ * -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc, which route all
+ * allocations, including operator new and String, through a counter. Only
+ * the allocations of the task that constructs the monitor are counted,
+ * normally the Arduino loop task, because WiFi and lwIP allocate in their
+ * own tasks.
+ *
+ * After warm_up ms, the allocations in each report interval are logged,
+ * per AllocationSource, and their total is set on allocations_. Signal K
+ * output and SensESP's own code are expected to allocate; the per-sample
+ * code, marked with AllocationScope(AllocationSource::kSample), is not. The
+ * first interval in which it allocates sets failed_, which stays set until
+ * a restart, and every such interval is logged as an error.
+ */
+class AllocationMonitor {
+ public:
+  AllocationMonitor(unsigned int warm_up = 60000,
+                    unsigned int report_interval = 60000);
+
+  sensesp::ObservableValue<int> allocations_;  // per report interval
+  sensesp::ObservableValue<bool> failed_;  // sample code allocated after warm-up
+
+ protected:
+  void report();
+  void start_interval();
+
+  uint32_t last_counts_[kNumAllocationSources] = {};
+  uint32_t ticks_ = 0;
+};
+
+/// Create an AllocationMonitor and show its results in the Diagnostics
+/// group of the web UI status page.
+AllocationMonitor* ConnectAllocationMonitor();
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_ALLOCATION_COUNTER_H_
@@ -0,0 +1,55 @@
+#ifndef HALMET_SRC_ALLOCATION_SCOPE_H_
+#define HALMET_SRC_ALLOCATION_SCOPE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace halmet {
+
+/**
+ * @brief The code that an event loop heap allocation is counted against.
+ *
+ * kSample is the per-sample code: sensor reads, the transforms they feed,
+ * throttles and the NMEA 2000 senders. It should never allocate once the
+ * graph has warmed up. kSignalK is the Signal K output path, which queues
+ * and serializes deltas. Everything else, such as SensESP's own timers and
+ * the web UI, is kOther.
+ */
+enum class AllocationSource : uint8_t { kOther, kSample, kSignalK };
+
+const size_t kNumAllocationSources = 3;
+
+#ifdef ENABLE_ALLOCATION_COUNTER
+AllocationSource CurrentAllocationSource();
+void SetAllocationSource(AllocationSource source);
+
+/**
+ * @brief Count the allocations made while this object lives against source.
+ *
+ * Scopes nest; the innermost one counts. Only use this in event loop
+ * callbacks: the source is global and only the event loop task is counted.
+ */
+class AllocationScope {
+ public:
+  explicit AllocationScope(AllocationSource source)
+      : previous_{CurrentAllocationSource()} {
+    SetAllocationSource(source);
+  }
+  ~AllocationScope() { SetAllocationSource(previous_); }
+
+  AllocationScope(const AllocationScope&) = delete;
+  AllocationScope& operator=(const AllocationScope&) = delete;
+
+ protected:
+  AllocationSource previous_;
+};
+#else
+class AllocationScope {
+ public:
+  explicit AllocationScope(AllocationSource) {}
+};
+#endif
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_ALLOCATION_SCOPE_H_
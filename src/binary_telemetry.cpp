@@ -0,0 +1,230 @@
+#include "binary_telemetry.h"
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <lwip/sockets.h>
+
+#include <cstring>
+
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+static const uint16_t kTelemetryMagic = 0x5448;  // "HT"
+static const int16_t kNotAvailable = INT16_MIN;
+
+static uint8_t* Put16(uint8_t* p, uint16_t value) {
+  p[0] = value & 0xff;
+  p[1] = value >> 8;
+  return p + 2;
+}
+
+static uint8_t* Put32(uint8_t* p, uint32_t value) {
+  return Put16(Put16(p, value & 0xffff), value >> 16);
+}
+
+void TelemetryChannel::set(const float& value) {
+  value_ = value;
+  updated_ms_ = millis();
+}
+
+BinaryTelemetry::BinaryTelemetry(const String& config_path,
+                                 unsigned int interval, uint16_t port)
+    : sensesp::FileSystemSaveable{config_path},
+      interval_{interval},
+      port_{port} {
+  load();
+}
+
+TelemetryChannel* BinaryTelemetry::add_channel(const char* name,
+                                               const char* unit, float scale) {
+  if (num_channels_ >= kMaxChannels) {
+    debugE("BinaryTelemetry: Too many channels");
+    return nullptr;
+  }
+  TelemetryChannel* channel = &channels_[num_channels_++];
+  channel->name_ = name;
+  channel->unit_ = unit;
+  channel->scale_ = scale;
+  return channel;
+}
+
+bool BinaryTelemetry::begin() {
+  schema_id_ = compute_schema_id();
+  if (!enabled_) {
+    return false;
+  }
+  in_addr destination;
+  if (inet_aton(address_.c_str(), &destination) == 0) {
+    debugE("BinaryTelemetry: Invalid address %s", address_.c_str());
+    return false;
+  }
+  destination_ = destination.s_addr;
+  socket_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (socket_ < 0) {
+    debugE("BinaryTelemetry: Cannot create socket");
+    return false;
+  }
+  int broadcast = 1;
+  setsockopt(socket_, SOL_SOCKET, SO_BROADCAST, &broadcast,
+             sizeof(broadcast));
+
+  sensesp::event_loop()->onRepeat(interval_, [this]() { this->send(); });
+  return true;
+}
+
+uint16_t BinaryTelemetry::compute_schema_id() const {
+  // FNV-1a over the channel descriptions, folded to 16 bits
+  uint32_t hash = 2166136261u;
+  auto add = [&hash](const void* data, size_t size) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+      hash = (hash ^ bytes[i]) * 16777619u;
+    }
+  };
+  for (size_t i = 0; i < num_channels_; i++) {
+    add(channels_[i].name_, strlen(channels_[i].name_));
+    add(channels_[i].unit_, strlen(channels_[i].unit_));
+    add(&channels_[i].scale_, sizeof(float));
+  }
+  return (hash >> 16) ^ (hash & 0xffff);
+}
+
+size_t BinaryTelemetry::encode(uint8_t* buffer) {
+  uint32_t now = millis();
+  uint8_t* p = buffer;
+  p = Put16(p, kTelemetryMagic);
+  *p++ = kVersion;
+  *p++ = num_channels_;
+  p = Put16(p, sequence_++);
+  p = Put16(p, schema_id_);
+  p = Put32(p, now);
+
+  for (size_t i = 0; i < num_channels_; i++) {
+    const TelemetryChannel& channel = channels_[i];
+    *p++ = i;
+    uint32_t age = now - channel.updated_ms_;
+    p = Put16(p, age > 0xffff ? 0xffff : age);
+    int16_t packed = kNotAvailable;
+    if (!isnan(channel.value_)) {
+      packed = constrain(lroundf(channel.value_ * channel.scale_), -32767L,
+                         32767L);
+    }
+    p = Put16(p, packed);
+  }
+  return p - buffer;
+}
+
+void BinaryTelemetry::send() {
+  sockaddr_in destination = {};
+  destination.sin_family = AF_INET;
+  destination.sin_port = htons(port_);
+  destination.sin_addr.s_addr = destination_;
+
+  size_t size = encode(frame_);
+  sendto(socket_, frame_, size, 0,
+         reinterpret_cast<sockaddr*>(&destination), sizeof(destination));
+}
+
+esp_err_t BinaryTelemetry::handle_schema(httpd_req_t* req) {
+  JsonDocument doc;
+  doc["version"] = kVersion;
+  doc["schema_id"] = schema_id_;
+  doc["port"] = port_;
+  doc["interval"] = interval_;
+  doc["header_size"] = kHeaderSize;
+  doc["channel_size"] = kChannelSize;
+  JsonArray channels = doc["channels"].to<JsonArray>();
+  for (size_t i = 0; i < num_channels_; i++) {
+    JsonObject channel = channels.add<JsonObject>();
+    channel["id"] = i;
+    channel["name"] = channels_[i].name_;
+    channel["unit"] = channels_[i].unit_;
+    channel["scale"] = channels_[i].scale_;
+  }
+  String response;
+  serializeJson(doc, response);
+  httpd_resp_set_type(req, "application/json");
+  return httpd_resp_send(req, response.c_str(), response.length());
+}
+
+void BinaryTelemetry::benchmark(unsigned int iterations) {
+  int loopback = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (loopback < 0) {
+    debugE("BinaryTelemetry: Cannot create benchmark socket");
+    return;
+  }
+  sockaddr_in destination = {};
+  destination.sin_family = AF_INET;
+  destination.sin_port = htons(port_);
+  destination.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  auto address = reinterpret_cast<sockaddr*>(&destination);
+
+  uint8_t frame[kMaxFrameSize];
+  size_t binary_size = 0;
+  uint32_t start = micros();
+  for (unsigned int i = 0; i < iterations; i++) {
+    binary_size = encode(frame);
+    sendto(loopback, frame, binary_size, 0, address, sizeof(destination));
+  }
+  uint32_t binary_us = micros() - start;
+
+  // The same values as one Signal K delta, as sent over the websocket
+  size_t json_size = 0;
+  start = micros();
+  for (unsigned int i = 0; i < iterations; i++) {
+    JsonDocument doc;
+    JsonObject update = doc["updates"].add<JsonObject>();
+    update["$source"] = "halmet";
+    JsonArray values = update["values"].to<JsonArray>();
+    for (size_t c = 0; c < num_channels_; c++) {
+      JsonObject value = values.add<JsonObject>();
+      value["path"] = channels_[c].name_;
+      value["value"] = channels_[c].value_;
+    }
+    String json;
+    json_size = serializeJson(doc, json);
+    sendto(loopback, json.c_str(), json_size, 0, address,
+           sizeof(destination));
+  }
+  uint32_t json_us = micros() - start;
+  close(loopback);
+
+  debugI(
+      "Telemetry benchmark, %u channels: binary %.0f msg/s (%u bytes), "
+      "JSON %.0f msg/s (%u bytes)",
+      num_channels_, iterations * 1e6f / binary_us, binary_size,
+      iterations * 1e6f / json_us, json_size);
+}
+
+bool BinaryTelemetry::to_json(JsonObject& root) {
+  root["enabled"] = enabled_;
+  root["address"] = address_;
+  root["port"] = port_;
+  root["interval"] = interval_;
+  return true;
+}
+
+bool BinaryTelemetry::from_json(const JsonObject& config) {
+  if (!config["enabled"].is<bool>() || !config["address"].is<String>() ||
+      !config["port"].is<int>() || !config["interval"].is<int>()) {
+    return false;
+  }
+  int port = config["port"];
+  int interval = config["interval"];
+  String address = config["address"].as<String>();
+  // inet_addr() would map an invalid address to the broadcast address
+  in_addr parsed;
+  if (interval <= 0 || port < 1 || port > 65535 ||
+      inet_aton(address.c_str(), &parsed) == 0) {
+    debugE("BinaryTelemetry: Invalid address, port or interval");
+    return false;
+  }
+  enabled_ = config["enabled"];
+  address_ = address;
+  port_ = port;
+  interval_ = interval;
+  return true;
+}
+
+}  // namespace halmet
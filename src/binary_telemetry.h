@@ -0,0 +1,118 @@
+#ifndef HALMET_SRC_BINARY_TELEMETRY_H_
+#define HALMET_SRC_BINARY_TELEMETRY_H_
+
+#include <esp_http_server.h>
+
+#include "sensesp/system/saveable.h"
+#include "sensesp/system/valueconsumer.h"
+
+namespace halmet {
+
+/**
+ * @brief One value carried by the binary telemetry stream.
+ */
+class TelemetryChannel : public sensesp::ValueConsumer<float> {
+ public:
+  void set(const float& value) override;
+
+  const char* name_ = nullptr;  // Signal K path of the equivalent output
+  const char* unit_ = nullptr;
+  float scale_ = 1;  // packed units per value unit
+  float value_ = NAN;
+  uint32_t updated_ms_ = 0;
+};
+
+/**
+ * @brief Fixed-schema binary telemetry over UDP.
+ *
+ * Every interval ms, the latest value of each channel is packed into one
+ * datagram and sent to the configured address, by default the broadcast
+ * address. The frame is built in a static buffer; nothing is allocated
+ * per message. All integers are little-endian:
+ *
+ *   header, 12 bytes:
+ *     uint16 magic 0x5448 ("HT"), uint8 version, uint8 channel count,
+ *     uint16 sequence, uint16 schema id, uint32 timestamp (ms since boot)
+ *   per channel, 5 bytes:
+ *     uint8 channel id, uint16 age of the value (ms, saturating),
+ *     int16 value * scale (-32768 if not available)
+ *
+ * The channel names, units and scales are served once as JSON from
+ * /telemetry/schema. The schema id is a hash of that schema, so clients
+ * can tell when they need to fetch it again. tools/telemetry_decode.py is
+ * a reference decoder.
+ */
+class BinaryTelemetry : public sensesp::FileSystemSaveable {
+ public:
+  static const size_t kMaxChannels = 16;
+  static const uint8_t kVersion = 1;
+  static const size_t kHeaderSize = 12;
+  static const size_t kChannelSize = 5;
+  static const size_t kMaxFrameSize =
+      kHeaderSize + kMaxChannels * kChannelSize;
+
+  BinaryTelemetry(const String& config_path, unsigned int interval = 100,
+                  uint16_t port = 4210);
+
+  /**
+   * @brief Add a channel. Must be called before begin().
+   *
+   * @param name Signal K path of the equivalent output
+   * @param scale Packed units per value unit, e.g. 100 for 0.01 resolution
+   * @return nullptr if the channel table is full
+   */
+  TelemetryChannel* add_channel(const char* name, const char* unit,
+                                float scale);
+
+  /// Open the socket and start sending.
+  bool begin();
+
+  /// Pack the current values into buffer. Returns the frame size.
+  size_t encode(uint8_t* buffer);
+
+  esp_err_t handle_schema(httpd_req_t* req);
+
+  /// Compare the cost of sending the channels as binary frames and as
+  /// Signal K JSON deltas over the loopback interface, and log the result.
+  void benchmark(unsigned int iterations = 1000);
+
+  virtual bool to_json(JsonObject& root) override;
+  virtual bool from_json(const JsonObject& config) override;
+
+ protected:
+  void send();
+  uint16_t compute_schema_id() const;
+
+  unsigned int interval_;
+  uint16_t port_;
+  String address_ = "255.255.255.255";
+  bool enabled_ = true;
+
+  TelemetryChannel channels_[kMaxChannels];
+  size_t num_channels_ = 0;
+  uint16_t sequence_ = 0;
+  uint16_t schema_id_ = 0;
+  uint32_t destination_ = 0;  // IPv4 address, network byte order
+  int socket_ = -1;
+  uint8_t frame_[kMaxFrameSize];
+};
+
+inline const String ConfigSchema(const BinaryTelemetry& obj) {
+  return R"###({
+    "type": "object",
+    "properties": {
+      "enabled": { "title": "Enabled", "type": "boolean" },
+      "address": { "title": "Destination address", "type": "string", "description": "IPv4 address of the receiver, or 255.255.255.255 to broadcast" },
+      "port": { "title": "UDP port", "type": "integer", "minimum": 1, "maximum": 65535 },
+      "interval": { "title": "Interval", "type": "integer", "minimum": 1, "description": "Time between frames (ms)" }
+    }
+  })###";
+}
+
+inline const bool ConfigRequiresRestart(const BinaryTelemetry& obj) {
+  return true;
+}
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_BINARY_TELEMETRY_H_
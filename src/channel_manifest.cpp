@@ -0,0 +1,729 @@
+#include "channel_manifest.h"
+
+#include <ArduinoJson.h>
+#include <SPIFFS.h>
+
+#include <cstdarg>
+#include <memory>
+
+#include "graph_arena.h"
+#include "halmet_analog.h"
+#include "halmet_const.h"
+#include "halmet_digital.h"
+#include "halmet_display.h"
+#include "n2k_senders.h"
+#include "sensesp/sensors/digital_input.h"
+#include "sensesp/signalk/signalk_output.h"
+#include "sensesp/system/lambda_consumer.h"
+#include "sensesp/transforms/curveinterpolator.h"
+#include "sensesp/transforms/lambda_transform.h"
+#include "sensesp/transforms/linear.h"
+#include "sensesp/transforms/time_counter.h"
+#include "sensesp/ui/config_item.h"
+#include "sk_demand.h"
+#include "tacho_self_test.h"
+#include "throttle.h"
+
+#ifdef ENABLE_ONE_WIRE
+#include "sensesp_onewire/onewire_temperature.h"
+#endif
+
+namespace halmet {
+
+namespace {
+
+using sensesp::BoolProducer;
+using sensesp::FloatProducer;
+
+const int kMaxEngines = 2;
+
+/// Format a string into storage that lives as long as the sensor graph.
+const char* Format(const char* format, ...) {
+  char buffer[128];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  return GraphStrdup(buffer);
+}
+
+int DigitalInputPin(int input) {
+  const int pins[] = {sensesp::kDigitalInputPin1, sensesp::kDigitalInputPin2,
+                      sensesp::kDigitalInputPin3, sensesp::kDigitalInputPin4};
+  return pins[input - 1];
+}
+
+/// Sender limits of a channel: the defaults, with any values given in its
+/// optional "limits" object replaced.
+SenderLimits ReadSenderLimits(JsonObject channel,
+                              const SenderLimits& defaults) {
+  JsonObject limits = channel["limits"];
+  if (limits.isNull()) {
+    return defaults;
+  }
+  return {limits["short"] | defaults.short_ohms,
+          limits["min"] | defaults.min_ohms, limits["max"] | defaults.max_ohms,
+          limits["open"] | defaults.open_ohms};
+}
+
+/// Expand a channel string pattern from halmet_channels.h into storage that
+/// lives as long as the sensor graph.
+const char* Expand(const char* pattern, const char* name, const char* sk_id) {
+  char buffer[128];
+  ExpandChannelString(pattern, name, sk_id, buffer, sizeof(buffer));
+  return GraphStrdup(buffer);
+}
+
+// Runtime counterparts of the HALMET_*_CHANNEL macros in halmet_channels.h.
+// Both expand the same string lists, so a channel keeps its configuration
+// when it moves between the manifest and the compiled-in table.
+
+#define HALMET_EXPAND_CHANNEL_STRING(FIELD, PATTERN) \
+  result.FIELD = Expand(PATTERN, name, sk_id);
+
+TankChannel MakeTankChannel(int channel, const char* name, const char* sk_id,
+                            int sort_order, const SenderLimits& limits) {
+  TankChannel result{};
+  result.channel = channel;
+  result.sort_order = sort_order;
+  HALMET_TANK_CHANNEL_STRINGS(HALMET_EXPAND_CHANNEL_STRING,
+                              HALMET_CHANNEL_NAME, HALMET_CHANNEL_SK_ID)
+  result.limits = limits;
+  return result;
+}
+
+TemperatureChannel MakeTemperatureChannel(int channel, const char* name,
+                                          const char* sk_id, int sort_order,
+                                          const SenderLimits& limits) {
+  TemperatureChannel result{};
+  result.channel = channel;
+  result.sort_order = sort_order;
+  HALMET_TEMPERATURE_CHANNEL_STRINGS(HALMET_EXPAND_CHANNEL_STRING,
+                                     HALMET_CHANNEL_NAME, HALMET_CHANNEL_SK_ID)
+  result.limits = limits;
+  return result;
+}
+
+OilPressureChannel MakeOilPressureChannel(int channel, const char* name,
+                                          const char* sk_id, int sort_order,
+                                          const SenderLimits& limits) {
+  OilPressureChannel result{};
+  result.channel = channel;
+  result.sort_order = sort_order;
+  HALMET_OIL_PRESSURE_CHANNEL_STRINGS(HALMET_EXPAND_CHANNEL_STRING,
+                                      HALMET_CHANNEL_NAME, HALMET_CHANNEL_SK_ID)
+  result.limits = limits;
+  return result;
+}
+
+TachoChannel MakeTachoChannel(int pin, const char* name) {
+  const char* sk_id = "";
+  TachoChannel result{};
+  result.pin = pin;
+  HALMET_TACHO_CHANNEL_STRINGS(HALMET_EXPAND_CHANNEL_STRING,
+                               HALMET_CHANNEL_NAME, HALMET_CHANNEL_SK_ID)
+  return result;
+}
+
+#undef HALMET_EXPAND_CHANNEL_STRING
+
+/// Engine status 1 flags that an alarm input can drive.
+struct EngineFlag {
+  const char* name;
+  std::shared_ptr<sensesp::RepeatExpiring<bool>>
+      N2kEngineParameterDynamicSender::*member;
+};
+
+const EngineFlag kEngineFlags[] = {
+    {"over_temperature", &N2kEngineParameterDynamicSender::over_temperature_},
+    {"low_oil_pressure", &N2kEngineParameterDynamicSender::low_oil_pressure_},
+    {"low_oil_level", &N2kEngineParameterDynamicSender::low_oil_level_},
+    {"low_fuel_pressure", &N2kEngineParameterDynamicSender::low_fuel_pressure_},
+    {"low_system_voltage",
+     &N2kEngineParameterDynamicSender::low_system_voltage_},
+    {"low_coolant_level", &N2kEngineParameterDynamicSender::low_coolant_level_},
+    {"water_flow", &N2kEngineParameterDynamicSender::water_flow_},
+    {"water_in_fuel", &N2kEngineParameterDynamicSender::water_in_fuel_},
+    {"charge_indicator", &N2kEngineParameterDynamicSender::charge_indicator_},
+    {"preheat_indicator", &N2kEngineParameterDynamicSender::preheat_indicator_},
+};
+
+const EngineFlag* FindEngineFlag(const char* name) {
+  for (const auto& flag : kEngineFlags) {
+    if (strcmp(flag.name, name) == 0) {
+      return &flag;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Builds the nodes for one manifest. Engine senders are created the
+ * first time a channel refers to their instance.
+ */
+class ManifestBuilder {
+ public:
+  ManifestBuilder(const ManifestContext& context, ChannelGraph* graph)
+      : context_{context}, graph_{graph} {}
+
+  bool validate(JsonArray channels) {
+    bool adc_used[4] = {};
+    bool input_used[4] = {};
+    bool display_row_used[kDisplayRows] = {};
+#ifdef ENABLE_FUEL_FLOW_METER
+    // D4 counts the fuel flow meter
+    input_used[3] = true;
+#endif
+    bool valid = true;
+    int index = 0;
+    for (JsonObject channel : channels) {
+      const char* type = channel["type"] | "";
+      const char* error = nullptr;
+      bool resistive = strcmp(type, "tank") == 0 ||
+                       strcmp(type, "temperature") == 0 ||
+                       strcmp(type, "oil_pressure") == 0;
+      if (strcmp(type, "tank") == 0 || strcmp(type, "temperature") == 0 ||
+          strcmp(type, "voltage") == 0) {
+        if (!channel["name"].is<const char*>()) error = "missing name";
+      }
+      if (strcmp(type, "oil_pressure") == 0 && !channel["name"].isNull() &&
+          !channel["name"].is<const char*>()) {
+        error = "name must be a string";
+      }
+      if (resistive) {
+        if (!channel["sk_id"].is<const char*>()) error = "missing sk_id";
+      }
+      if (resistive || strcmp(type, "voltage") == 0) {
+        int adc = channel["channel"] | -1;
+        if (adc < 0 || adc > 3) {
+          error = "channel must be 0-3";
+        } else if (adc_used[adc]) {
+          error = "ADC channel used twice";
+        } else {
+          adc_used[adc] = true;
+        }
+      } else if (strcmp(type, "tacho") == 0 || strcmp(type, "alarm") == 0) {
+        int input = channel["input"] | 0;
+        if (!channel["name"].is<const char*>()) {
+          error = "missing name";
+        } else if (input < 1 || input > 4) {
+          error = "input must be 1-4";
+        } else if (input_used[input - 1]) {
+          error = "digital input used twice";
+        } else {
+          input_used[input - 1] = true;
+        }
+      } else if (strcmp(type, "onewire") == 0) {
+#ifdef ENABLE_ONE_WIRE
+        if (!channel["name"].is<const char*>() ||
+            !channel["config_path"].is<const char*>()) {
+          error = "missing name or config_path";
+        }
+#else
+        error = "firmware built without ENABLE_ONE_WIRE";
+#endif
+      } else {
+        error = "unknown type";
+      }
+      if (!channel["limits"].isNull()) {
+        if (!resistive) {
+          error = "limits only apply to resistive senders";
+        } else if (!valid_limits(channel["limits"])) {
+          error = "limits must map short/min/max/open to ohms";
+        }
+      }
+      if (!channel["engine_flag"].isNull() &&
+          (!channel["engine_flag"].is<const char*>() ||
+           FindEngineFlag(channel["engine_flag"]) == nullptr)) {
+        error = "unknown engine_flag";
+      }
+      if (!channel["engine"].isNull()) {
+        int engine = channel["engine"] | -1;
+        if (!channel["engine"].is<int>() || engine < 0 ||
+            engine >= kMaxEngines) {
+          error = "engine instance out of range";
+        }
+      }
+      if (!channel["display_row"].isNull()) {
+        int row = channel["display_row"] | -1;
+        if (!channel["display_row"].is<int>() || row < kFirstValueRow ||
+            row >= kDisplayRows) {
+          error = "display_row must be 2-7";
+        } else if (display_row_used[row]) {
+          error = "display row used twice";
+        } else {
+          display_row_used[row] = true;
+        }
+      }
+      if (is_duplicate(channels, index)) {
+        error = "another channel of this type has the same name";
+      }
+      if (error != nullptr) {
+        debugE("Channel manifest: channel %d (%s): %s", index, type, error);
+        valid = false;
+      }
+      index++;
+    }
+    return valid;
+  }
+
+  void build(JsonObject manifest) {
+    onewire_pin_ = manifest["onewire_pin"] | 4;
+    for (JsonObject channel : manifest["channels"].as<JsonArray>()) {
+      const char* type = channel["type"];
+      if (strcmp(type, "tank") == 0) {
+        build_tank(channel);
+      } else if (strcmp(type, "temperature") == 0) {
+        build_temperature(channel);
+      } else if (strcmp(type, "oil_pressure") == 0) {
+        build_oil_pressure(channel);
+      } else if (strcmp(type, "voltage") == 0) {
+        build_voltage(channel);
+      } else if (strcmp(type, "tacho") == 0) {
+        build_tacho(channel);
+      } else if (strcmp(type, "alarm") == 0) {
+        build_alarm(channel);
+      } else if (strcmp(type, "onewire") == 0) {
+        build_onewire(channel);
+      }
+    }
+    graph_->engine_dynamic_sender = dynamic_senders_[0];
+    graph_->engine_rapid_sender = rapid_senders_[0];
+  }
+
+ private:
+  /// Name of a channel, which its config paths are derived from
+  static const char* channel_name(JsonObject channel) {
+    if (strcmp(channel["type"] | "", "oil_pressure") == 0) {
+      return channel["name"] | "Oil";
+    }
+    return channel["name"] | "";
+  }
+
+  /// True if a channel before the one at index has the same type and name,
+  /// and so would share its saved configuration.
+  static bool is_duplicate(JsonArray channels, int index) {
+    JsonObject channel = channels[index];
+    const char* type = channel["type"] | "";
+    const char* name = channel_name(channel);
+    if (*name == '\0') {
+      return false;
+    }
+    for (int i = 0; i < index; i++) {
+      JsonObject other = channels[i];
+      if (strcmp(other["type"] | "", type) == 0 &&
+          strcmp(channel_name(other), name) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static bool valid_limits(JsonVariant limits) {
+    if (!limits.is<JsonObject>()) {
+      return false;
+    }
+    for (JsonPair limit : limits.as<JsonObject>()) {
+      const char* key = limit.key().c_str();
+      if ((strcmp(key, "short") != 0 && strcmp(key, "min") != 0 &&
+           strcmp(key, "max") != 0 && strcmp(key, "open") != 0) ||
+          !limit.value().is<float>()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// True for the channels of engine instance 0, which the optional
+  /// features in setup() use.
+  static bool is_main_engine(JsonObject channel) {
+    return channel["engine"].is<int>() && channel["engine"].as<int>() == 0;
+  }
+
+  void build_tank(JsonObject channel) {
+    const char* name = channel["name"];
+    int sort_order = channel["sort_order"] | 3000;
+    auto tank_level = ConnectTankSender(
+        context_.ads1115,
+        MakeTankChannel(channel["channel"], name, channel["sk_id"], sort_order,
+                        ReadSenderLimits(channel, kTankSenderLimits)),
+        context_.enable_signalk_output);
+
+    bool is_fuel_tank = graph_->fuel_tank_level == nullptr &&
+                        strncmp(channel["sk_id"], "fuel.", 5) == 0;
+    if (is_fuel_tank) {
+      graph_->fuel_tank_level = tank_level;
+    }
+
+    if (context_.nmea2000 != nullptr && channel["n2k"].is<JsonObject>()) {
+      JsonObject n2k = channel["n2k"];
+      auto tank_sender = GraphNew<N2kFluidLevelSender>(
+          Format("/Tanks/%s/NMEA 2000", name), n2k["instance"] | 0,
+          static_cast<tN2kFluidType>(n2k["fluid_type"] | 0),
+          n2k["capacity"] | 0.0, context_.nmea2000);
+
+      ConfigItem(tank_sender)
+          ->set_title(Format("%s Tank NMEA 2000", name))
+          ->set_description(Format("NMEA 2000 tank sender for %s", name))
+          ->set_sort_order(sort_order + 5);
+
+      tank_level->connect_to(&(tank_sender->tank_level_));
+      if (is_fuel_tank) {
+        graph_->fuel_tank_sender = tank_sender;
+      }
+    }
+
+    connect_display_row(tank_level, channel, name, 100);
+  }
+
+  void build_temperature(JsonObject channel) {
+    const char* name = channel["name"];
+    auto temperature = ConnectTemperatureSensor(
+        context_.ads1115,
+        MakeTemperatureChannel(
+            channel["channel"], name, channel["sk_id"],
+            channel["sort_order"] | 3000,
+            ReadSenderLimits(channel, kTemperatureSenderLimits)),
+        context_.enable_signalk_output);
+
+    if (is_main_engine(channel)) {
+      graph_->coolant_temperature = temperature;
+    }
+
+    auto engine = engine_dynamic_sender(channel);
+    if (engine != nullptr) {
+      temperature->connect_to(engine->temperature_);
+    }
+
+    connect_display_row(temperature, channel, name, 1);
+  }
+
+  void build_oil_pressure(JsonObject channel) {
+    auto pressure_bar = ConnectOilPressureSensor(
+        context_.ads1115,
+        MakeOilPressureChannel(
+            channel["channel"], channel_name(channel), channel["sk_id"],
+            channel["sort_order"] | 3000,
+            ReadSenderLimits(channel, kOilPressureSenderLimits)),
+        context_.enable_signalk_output);
+
+    if (is_main_engine(channel)) {
+      graph_->oil_pressure = pressure_bar;
+    }
+
+    auto engine = engine_dynamic_sender(channel);
+    if (engine != nullptr) {
+      pressure_bar->connect_to(GraphNew<sensesp::Linear>(100.0, 0.0))  // bar → kPa
+          ->connect_to(engine->oil_pressure_);
+    }
+
+    connect_display_row(pressure_bar, channel, channel_name(channel), 1);
+  }
+
+  void build_voltage(JsonObject channel) {
+    const char* name = channel["name"];
+    auto voltage = GraphNew<ADS1115VoltageInput>(
+        context_.ads1115, channel["channel"], Format("/Voltage %s", name));
+
+    ConfigItem(voltage)
+        ->set_title(Format("Analog Voltage %s", name))
+        ->set_description(Format("Voltage level of analog input %s", name))
+        ->set_sort_order(channel["sort_order"] | 3000);
+
+#ifdef ENABLE_SIGNALK
+    if (channel["sk_path"].is<const char*>()) {
+      const char* title = Format("Analog Voltage %s", name);
+      voltage->connect_to(GraphNew<SKDemandGate<float>>())
+          ->connect_to(GraphNew<sensesp::SKOutputFloat>(
+          channel["sk_path"].as<const char*>(), title,
+          GraphNew<sensesp::SKMetadata>("V", title)));
+    }
+#endif
+
+    if (is_main_engine(channel)) {
+      graph_->alternator_voltage = voltage;
+    }
+
+    auto engine = engine_dynamic_sender(channel);
+    if (engine != nullptr) {
+      voltage->connect_to(engine->alternator_potential_);
+    }
+
+    connect_display_row(voltage, channel, name, 1);
+  }
+
+  void build_tacho(JsonObject channel) {
+    const char* name = channel["name"];
+    auto frequency = ConnectTachoSender(
+        MakeTachoChannel(DigitalInputPin(channel["input"]), name));
+
+    if (is_main_engine(channel)) {
+      graph_->engine_frequency = frequency;
+    }
+
+    auto rapid = engine_rapid_sender(channel);
+    if (rapid != nullptr) {
+      frequency->connect_to(&(rapid->engine_speed_));
+    }
+
+    if (context_.power_manager != nullptr && is_main_engine(channel)) {
+      frequency->connect_to(&(context_.power_manager->engine_frequency_));
+    }
+
+    if (channel["engine_hours"] | false) {
+      auto engine_hours = GraphNew<sensesp::TimeCounter<float>>(
+          Format("/Engine %s/Engine Hours", name));
+
+      ConfigItem(engine_hours)
+          ->set_title(Format("Engine %s Hours", name))
+          ->set_description(Format("Running time of engine %s", name))
+          ->set_sort_order(1300);
+
+#ifdef ENABLE_TACHO_SELF_TEST
+      // The self-test drives the engine 0 tacho input with a test signal,
+      // which is not engine running time
+      if (is_main_engine(channel)) {
+        frequency
+            ->connect_to(GraphNew<sensesp::LambdaTransform<float, float>>(
+                [](float hz) { return TachoSelfTestRunning() ? 0 : hz; }))
+            ->connect_to(engine_hours);
+      } else {
+        frequency->connect_to(engine_hours);
+      }
+#else
+      frequency->connect_to(engine_hours);
+#endif
+
+#ifdef ENABLE_SIGNALK
+      engine_hours->connect_to(GraphNew<sensesp::SKOutput<float>>(
+          Format("propulsion.%s.runTime", name), "",
+          GraphNew<sensesp::SKMetadata>(
+              "s", Format("Engine %s running time", name))));
+#endif
+
+      auto dynamic = engine_dynamic_sender(channel);
+      if (dynamic != nullptr) {
+        engine_hours
+            ->connect_to(GraphNew<sensesp::LambdaTransform<float, float>>(
+                [](float seconds) { return seconds / 3600.0f; }))
+            ->connect_to(dynamic->total_engine_hours_);
+      }
+    }
+
+    connect_display_row(frequency, channel, name, 60);  // Hz to RPM
+  }
+
+  void build_alarm(JsonObject channel) {
+    const char* name = channel["name"];
+    BoolProducer* alarm =
+        ConnectAlarmSender(DigitalInputPin(channel["input"]), name);
+
+    if (channel["inverted"] | false) {
+      alarm = alarm->connect_to(GraphNew<sensesp::LambdaTransform<bool, bool>>(
+          [](bool value) { return !value; }));
+    }
+
+    auto engine = engine_dynamic_sender(channel);
+    if (engine != nullptr && channel["engine_flag"].is<const char*>()) {
+      const EngineFlag* flag = FindEngineFlag(channel["engine_flag"]);
+      alarm->connect_to(engine->*(flag->member));
+    }
+
+    if (context_.nmea2000 != nullptr && channel["bilge_instance"].is<int>()) {
+      auto bilge_sender = GraphNew<N2kBilgeAlarmSender>(
+          Format("/Alarm %s/Bilge", name), channel["bilge_instance"].as<int>(),
+          alarm->get(), context_.nmea2000);
+      alarm->connect_to(&(bilge_sender->alarm_state_));
+    }
+  }
+
+  void build_onewire(JsonObject channel) {
+#ifdef ENABLE_ONE_WIRE
+    if (dts_ == nullptr) {
+      dts_ = GraphNew<sensesp::onewire::DallasTemperatureSensors>(onewire_pin_);
+    }
+    const char* name = channel["name"];
+    auto probe = GraphNew<sensesp::onewire::OneWireTemperature>(
+        dts_, channel["read_delay"] | 500,
+        channel["config_path"].as<const char*>());
+
+    ConfigItem(probe)
+        ->set_title(Format("1Wire Temp %s", name))
+        ->set_description(Format("Temp from 1 Wire sensor %s", name))
+        ->set_sort_order(channel["sort_order"] | 3100);
+
+#ifdef ENABLE_SIGNALK
+    if (channel["sk_path"].is<const char*>()) {
+      probe->connect_to(GraphNew<SKDemandGate<float>>())
+          ->connect_to(GraphNew<sensesp::SKOutputFloat>(
+          channel["sk_path"].as<const char*>(), name,
+          GraphNew<sensesp::SKMetadata>(
+              "K", Format("1Wire Temp Value %s", name))));
+    }
+#endif
+
+    if (context_.nmea2000 != nullptr && channel["exhaust_instance"].is<int>()) {
+      auto exhaust_sender = GraphNew<N2kExhaustTemperatureSender>(
+          Format("/Exhaust %s", name), channel["exhaust_instance"].as<int>(),
+          0.0, context_.nmea2000);
+      probe->connect_to(&(exhaust_sender->temperature_));
+    }
+
+    if (graph_->exhaust_temperature == nullptr &&
+        channel["exhaust_instance"].is<int>()) {
+      graph_->exhaust_temperature = probe;
+    }
+
+    connect_display_row(probe, channel, name, 1);
+#endif
+  }
+
+  void connect_display_row(FloatProducer* producer, JsonObject channel,
+                           const char* name, float scale) {
+    if (context_.display == nullptr || !channel["display_row"].is<int>()) {
+      return;
+    }
+    Adafruit_SSD1306* display = context_.display;
+    int row = channel["display_row"];
+    const char* title = GraphStrdup(channel["display_title"] | name);
+    producer->connect_to(GraphNew<Throttle<float>>(kDisplayUpdateInterval))
+        ->connect_to(GraphNew<sensesp::LambdaConsumer<float>>(
+            [display, row, title, scale](float value) {
+              PrintValue(display, row, title, scale * value);
+            }));
+  }
+
+  N2kEngineParameterDynamicSender* engine_dynamic_sender(JsonObject channel) {
+    if (context_.nmea2000 == nullptr || !channel["engine"].is<int>()) {
+      return nullptr;
+    }
+    int instance = channel["engine"];
+    if (dynamic_senders_[instance] == nullptr) {
+      auto sender = GraphNew<N2kEngineParameterDynamicSender>(
+          Format("/NMEA 2000/Engine %d Dynamic", instance + 1), instance,
+          context_.nmea2000);
+
+      ConfigItem(sender)
+          ->set_title(Format("Engine %d Dynamic", instance + 1))
+          ->set_description(
+              Format("NMEA 2000 dynamic engine parameters for engine %d",
+                     instance + 1))
+          ->set_sort_order(3010 + 20 * instance);
+
+      dynamic_senders_[instance] = sender;
+    }
+    return dynamic_senders_[instance];
+  }
+
+  N2kEngineParameterRapidSender* engine_rapid_sender(JsonObject channel) {
+    if (context_.nmea2000 == nullptr || !channel["engine"].is<int>()) {
+      return nullptr;
+    }
+    int instance = channel["engine"];
+    if (rapid_senders_[instance] == nullptr) {
+      auto sender = GraphNew<N2kEngineParameterRapidSender>(
+          Format("/NMEA 2000/Engine %d Rapid Update", instance + 1), instance,
+          context_.nmea2000);
+
+      ConfigItem(sender)
+          ->set_title(Format("Engine %d Rapid Update", instance + 1))
+          ->set_description(
+              Format("NMEA 2000 rapid update engine parameters for engine %d",
+                     instance + 1))
+          ->set_sort_order(3015 + 20 * instance);
+
+      rapid_senders_[instance] = sender;
+    }
+    return rapid_senders_[instance];
+  }
+
+  const ManifestContext& context_;
+  ChannelGraph* graph_;
+  int onewire_pin_ = 4;
+  N2kEngineParameterDynamicSender* dynamic_senders_[kMaxEngines] = {};
+  N2kEngineParameterRapidSender* rapid_senders_[kMaxEngines] = {};
+#ifdef ENABLE_ONE_WIRE
+  sensesp::onewire::DallasTemperatureSensors* dts_ = nullptr;
+#endif
+};
+
+}  // namespace
+
+bool BuildGraphFromManifest(const char* path, const ManifestContext& context,
+                            ChannelGraph* graph) {
+  if (!SPIFFS.exists(path)) {
+    debugI("No channel manifest at %s, using the compiled-in layout", path);
+    return false;
+  }
+
+  File file = SPIFFS.open(path, "r");
+  JsonDocument manifest;
+  DeserializationError error = deserializeJson(manifest, file);
+  file.close();
+  if (error) {
+    debugE("Channel manifest %s: %s", path, error.c_str());
+    return false;
+  }
+
+  ManifestBuilder builder(context, graph);
+  JsonArray channels = manifest["channels"];
+  if (channels.isNull() || !builder.validate(channels)) {
+    debugE("Channel manifest %s is invalid, using the compiled-in layout",
+           path);
+    return false;
+  }
+
+  builder.build(manifest.as<JsonObject>());
+  debugI("Built %u channels from %s", channels.size(), path);
+  return true;
+}
+
+#ifdef ENABLE_STATIC_ARENA
+template <typename T, typename... Others>
+constexpr size_t MaxSize() {
+  if constexpr (sizeof...(Others) == 0) {
+    return sizeof(T);
+  } else {
+    return sizeof(T) > MaxSize<Others...>() ? sizeof(T)
+                                            : MaxSize<Others...>();
+  }
+}
+
+void LogGraphNodeBytes() {
+  // The node kinds of NODE_BYTES in tools/manifest_check.py. A kind that
+  // stands for several types takes the largest.
+  const size_t sensor = MaxSize<
+#ifdef ENABLE_ONE_WIRE
+      sensesp::onewire::DallasTemperatureSensors,
+      sensesp::onewire::OneWireTemperature,
+#endif
+      ADS1115ResistanceInput, ADS1115VoltageInput,
+      sensesp::DigitalInputCounter, sensesp::DigitalInputState,
+      sensesp::TimeCounter<float>>();
+  const size_t sk_output =
+      MaxSize<sensesp::SKOutputFloat, sensesp::SKOutputInt,
+              sensesp::SKOutputBool, sensesp::SKOutput<float>>() +
+      sizeof(sensesp::SKMetadata);
+  const size_t lambda = MaxSize<sensesp::LambdaTransform<float, float>,
+                                sensesp::LambdaTransform<bool, bool>>();
+  const size_t n2k_sender =
+      MaxSize<N2kFluidLevelSender, N2kBilgeAlarmSender,
+              N2kExhaustTemperatureSender, N2kEngineParameterDynamicSender,
+              N2kEngineParameterRapidSender>();
+  const size_t demand_gate =
+      MaxSize<SKDemandGate<float>, SKDemandGate<int>, SKDemandGate<bool>>();
+
+  debugI(
+      "GRAPH_NODE_BYTES {\"sensor\": %u, \"sk_output\": %u, \"curve\": %u, "
+      "\"linear\": %u, \"lambda\": %u, \"repeat_expiring\": %u, "
+      "\"n2k_sender\": %u, \"display_row\": %u, \"demand_gate\": %u, "
+      "\"throttle\": %u}",
+      sensor, sk_output, sizeof(sensesp::CurveInterpolator),
+      MaxSize<sensesp::Linear, sensesp::Frequency>(), lambda,
+      sizeof(sensesp::RepeatExpiring<double>), n2k_sender,
+      sizeof(sensesp::LambdaConsumer<float>), demand_gate,
+      sizeof(Throttle<float>));
+}
+#endif
+
+}  // namespace halmet
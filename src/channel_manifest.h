@@ -0,0 +1,112 @@
+#ifndef HALMET_SRC_CHANNEL_MANIFEST_H_
+#define HALMET_SRC_CHANNEL_MANIFEST_H_
+
+#include <Adafruit_ADS1X15.h>
+#include <Adafruit_SSD1306.h>
+#include <NMEA2000.h>
+
+#include "n2k_senders.h"
+#include "power_manager.h"
+#include "sensesp/transforms/frequency.h"
+
+namespace halmet {
+
+/**
+ * @brief The channel nodes that the optional features connect to.
+ *
+ * Filled in by the compiled-in channel layout or by
+ * BuildGraphFromManifest(), so that the fuel rate estimator, trend alarms,
+ * data logger, telemetry and the other features in setup() work with
+ * either. Members are nullptr if the layout has no such channel.
+ */
+struct ChannelGraph {
+  sensesp::FloatProducer* fuel_tank_level = nullptr;  // ratio
+  N2kFluidLevelSender* fuel_tank_sender = nullptr;
+  sensesp::FloatProducer* coolant_temperature = nullptr;  // K
+  sensesp::FloatProducer* oil_pressure = nullptr;         // bar
+  sensesp::FloatProducer* alternator_voltage = nullptr;   // V
+  sensesp::FloatProducer* exhaust_temperature = nullptr;  // K
+  sensesp::Frequency* engine_frequency = nullptr;         // Hz
+  N2kEngineParameterDynamicSender* engine_dynamic_sender = nullptr;
+  N2kEngineParameterRapidSender* engine_rapid_sender = nullptr;
+};
+
+/**
+ * @brief Hardware handles that manifest channels are connected to.
+ */
+struct ManifestContext {
+  Adafruit_ADS1115* ads1115 = nullptr;
+  Adafruit_SSD1306* display = nullptr;  // nullptr if no display is present
+  tNMEA2000* nmea2000 = nullptr;        // nullptr if N2k output is disabled
+  // If set, the tacho of engine instance 0 drives its engine state
+  PowerManager* power_manager = nullptr;
+  bool enable_signalk_output = true;
+};
+
+/**
+ * @brief Build the sensor graph from a JSON channel manifest in SPIFFS.
+ *
+ * The manifest lists every channel together with the N2k senders and
+ * display rows it feeds. Only the nodes a channel actually uses are
+ * allocated. Example:
+ *
+ *   {
+ *     "onewire_pin": 4,
+ *     "channels": [
+ *       { "type": "tank", "channel": 0, "name": "Fuel", "sk_id": "fuel.main",
+ *         "sort_order": 3000, "display_row": 2, "display_title": "Diesel",
+ *         "n2k": { "instance": 0, "fluid_type": 0, "capacity": 70 } },
+ *       { "type": "temperature", "channel": 2, "name": "Coolant",
+ *         "sk_id": "propulsion.main.coolantTemperature", "engine": 0 },
+ *       { "type": "oil_pressure", "channel": 3, "sk_id": "main", "engine": 0 },
+ *       { "type": "voltage", "channel": 1, "name": "A2",
+ *         "sk_path": "propulsion.main.alternatorVoltage", "engine": 0 },
+ *       { "type": "tacho", "input": 1, "name": "main", "engine": 0,
+ *         "engine_hours": true, "display_row": 3 },
+ *       { "type": "alarm", "input": 2, "name": "D2", "engine": 0,
+ *         "engine_flag": "low_oil_pressure" },
+ *       { "type": "alarm", "input": 4, "name": "D4", "bilge_instance": 1 },
+ *       { "type": "onewire", "name": "T1",
+ *         "config_path": "/exhaustTemperature/oneWire",
+ *         "sk_path": "propulsion.main.exhaustTemperature",
+ *         "exhaust_instance": 1 }
+ *     ]
+ *   }
+ *
+ * "channel" is the ADS1115 channel (0-3, i.e. A1-A4) and "input" the HALMET
+ * digital input (1-4). Tank, temperature and oil pressure channels take an
+ * optional "limits" object with "short", "min", "max" and "open" sender
+ * resistances in ohms; see SenderLimits for the defaults. "engine" is the
+ * NMEA 2000 engine instance; the engine senders are created on first use.
+ * "display_row" is an OLED row from 2 to 7; row 0 is the hostname and
+ * row 1 the IP address. The config paths of a channel are derived from its
+ * type and "name", so no two channels of one type may share a name. An
+ * oil pressure channel's "name" is optional and defaults to "Oil". The
+ * manifest is validated completely before anything is built, with the
+ * same rules as tools/manifest_check.py.
+ *
+ * The channels of engine instance 0, the first tank whose sk_id starts
+ * with "fuel." and the first 1-Wire channel with an "exhaust_instance" are
+ * stored in graph for the optional features.
+ *
+ * @return false if the manifest does not exist or is invalid. Nothing is
+ * allocated in that case and the caller should build its default layout.
+ */
+bool BuildGraphFromManifest(const char* path, const ManifestContext& context,
+                            ChannelGraph* graph);
+
+#ifdef ENABLE_STATIC_ARENA
+/**
+ * @brief Log the sizes of the graph node types that manifest channels use.
+ *
+ * Logs one line, "GRAPH_NODE_BYTES" followed by a JSON object with the
+ * sizeof of each kind of node counted by tools/manifest_check.py. Pass the
+ * log to its --node-bytes option to size the arena from this build instead
+ * of the script's estimates. Call once at the end of setup().
+ */
+void LogGraphNodeBytes();
+#endif
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_CHANNEL_MANIFEST_H_
@@ -0,0 +1,304 @@
+#include "data_logger.h"
+
+#include <Arduino.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+static const int8_t kMissingValue = -128;
+static const int8_t kMaxDelta = 127;
+static const int32_t kNoKeyframe = INT16_MIN;
+static const size_t kDownloadChunkSize = 512;
+static const uint32_t kWriterTaskStackSize = 3072;
+// Clock values before 2020 mean that the time has not been set yet.
+static const time_t kMinValidTime = 1577836800;
+
+DataLogger::DataLogger(const float (&scales)[kChannels],
+                       unsigned int interval_ms, const char* partition_label)
+    : interval_ms_{interval_ms}, partition_label_{partition_label} {
+  for (size_t i = 0; i < kChannels; i++) {
+    scales_[i] = scales[i];
+    running_[i] = kNoKeyframe;
+  }
+}
+
+bool DataLogger::begin() {
+  partition_ = esp_partition_find_first(
+      ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, partition_label_);
+  if (partition_ == nullptr) {
+    debugE("Data log partition '%s' not found", partition_label_);
+    return false;
+  }
+  num_sectors_ = partition_->size / kSectorSize;
+
+  size_t used = scan_sectors();
+  debugI("Data log: %u of %u sectors used, resuming at sector %u", used,
+         num_sectors_, next_sector_.load());
+
+  start_sector(buffers_[active_]);
+  xTaskCreate(WriterTask, "datalog", kWriterTaskStackSize, this,
+              tskIDLE_PRIORITY + 1, &writer_task_);
+  sensesp::event_loop()->onRepeat(interval_ms_,
+                                  [this]() { this->append_record(); });
+  return true;
+}
+
+size_t DataLogger::scan_sectors() {
+  size_t used = 0;
+  size_t newest = 0;
+  uint32_t newest_sequence = 0;
+  for (size_t i = 0; i < num_sectors_; i++) {
+    DataLogSectorHeader h;
+    if (esp_partition_read(partition_, i * kSectorSize, &h, sizeof(h)) !=
+            ESP_OK ||
+        h.magic != DataLogSectorHeader::kMagic) {
+      continue;
+    }
+    if (used == 0 || static_cast<int32_t>(h.sequence - newest_sequence) > 0) {
+      newest = i;
+      newest_sequence = h.sequence;
+    }
+    used++;
+  }
+  if (used > 0) {
+    next_sector_ = (newest + 1) % num_sectors_;
+    next_sequence_ = newest_sequence + 1;
+  }
+  return used;
+}
+
+void DataLogger::start_sector(uint8_t* buffer) {
+  memset(buffer, 0xff, kSectorSize);
+  auto h = reinterpret_cast<DataLogSectorHeader*>(buffer);
+  memset(h, 0, sizeof(*h));
+  h->magic = DataLogSectorHeader::kMagic;
+  h->sequence = next_sequence_++;
+  h->interval_ms = interval_ms_;
+  h->channels = kChannels;
+  h->record_size = kChannels;
+  for (size_t i = 0; i < kChannels; i++) {
+    h->keyframe[i] = running_[i];
+    h->scale[i] = scales_[i];
+  }
+}
+
+void DataLogger::append_record() {
+  uint32_t uptime_ms = millis();
+  int32_t targets[kChannels];
+  bool keyframe = false;
+  for (size_t i = 0; i < kChannels; i++) {
+    float value = inputs_[i].value(uptime_ms, interval_ms_);
+    if (isnan(value)) {
+      targets[i] = kNoKeyframe;
+      continue;
+    }
+    int32_t target = lroundf(value * scales_[i]);
+    targets[i] = constrain(target, INT16_MIN + 1, INT16_MAX);
+    if (running_[i] == kNoKeyframe) {
+      // Start from the first valid value instead of ramping up from zero
+      running_[i] = targets[i];
+      keyframe = true;
+    }
+  }
+
+  if (keyframe) {
+    if (header(active_)->record_count > 0) {
+      seal_sector();
+    } else {
+      portENTER_CRITICAL(&lock_);
+      for (size_t i = 0; i < kChannels; i++) {
+        header(active_)->keyframe[i] = running_[i];
+      }
+      portEXIT_CRITICAL(&lock_);
+    }
+  }
+
+  int8_t record[kChannels];
+  for (size_t i = 0; i < kChannels; i++) {
+    if (targets[i] == kNoKeyframe) {
+      record[i] = kMissingValue;
+      continue;
+    }
+    int32_t delta =
+        constrain(targets[i] - running_[i], -kMaxDelta, kMaxDelta);
+    record[i] = delta;
+    running_[i] += delta;
+  }
+
+  DataLogSectorHeader* h = header(active_);
+  time_t now = time(nullptr);
+
+  portENTER_CRITICAL(&lock_);
+  if (h->record_count == 0) {
+    h->uptime_ms = uptime_ms;
+    h->unix_time = now >= kMinValidTime ? now : 0;
+  }
+  memcpy(buffers_[active_] + sizeof(DataLogSectorHeader) +
+             h->record_count * kChannels,
+         record, kChannels);
+  h->record_count++;
+  portEXIT_CRITICAL(&lock_);
+
+  if (h->record_count == kRecordsPerSector) {
+    seal_sector();
+  }
+}
+
+void DataLogger::seal_sector() {
+  if (pending_ >= 0) {
+    // The writer task has not finished the previous sector. Drop this one
+    // and keep the buffer.
+    dropped_sectors_++;
+    debugW("Data log: flash write too slow, %u sectors dropped",
+           dropped_sectors_);
+    portENTER_CRITICAL(&lock_);
+    start_sector(buffers_[active_]);
+    portEXIT_CRITICAL(&lock_);
+    return;
+  }
+
+  size_t sector = next_sector_;
+  next_sector_ = (sector + 1) % num_sectors_;
+
+  portENTER_CRITICAL(&lock_);
+  int sealed = active_;
+  active_ = 1 - active_;
+  start_sector(buffers_[active_]);
+  pending_sector_ = sector;
+  pending_ = sealed;
+  portEXIT_CRITICAL(&lock_);
+
+  xTaskNotifyGive(writer_task_);
+}
+
+void DataLogger::WriterTask(void* parameter) {
+  auto logger = static_cast<DataLogger*>(parameter);
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int buffer = logger->pending_;
+    if (buffer < 0) {
+      continue;
+    }
+    size_t offset = logger->pending_sector_ * kSectorSize;
+    esp_err_t err =
+        esp_partition_erase_range(logger->partition_, offset, kSectorSize);
+    if (err == ESP_OK) {
+      err = esp_partition_write(logger->partition_, offset,
+                                logger->buffers_[buffer], kSectorSize);
+    }
+    if (err != ESP_OK) {
+      debugE("Data log: writing sector failed: %s", esp_err_to_name(err));
+    }
+
+    portENTER_CRITICAL(&logger->lock_);
+    logger->pending_ = -1;
+    logger->pending_sector_ = -1;
+    portEXIT_CRITICAL(&logger->lock_);
+  }
+}
+
+esp_err_t DataLogger::handle_download(httpd_req_t* req) {
+  if (partition_ == nullptr) {
+    httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Data log not available");
+    return ESP_FAIL;
+  }
+  httpd_resp_set_type(req, "application/octet-stream");
+  httpd_resp_set_hdr(req, "Content-Disposition",
+                     "attachment; filename=\"datalog.bin\"");
+
+  portENTER_CRITICAL(&lock_);
+  size_t first = next_sector_;
+  int pending = pending_;
+  int pending_sector = pending_sector_;
+  int active = active_;
+  portEXIT_CRITICAL(&lock_);
+
+  uint8_t chunk[kDownloadChunkSize];
+
+  // Flash sectors, oldest first. A sector that is about to be overwritten
+  // is skipped; its new contents are sent from RAM below. The RAM buffer
+  // stays intact until the next sector is sealed.
+  for (size_t i = 0; i < num_sectors_; i++) {
+    size_t sector = (first + i) % num_sectors_;
+    if (static_cast<int>(sector) == pending_sector) {
+      continue;
+    }
+    if (!send_sector(req, sector, chunk)) {
+      return ESP_FAIL;
+    }
+  }
+  if (pending >= 0 && !send_buffer(req, pending, chunk)) {
+    return ESP_FAIL;
+  }
+  if (!send_buffer(req, active, chunk)) {
+    return ESP_FAIL;
+  }
+  return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+bool DataLogger::send_sector(httpd_req_t* req, size_t sector,
+                             uint8_t* chunk) {
+  size_t offset = sector * kSectorSize;
+  DataLogSectorHeader h;
+  if (esp_partition_read(partition_, offset, &h, sizeof(h)) != ESP_OK ||
+      h.magic != DataLogSectorHeader::kMagic ||
+      h.record_count > kRecordsPerSector) {
+    return true;  // Never written
+  }
+  size_t size = sizeof(h) + h.record_count * kChannels;
+  for (size_t pos = 0; pos < size; pos += kDownloadChunkSize) {
+    size_t length = std::min(kDownloadChunkSize, size - pos);
+    if (esp_partition_read(partition_, offset + pos, chunk, length) !=
+            ESP_OK ||
+        httpd_resp_send_chunk(req, reinterpret_cast<const char*>(chunk),
+                              length) != ESP_OK) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool DataLogger::send_buffer(httpd_req_t* req, int buffer_index,
+                             uint8_t* chunk) {
+  const size_t header_size = sizeof(DataLogSectorHeader);
+  portENTER_CRITICAL(&lock_);
+  memcpy(chunk, buffers_[buffer_index], header_size);
+  portEXIT_CRITICAL(&lock_);
+
+  auto h = reinterpret_cast<DataLogSectorHeader*>(chunk);
+  if (h->record_count == 0) {
+    return true;
+  }
+  uint32_t sequence = h->sequence;
+  size_t size = header_size + h->record_count * kChannels;
+  if (httpd_resp_send_chunk(req, reinterpret_cast<const char*>(chunk),
+                            header_size) != ESP_OK) {
+    return false;
+  }
+
+  for (size_t pos = header_size; pos < size; pos += kDownloadChunkSize) {
+    size_t length = std::min(kDownloadChunkSize, size - pos);
+    portENTER_CRITICAL(&lock_);
+    bool unchanged = header(buffer_index)->sequence == sequence;
+    if (unchanged) {
+      memcpy(chunk, buffers_[buffer_index] + pos, length);
+    }
+    portEXIT_CRITICAL(&lock_);
+    if (!unchanged) {
+      // The buffer was reused while sending. Keep the record count valid.
+      memset(chunk, static_cast<uint8_t>(kMissingValue), length);
+    }
+    if (httpd_resp_send_chunk(req, reinterpret_cast<const char*>(chunk),
+                              length) != ESP_OK) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace halmet
@@ -0,0 +1,154 @@
+#ifndef HALMET_SRC_DATA_LOGGER_H_
+#define HALMET_SRC_DATA_LOGGER_H_
+
+#include <Arduino.h>
+#include <esp_http_server.h>
+#include <esp_partition.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "sensesp/system/valueconsumer.h"
+
+namespace halmet {
+
+/**
+ * @brief Header at the start of each 4 KB data log sector.
+ *
+ * The sector holds record_count records after the header. Each record has
+ * one signed byte per channel: the change of the channel value since the
+ * previous record, in units of 1/scale. -128 marks a missing value. The
+ * running values start from keyframe, where INT16_MIN means no value yet
+ * (the running value is then taken as zero). A channel's first valid value
+ * always starts a new sector with that value as its keyframe. Later
+ * changes larger than 127 units per record are spread over several
+ * records.
+ */
+struct DataLogSectorHeader {
+  static const uint32_t kMagic = 0x31474c48;  // "HLG1"
+  static const uint8_t kChannels = 4;
+
+  uint32_t magic;
+  uint32_t sequence;   // increases by one per sector, across reboots
+  uint32_t uptime_ms;  // time of the first record since boot
+  uint32_t unix_time;  // time of the first record, 0 if the clock was not set
+  uint16_t interval_ms;
+  uint16_t record_count;
+  uint8_t channels;
+  uint8_t record_size;
+  uint16_t reserved;
+  int16_t keyframe[kChannels];
+  float scale[kChannels];
+  uint8_t padding[16];
+};
+static_assert(sizeof(DataLogSectorHeader) == 64, "Unexpected header size");
+
+/**
+ * @brief Holds the latest value of one data log channel.
+ *
+ * The value is logged as missing once it is older than twice the input's
+ * update period, so a sensor that stops reporting is not logged as steady.
+ */
+class DataLogInput : public sensesp::ValueConsumer<float> {
+ public:
+  void set(const float& value) override {
+    uint32_t now = millis();
+    if (updated_) {
+      period_ms_ = now - updated_ms_;
+    }
+    updated_ = true;
+    updated_ms_ = now;
+    value_ = value;
+  }
+
+  /// The latest value, or NAN if it is older than twice the update period,
+  /// or than twice min_period_ms if that is longer.
+  float value(uint32_t now_ms, uint32_t min_period_ms) const {
+    uint32_t period_ms = std::max(period_ms_, min_period_ms);
+    if (!updated_ || now_ms - updated_ms_ > 2 * period_ms) {
+      return NAN;
+    }
+    return value_;
+  }
+
+ protected:
+  float value_ = NAN;
+  bool updated_ = false;
+  uint32_t updated_ms_ = 0;
+  uint32_t period_ms_ = 0;
+};
+
+/**
+ * @brief Circular binary log of engine data in a dedicated flash partition.
+ *
+ * The latest value of each input is sampled every interval_ms and appended
+ * as a delta-encoded record to a 4 KB RAM buffer. A full buffer is handed
+ * to a low-priority writer task, which erases and programs one whole flash
+ * sector, while the other buffer keeps filling. After the last sector of
+ * the partition, the oldest sector is overwritten. At boot, logging resumes
+ * after the sector with the highest sequence number.
+ *
+ * handle_download() streams all sectors, oldest first, followed by the
+ * partially filled RAM buffer, as a chunked HTTP response. Only one 512 byte
+ * chunk is held in memory at a time. tools/datalog_decode.py converts the
+ * stream to CSV.
+ */
+class DataLogger {
+ public:
+  static const size_t kChannels = DataLogSectorHeader::kChannels;
+  static const size_t kSectorSize = 4096;
+  static const size_t kRecordsPerSector =
+      (kSectorSize - sizeof(DataLogSectorHeader)) / kChannels;
+
+  /**
+   * @param scales Units per input unit for each channel, e.g. 10 to log a
+   * temperature in K with 0.1 K resolution.
+   */
+  DataLogger(const float (&scales)[kChannels],
+             unsigned int interval_ms = 1000,
+             const char* partition_label = "datalog");
+
+  /// Find the partition, resume after the newest sector and start logging.
+  bool begin();
+
+  esp_err_t handle_download(httpd_req_t* req);
+
+  DataLogInput inputs_[kChannels];
+
+ protected:
+  void append_record();
+  void start_sector(uint8_t* buffer);
+  void seal_sector();
+  size_t scan_sectors();
+  static void WriterTask(void* parameter);
+  bool send_sector(httpd_req_t* req, size_t sector, uint8_t* chunk);
+  bool send_buffer(httpd_req_t* req, int buffer_index, uint8_t* chunk);
+
+  DataLogSectorHeader* header(int buffer_index) {
+    return reinterpret_cast<DataLogSectorHeader*>(buffers_[buffer_index]);
+  }
+
+  float scales_[kChannels];
+  unsigned int interval_ms_;
+  const char* partition_label_;
+  const esp_partition_t* partition_ = nullptr;
+  size_t num_sectors_ = 0;
+
+  int32_t running_[kChannels];
+
+  // The active buffer is filled by the event loop. The other one is either
+  // free or waiting for the writer task.
+  alignas(4) uint8_t buffers_[2][kSectorSize];
+  int active_ = 0;
+  std::atomic<int> pending_{-1};  // buffer waiting for the writer task
+  std::atomic<int> pending_sector_{-1};  // flash sector it goes to
+  std::atomic<size_t> next_sector_{0};
+  uint32_t next_sequence_ = 0;
+  uint32_t dropped_sectors_ = 0;
+  TaskHandle_t writer_task_ = nullptr;
+  portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_DATA_LOGGER_H_
@@ -0,0 +1,73 @@
+#include "fuel_rate_estimator.h"
+
+#include <Arduino.h>
+
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+FuelRateEstimator::FuelRateEstimator(const String& config_path,
+                                     std::function<float()> tank_capacity,
+                                     unsigned int sample_interval)
+    : sensesp::FileSystemSaveable{config_path},
+      tank_level_{[this](float level) { this->model_.add_level(level); }},
+      engine_frequency_{[this](float frequency) {
+        this->model_.set_engine_running(frequency > 0);
+      }},
+      tank_capacity_{tank_capacity},
+      sample_interval_{sample_interval} {
+  load();
+  repeat_event_ = set_repeat_event(sample_interval_);
+
+  // The N2k sender inputs expire if they are not refreshed. A stale
+  // estimate is left to expire.
+  sensesp::event_loop()->onRepeat(kReemitInterval, [this]() {
+    if (this->model_.current(millis(), 2000 * this->sample_interval_)) {
+      this->emit_estimate();
+    }
+  });
+}
+
+reactesp::RepeatEvent* FuelRateEstimator::set_repeat_event(
+    unsigned int sample_interval) {
+  if (repeat_event_ != nullptr) {
+    repeat_event_->remove(sensesp::event_loop());
+  }
+
+  repeat_event_ = sensesp::event_loop()->onRepeat(
+      sample_interval * 1000, [this]() { this->sample(); });
+  return repeat_event_;
+}
+
+void FuelRateEstimator::emit_estimate() {
+  fuel_rate_.set(model_.fuel_rate());
+  hours_remaining_.set(model_.hours_remaining());
+}
+
+void FuelRateEstimator::sample() {
+  if (model_.sample(millis(), tank_capacity_())) {
+    emit_estimate();
+  }
+}
+
+bool FuelRateEstimator::to_json(JsonObject& root) {
+  root["sample_interval"] = sample_interval_;
+  return true;
+}
+
+bool FuelRateEstimator::from_json(const JsonObject& config) {
+  if (!config["sample_interval"].is<unsigned int>()) {
+    return false;
+  }
+  unsigned int sample_interval = config["sample_interval"];
+  if (sample_interval > 0 && sample_interval != sample_interval_) {
+    sample_interval_ = sample_interval;
+    // Not yet scheduled while loading in the constructor
+    if (repeat_event_ != nullptr) {
+      set_repeat_event(sample_interval_);
+    }
+  }
+  return true;
+}
+
+}  // namespace halmet
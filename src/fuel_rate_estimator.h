@@ -0,0 +1,75 @@
+#ifndef HALMET_SRC_FUEL_RATE_ESTIMATOR_H_
+#define HALMET_SRC_FUEL_RATE_ESTIMATOR_H_
+
+#include <functional>
+
+#include "fuel_rate_model.h"
+#include "sensesp/system/lambda_consumer.h"
+#include "sensesp/system/observablevalue.h"
+#include "sensesp/system/saveable.h"
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+/**
+ * @brief Estimate fuel consumption from the tank level history.
+ *
+ * Tank level readings are averaged over sample_interval seconds, and the
+ * fuel rate is the negated Theil-Sen slope of the last
+ * FuelRateModel::kWindowSize averages; see FuelRateModel. Raw readings cost
+ * one addition; each decimated sample costs a fixed
+ * kWindowSize*(kWindowSize-1)/2 slope calculations.
+ *
+ * The tank capacity is read from tank_capacity at every sample, so that it
+ * follows the tank sender's configuration. The latest estimate is emitted
+ * again every kReemitInterval ms, well within the expiry of the NMEA 2000
+ * sender inputs, but only while it is less than two sample intervals old.
+ * When the tank sender stops delivering readings, NAN is emitted once and
+ * the sender inputs are left to expire. The sample interval can be changed
+ * in the web UI without a restart.
+ */
+class FuelRateEstimator : public sensesp::FileSystemSaveable {
+ public:
+  static const unsigned int kReemitInterval = 2000;  // ms
+
+  FuelRateEstimator(const String& config_path,
+                    std::function<float()> tank_capacity,
+                    unsigned int sample_interval = 60);
+
+  virtual bool to_json(JsonObject& root) override;
+  virtual bool from_json(const JsonObject& config) override;
+
+  sensesp::LambdaConsumer<float> tank_level_;        // ratio
+  sensesp::LambdaConsumer<float> engine_frequency_;  // Hz, zero if stopped
+
+  sensesp::ObservableValue<float> fuel_rate_;        // l/h
+  sensesp::ObservableValue<float> hours_remaining_;  // h, NAN if unknown
+
+ protected:
+  void sample();
+  void emit_estimate();
+  reactesp::RepeatEvent* set_repeat_event(unsigned int sample_interval);
+
+  std::function<float()> tank_capacity_;  // l
+  unsigned int sample_interval_;          // s
+  reactesp::RepeatEvent* repeat_event_ = nullptr;
+
+  FuelRateModel model_;
+};
+
+inline const String ConfigSchema(const FuelRateEstimator& obj) {
+  return R"###({
+    "type": "object",
+    "properties": {
+      "sample_interval": { "title": "Sample interval", "type": "integer", "description": "Interval between averaged level samples (seconds). The estimate covers 16 samples." }
+    }
+  })###";
+}
+
+inline const bool ConfigRequiresRestart(const FuelRateEstimator& obj) {
+  return false;
+}
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_FUEL_RATE_ESTIMATOR_H_
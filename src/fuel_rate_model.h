@@ -0,0 +1,134 @@
+#ifndef HALMET_SRC_FUEL_RATE_MODEL_H_
+#define HALMET_SRC_FUEL_RATE_MODEL_H_
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "slope_window.h"
+
+namespace halmet {
+
+/**
+ * @brief Fuel rate and time remaining from decimated tank level samples.
+ *
+ * Tank level readings are summed with add_level(), and sample() closes a
+ * period: the period average is converted to a volume and stored in a
+ * window of the last kWindowSize samples. The fuel rate is the negated
+ * Theil-Sen slope of that window.
+ *
+ * Only periods during which the engine ran the whole time are used. When
+ * the engine stops, the window is cleared and the rate is zero. When the
+ * level jumps up (refuelling), the window is cleared and the previous
+ * estimate is kept until kMinSamples new samples have been collected. A
+ * period without a single valid level reading (a faulted or disconnected
+ * sender) clears the window and makes the estimate unknown.
+ *
+ * Times are passed in, so the class does not depend on the Arduino core.
+ */
+class FuelRateModel {
+ public:
+  static const size_t kWindowSize = 16;
+  // Samples needed before a rate is reported
+  static const size_t kMinSamples = 4;
+
+  /// Add a tank level reading (ratio). NAN readings are ignored.
+  void add_level(float level) {
+    if (!isnan(level)) {
+      level_sum_ += level;
+      level_count_++;
+    }
+  }
+
+  void set_engine_running(bool running) {
+    engine_running_ = running;
+    if (!running) {
+      stopped_in_period_ = true;
+    }
+  }
+
+  /**
+   * Close the period ending at now_ms. Returns true if fuel_rate() and
+   * hours_remaining() have been updated and are to be reported.
+   */
+  bool sample(uint32_t now_ms, float tank_capacity) {
+    bool stopped = stopped_in_period_;
+    stopped_in_period_ = !engine_running_;
+    if (level_count_ == 0) {
+      window_.clear();
+      bool was_known = known_;
+      set_unknown();
+      return was_known;
+    }
+    float volume = tank_capacity * level_sum_ / level_count_;
+    level_sum_ = 0;
+    level_count_ = 0;
+
+    if (stopped ||
+        volume - window_.latest() > kRefuelThreshold * tank_capacity) {
+      window_.clear();
+    }
+    if (stopped) {
+      set_estimate(now_ms, 0, NAN);
+      return true;
+    }
+
+    window_.add(now_ms, volume);
+    if (window_.size() < kMinSamples) {
+      return false;
+    }
+
+    float fuel_rate = -window_.slope();
+    if (fuel_rate < kMinFuelRate) {
+      set_estimate(now_ms, 0, NAN);
+    } else {
+      set_estimate(now_ms, fuel_rate, volume / fuel_rate);
+    }
+    return true;
+  }
+
+  /// True if the estimate was updated within max_age_ms of now_ms.
+  bool current(uint32_t now_ms, uint32_t max_age_ms) const {
+    return known_ && now_ms - estimate_ms_ <= max_age_ms;
+  }
+
+  float fuel_rate() const { return fuel_rate_; }              // l/h
+  float hours_remaining() const { return hours_remaining_; }  // h
+  size_t window_size() const { return window_.size(); }
+
+ protected:
+  // A sample this much above the previous one, as a fraction of the tank
+  // capacity, is taken as refuelling.
+  static constexpr float kRefuelThreshold = 0.05;
+  // Rates below this are reported as zero, with an unknown time remaining.
+  static constexpr float kMinFuelRate = 0.05;  // l/h
+
+  void set_estimate(uint32_t now_ms, float fuel_rate, float hours_remaining) {
+    known_ = true;
+    estimate_ms_ = now_ms;
+    fuel_rate_ = fuel_rate;
+    hours_remaining_ = hours_remaining;
+  }
+
+  void set_unknown() {
+    known_ = false;
+    fuel_rate_ = NAN;
+    hours_remaining_ = NAN;
+  }
+
+  bool engine_running_ = false;
+  bool stopped_in_period_ = true;
+  float level_sum_ = 0;
+  unsigned int level_count_ = 0;
+
+  bool known_ = false;
+  uint32_t estimate_ms_ = 0;
+  float fuel_rate_ = NAN;
+  float hours_remaining_ = NAN;
+
+  SlopeWindow<kWindowSize> window_;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_FUEL_RATE_MODEL_H_
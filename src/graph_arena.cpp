@@ -0,0 +1,79 @@
+#include "graph_arena.h"
+
+#include <cstring>
+
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+#ifdef ENABLE_STATIC_ARENA
+alignas(8) static uint8_t graph_arena_buffer[STATIC_ARENA_SIZE];
+static StaticArena graph_arena(graph_arena_buffer, sizeof(graph_arena_buffer));
+#else
+static StaticArena graph_arena(nullptr, 0);
+#endif
+
+static size_t graph_node_count = 0;
+static size_t graph_node_bytes = 0;
+static uint32_t graph_build_start_ms = 0;
+static uint32_t graph_build_start_heap = 0;
+
+StaticArena& GraphArena() { return graph_arena; }
+
+void GraphArenaOverflow(size_t size) {
+  debugE(
+      "Graph arena overflow: %u byte object does not fit (%u of %u bytes "
+      "used). Increase STATIC_ARENA_SIZE.",
+      size, graph_arena.used(), graph_arena.capacity());
+  abort();
+}
+
+void* GraphAllocate(size_t size, size_t alignment) {
+#ifdef ENABLE_STATIC_ARENA
+  void* mem = graph_arena.allocate(size, alignment);
+  if (mem == nullptr) {
+    GraphArenaOverflow(size);
+  }
+  return mem;
+#else
+  return malloc(size);
+#endif
+}
+
+const char* GraphStrdup(const char* str) {
+  size_t size = strlen(str) + 1;
+  auto copy = static_cast<char*>(GraphAllocate(size, 1));
+  memcpy(copy, str, size);
+  return copy;
+}
+
+void CountGraphNode(size_t size) {
+  graph_node_count++;
+  graph_node_bytes += size;
+}
+
+size_t GraphNodeCount() { return graph_node_count; }
+
+size_t GraphNodeBytes() { return graph_node_bytes; }
+
+void StartGraphBuild() {
+  graph_build_start_ms = millis();
+  graph_build_start_heap = ESP.getFreeHeap();
+}
+
+void ReportGraphArena() {
+  // The heap figure includes anything else allocated meanwhile, such as
+  // WiFi buffers, so compare builds with the same options.
+  debugI("Sensor graph: %u nodes of %u bytes, built in %u ms using %d "
+         "bytes of heap",
+         graph_node_count, graph_node_bytes,
+         millis() - graph_build_start_ms,
+         static_cast<int>(graph_build_start_heap - ESP.getFreeHeap()));
+#ifdef ENABLE_STATIC_ARENA
+  debugI("Graph arena: %u objects, %u bytes used, %u bytes left of %u",
+         graph_arena.allocation_count(), graph_arena.used(),
+         graph_arena.remaining(), graph_arena.capacity());
+#endif
+}
+
+}  // namespace halmet
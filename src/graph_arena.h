@@ -0,0 +1,70 @@
+#ifndef HALMET_SRC_GRAPH_ARENA_H_
+#define HALMET_SRC_GRAPH_ARENA_H_
+
+#include <new>
+#include <utility>
+
+#include "static_arena.h"
+
+// Size of the arena holding the sensor graph, in bytes. Override with
+// -D STATIC_ARENA_SIZE=<bytes> in platformio.ini.
+#ifndef STATIC_ARENA_SIZE
+#define STATIC_ARENA_SIZE 24576
+#endif
+
+namespace halmet {
+
+/// The arena that holds the objects created in setup() and the Connect*
+/// helpers.
+StaticArena& GraphArena();
+
+/// Called when the graph arena runs out of space. Logs the failed request and
+/// halts; a truncated sensor graph must never run silently.
+[[noreturn]] void GraphArenaOverflow(size_t size);
+
+/// Record the time and free heap at the start of the sensor graph build.
+/// Call in setup() before the first GraphNew().
+void StartGraphBuild();
+
+/// Log the time and heap taken by the sensor graph build and the graph arena
+/// usage. Call once at the end of setup().
+void ReportGraphArena();
+
+/// Allocate raw storage that lives as long as the sensor graph. Uses the
+/// graph arena if ENABLE_STATIC_ARENA is defined, the heap otherwise.
+void* GraphAllocate(size_t size, size_t alignment);
+
+/// Copy a string into storage that lives as long as the sensor graph.
+const char* GraphStrdup(const char* str);
+
+/// Record a node created with GraphNew().
+void CountGraphNode(size_t size);
+
+/// Number of nodes created with GraphNew() so far.
+size_t GraphNodeCount();
+
+/// Total size of the nodes created with GraphNew(), not counting memory
+/// they allocate themselves.
+size_t GraphNodeBytes();
+
+/**
+ * @brief Allocate a sensor graph node.
+ *
+ * With ENABLE_STATIC_ARENA defined, the object is placed in the statically
+ * sized graph arena. Otherwise this is a plain heap allocation. Objects
+ * created this way are never deleted.
+ */
+template <typename T, typename... Args>
+T* GraphNew(Args&&... args) {
+  CountGraphNode(sizeof(T));
+#ifdef ENABLE_STATIC_ARENA
+  void* mem = GraphAllocate(sizeof(T), alignof(T));
+  return new (mem) T(std::forward<Args>(args)...);
+#else
+  return new T(std::forward<Args>(args)...);
+#endif
+}
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_GRAPH_ARENA_H_
@@ -1,90 +1,80 @@
 #include "halmet_analog.h"
 
+#include "graph_arena.h"
 #include "sensesp/sensors/sensor.h"
 #include "sensesp/signalk/signalk_output.h"
 #include "sensesp/system/valueproducer.h"
 #include "sensesp/transforms/curveinterpolator.h"
 #include "sensesp/transforms/linear.h"
 #include "sensesp/ui/config_item.h"
+#include "sk_demand.h"
+#include "throttle.h"
 
 namespace halmet {
 
-// HALMET constant measurement current (A)
-const float kMeasurementCurrent = 0.01;
-
-
 // Default fuel tank size, in m3
 const float kTankDefaultSize = 120. / 1000;
 
+// The sender resistances are diagnostic values; publish them at most this
+// often, in ms
+const unsigned int kResistanceOutputInterval = 5000;
+
+// Publish the SenderFault code of a resistance input
+static void ConnectSenderFault(ADS1115ResistanceInput* input,
+                               const char* sk_path, const char* description) {
+  input->fault_.connect_to(GraphNew<SKDemandGate<int>>())
+      ->connect_to(GraphNew<sensesp::SKOutputInt>(
+          sk_path, "", GraphNew<sensesp::SKMetadata>("", description)));
+}
+
 // --- Tank Sensor Code ---
 sensesp::FloatProducer* ConnectTankSender(Adafruit_ADS1115* ads1115,
-                                          int channel, const String& name,
-                                          const String& sk_id, int sort_order,
+                                          const TankChannel& tank,
                                           bool enable_signalk_output) {
-  const uint ads_read_delay = 500;  // ms
+  // Default read interval (ms), adjustable in the web UI
+  const uint ads_read_delay = 500;
+  const int channel = tank.channel;
+  const int sort_order = tank.sort_order;
 
   // Configure the sender resistance sensor
 
-  auto sender_resistance =
-      new sensesp::RepeatSensor<float>(ads_read_delay, [ads1115, channel]() {
-        int16_t adc_output = ads1115->readADC_SingleEnded(channel);
-        float adc_output_volts = ads1115->computeVolts(adc_output);
-        return kVoltageDividerScale * adc_output_volts / kMeasurementCurrent;
-      });
+  auto sender_resistance = GraphNew<ADS1115ResistanceInput>(
+      ads1115, channel, tank.sender_config_path, ads_read_delay, tank.limits);
+
+  ConfigItem(sender_resistance)
+      ->set_title(tank.sender_title)
+      ->set_description(tank.sender_description)
+      ->set_sort_order(sort_order + 5);
 
   if (enable_signalk_output) {
-    char resistance_sk_config_path[80];
-    snprintf(resistance_sk_config_path, sizeof(resistance_sk_config_path),
-             "/Tanks/%s/Resistance/SK Path", name.c_str());
-    char resistance_title[80];
-    snprintf(resistance_title, sizeof(resistance_title),
-             "%s Tank Sender Resistance SK Path", name.c_str());
-    char resistance_description[80];
-    snprintf(resistance_description, sizeof(resistance_description),
-             "Signal K path for the sender resistance of the %s tank",
-             name.c_str());
-    char resistance_sk_path[80];
-    snprintf(resistance_sk_path, sizeof(resistance_sk_path),
-             "tanks.%s.senderResistance", sk_id.c_str());
-    char resistance_meta_display_name[80];
-    snprintf(resistance_meta_display_name, sizeof(resistance_meta_display_name),
-             "Resistance %s", name.c_str());
-    char resistance_meta_description[80];
-    snprintf(resistance_meta_description, sizeof(resistance_meta_description),
-             "Measured tank %s sender resistance", name.c_str());
-
-    auto sender_resistance_sk_output = new sensesp::SKOutputFloat(
-        resistance_sk_path, resistance_sk_config_path,
-        new sensesp::SKMetadata("ohm", resistance_meta_display_name,
-                                resistance_meta_description));
+    ConnectSenderFault(sender_resistance, tank.fault_sk_path,
+                       "Tank sender fault: 0 ok, 1 open, 2 short, 3 range");
+
+    auto sender_resistance_sk_output = GraphNew<sensesp::SKOutputFloat>(
+        tank.resistance_sk_path, tank.resistance_sk_config_path,
+        GraphNew<sensesp::SKMetadata>("ohm", tank.resistance_meta_display_name,
+                                      tank.resistance_meta_description));
 
     ConfigItem(sender_resistance_sk_output)
-        ->set_title(resistance_title)
-        ->set_description(resistance_description)
+        ->set_title(tank.resistance_title)
+        ->set_description(tank.resistance_description)
         ->set_sort_order(sort_order);
 
-    sender_resistance->connect_to(sender_resistance_sk_output);
+    sender_resistance->connect_to(GraphNew<SKDemandGate<float>>())
+        ->connect_to(GraphNew<Throttle<float>>(kResistanceOutputInterval))
+        ->connect_to(sender_resistance_sk_output);
   }
 
   // Configure the piecewise linear interpolator for the tank level (ratio)
 
-  char curve_config_path[80];
-  snprintf(curve_config_path, sizeof(curve_config_path),
-           "/Tanks/%s/Level Curve", name.c_str());
-  char curve_title[80];
-  snprintf(curve_title, sizeof(curve_title), "%s Tank Level Curve",
-           name.c_str());
-  char curve_description[80];
-  snprintf(curve_description, sizeof(curve_description),
-           "Piecewise linear curve for the %s tank level", name.c_str());
-
-  auto tank_level = (new sensesp::CurveInterpolator(nullptr, curve_config_path))
-                        ->set_input_title("Sender Resistance (ohms)")
-                        ->set_output_title("Fuel Level (ratio)");
+  auto tank_level =
+      GraphNew<sensesp::CurveInterpolator>(nullptr, tank.curve_config_path)
+          ->set_input_title("Sender Resistance (ohms)")
+          ->set_output_title("Fuel Level (ratio)");
 
   ConfigItem(tank_level)
-      ->set_title(curve_title)
-      ->set_description(curve_description)
+      ->set_title(tank.curve_title)
+      ->set_description(tank.curve_description)
       ->set_sort_order(sort_order + 1);
 
   if (tank_level->get_samples().empty()) {
@@ -98,88 +88,45 @@ sensesp::FloatProducer* ConnectTankSender(Adafruit_ADS1115* ads1115,
 
   sender_resistance->connect_to(tank_level);
 
+  // The level and volume outputs below only feed Signal K
+  auto tank_level_sk = GraphNew<SKDemandGate<float>>();
+  tank_level->connect_to(tank_level_sk);
+
   if (enable_signalk_output) {
-    char level_config_path[80];
-    snprintf(level_config_path, sizeof(level_config_path),
-             "/Tanks/%s/Current Level SK Path", name.c_str());
-    char level_title[80];
-    snprintf(level_title, sizeof(level_title), "%s Tank Level SK Path",
-             name.c_str());
-    char level_description[80];
-    snprintf(level_description, sizeof(level_description),
-             "Signal K path for the %s tank level", name.c_str());
-    char level_sk_path[80];
-    snprintf(level_sk_path, sizeof(level_sk_path), "tanks.%s.currentLevel",
-             sk_id.c_str());
-    char level_meta_display_name[80];
-    snprintf(level_meta_display_name, sizeof(level_meta_display_name),
-             "Tank %s level", name.c_str());
-    char level_meta_description[80];
-    snprintf(level_meta_description, sizeof(level_meta_description),
-             "Tank %s level", name.c_str());
-
-    auto tank_level_sk_output = new sensesp::SKOutputFloat(
-        level_sk_path, level_config_path,
-        new sensesp::SKMetadata("ratio", level_meta_display_name,
-                                level_meta_description));
+    auto tank_level_sk_output = GraphNew<sensesp::SKOutputFloat>(
+        tank.level_sk_path, tank.level_config_path,
+        GraphNew<sensesp::SKMetadata>("ratio", tank.level_meta_display_name,
+                                      tank.level_meta_description));
 
     ConfigItem(tank_level_sk_output)
-        ->set_title(level_title)
-        ->set_description(level_description)
+        ->set_title(tank.level_title)
+        ->set_description(tank.level_description)
         ->set_sort_order(sort_order + 2);
 
-    tank_level->connect_to(tank_level_sk_output);
+    tank_level_sk->connect_to(tank_level_sk_output);
   }
 
   // Configure the linear transform for the tank volume
 
-  char volume_config_path[80];
-  snprintf(volume_config_path, sizeof(volume_config_path),
-           "/Tanks/%s/Total Volume", name.c_str());
-  char volume_title[80];
-  snprintf(volume_title, sizeof(volume_title), "%s Tank Total Volume",
-           name.c_str());
-  char volume_description[80];
-  snprintf(volume_description, sizeof(volume_description),
-           "Calculated total volume of the %s tank", name.c_str());
   auto tank_volume =
-      new sensesp::Linear(kTankDefaultSize, 0, volume_config_path);
+      GraphNew<sensesp::Linear>(kTankDefaultSize, 0, tank.volume_config_path);
 
   ConfigItem(tank_volume)
-      ->set_title(volume_title)
-      ->set_description(volume_description)
+      ->set_title(tank.volume_title)
+      ->set_description(tank.volume_description)
       ->set_sort_order(sort_order + 3);
 
-  tank_level->connect_to(tank_volume);
+  tank_level_sk->connect_to(tank_volume);
 
   if (enable_signalk_output) {
-    char volume_sk_config_path[80];
-    snprintf(volume_sk_config_path, sizeof(volume_sk_config_path),
-             "/Tanks/%s/Current Volume SK Path", name.c_str());
-    char volume_title[80];
-    snprintf(volume_title, sizeof(volume_title), "%s Tank Volume SK Path",
-             name.c_str());
-    char volume_description[80];
-    snprintf(volume_description, sizeof(volume_description),
-             "Signal K path for the %s tank volume", name.c_str());
-    char volume_sk_path[80];
-    snprintf(volume_sk_path, sizeof(volume_sk_path), "tanks.%s.currentVolume",
-             sk_id.c_str());
-    char volume_meta_display_name[80];
-    snprintf(volume_meta_display_name, sizeof(volume_meta_display_name),
-             "Tank %s volume", name.c_str());
-    char volume_meta_description[80];
-    snprintf(volume_meta_description, sizeof(volume_meta_description),
-             "Calculated tank %s remaining volume", name.c_str());
-
-    auto tank_volume_sk_output = new sensesp::SKOutputFloat(
-        volume_sk_path, volume_sk_config_path,
-        new sensesp::SKMetadata("m3", volume_meta_display_name,
-                                volume_meta_description));
+    auto tank_volume_sk_output = GraphNew<sensesp::SKOutputFloat>(
+        tank.volume_sk_path, tank.volume_sk_config_path,
+        GraphNew<sensesp::SKMetadata>("m3", tank.volume_meta_display_name,
+                                      tank.volume_meta_description));
 
     ConfigItem(tank_volume_sk_output)
-        ->set_title(volume_title)
-        ->set_description(volume_description)
+        ->set_title(tank.volume_sk_title)
+        ->set_description(tank.volume_sk_description)
         ->set_sort_order(sort_order + 4);
 
     tank_volume->connect_to(tank_volume_sk_output);
@@ -189,72 +136,54 @@ sensesp::FloatProducer* ConnectTankSender(Adafruit_ADS1115* ads1115,
 }
 
 // --- Temperature Sensor Code ---
-sensesp::FloatProducer* ConnectTemperatureSensor(Adafruit_ADS1115* ads1115,
-                                                 int channel, const String& name,
-                                                 const String& sk_id, int sort_order,
-                                                 bool enable_signalk_output) {
-  const uint ads_read_delay = 500;  // ms
+sensesp::FloatProducer* ConnectTemperatureSensor(
+    Adafruit_ADS1115* ads1115, const TemperatureChannel& sensor,
+    bool enable_signalk_output) {
+  // Default read interval (ms), adjustable in the web UI
+  const uint ads_read_delay = 500;
+  const int channel = sensor.channel;
+  const int sort_order = sensor.sort_order;
 
   // Configure the temperature resistance sensor
-  auto temperature_resistance =
-      new sensesp::RepeatSensor<float>(ads_read_delay, [ads1115, channel]() {
-        int16_t adc_output = ads1115->readADC_SingleEnded(channel);
-        float adc_output_volts = ads1115->computeVolts(adc_output);
-        return kVoltageDividerScale * adc_output_volts / kMeasurementCurrent;
-      });
+  auto temperature_resistance = GraphNew<ADS1115ResistanceInput>(
+      ads1115, channel, sensor.sender_config_path, ads_read_delay,
+      sensor.limits);
+
+  ConfigItem(temperature_resistance)
+      ->set_title(sensor.sender_title)
+      ->set_description(sensor.sender_description)
+      ->set_sort_order(sort_order + 3);
 
   if (enable_signalk_output) {
-    char resistance_sk_config_path[80];
-    snprintf(resistance_sk_config_path, sizeof(resistance_sk_config_path),
-             "/Temperature/%s/Resistance/SK Path", name.c_str());
-    char resistance_title[80];
-    snprintf(resistance_title, sizeof(resistance_title),
-             "%s Temperature Sensor Resistance SK Path", name.c_str());
-    char resistance_description[80];
-    snprintf(resistance_description, sizeof(resistance_description),
-             "Signal K path for the sensor resistance of the %s temperature sensor",
-             name.c_str());
-    char resistance_sk_path[80];
-    snprintf(resistance_sk_path, sizeof(resistance_sk_path),
-             "%s.sensorResistance", sk_id.c_str());                                // was dit "temperature.%s.sensorResistance"
-    char resistance_meta_display_name[80];
-    snprintf(resistance_meta_display_name, sizeof(resistance_meta_display_name),
-             "Resistance %s", name.c_str());
-    char resistance_meta_description[80];
-    snprintf(resistance_meta_description, sizeof(resistance_meta_description),
-             "Measured temperature %s sensor resistance", name.c_str());
-
-    auto temperature_resistance_sk_output = new sensesp::SKOutputFloat(
-        resistance_sk_path, resistance_sk_config_path,
-        new sensesp::SKMetadata("ohm", resistance_meta_display_name,
-                                resistance_meta_description));
+    ConnectSenderFault(
+        temperature_resistance, sensor.fault_sk_path,
+        "Temperature sensor fault: 0 ok, 1 open, 2 short, 3 range");
+
+    auto temperature_resistance_sk_output = GraphNew<sensesp::SKOutputFloat>(
+        sensor.resistance_sk_path, sensor.resistance_sk_config_path,
+        GraphNew<sensesp::SKMetadata>("ohm",
+                                      sensor.resistance_meta_display_name,
+                                      sensor.resistance_meta_description));
 
     ConfigItem(temperature_resistance_sk_output)
-        ->set_title(resistance_title)
-        ->set_description(resistance_description)
+        ->set_title(sensor.resistance_title)
+        ->set_description(sensor.resistance_description)
         ->set_sort_order(sort_order);
 
-    temperature_resistance->connect_to(temperature_resistance_sk_output);
+    temperature_resistance->connect_to(GraphNew<SKDemandGate<float>>())
+        ->connect_to(GraphNew<Throttle<float>>(kResistanceOutputInterval))
+        ->connect_to(temperature_resistance_sk_output);
   }
 
   // Configure the piecewise linear interpolator for temperature in Kelvin
-  char curve_config_path[80];
-  snprintf(curve_config_path, sizeof(curve_config_path),
-           "/Temperature/%s/Curve", name.c_str());
-  char curve_title[80];
-  snprintf(curve_title, sizeof(curve_title), "%s Temperature Curve",
-           name.c_str());
-  char curve_description[80];
-  snprintf(curve_description, sizeof(curve_description),
-           "Piecewise linear curve for the %s temperature sensor", name.c_str());
-
-  auto temperature_kelvin = (new sensesp::CurveInterpolator(nullptr, curve_config_path))
-                                ->set_input_title("Sensor Resistance (ohms)")
-                                ->set_output_title("Temperature (K)");
+  auto temperature_kelvin =
+      GraphNew<sensesp::CurveInterpolator>(nullptr, sensor.curve_config_path)
+          ->set_input_title("Sensor Resistance (ohms)")
+          ->set_output_title("Temperature (K)");
 
   ConfigItem(temperature_kelvin)
-      ->set_title(curve_title)
-      ->set_description(curve_description)
+      ->set_title(sensor.curve_title)
+      ->set_description(sensor.curve_description)
       ->set_sort_order(sort_order + 1);
 
   if (temperature_kelvin->get_samples().empty()) {
@@ -267,114 +196,100 @@ sensesp::FloatProducer* ConnectTemperatureSensor(Adafruit_ADS1115* ads1115,
   temperature_resistance->connect_to(temperature_kelvin);
 
   if (enable_signalk_output) {
-    char temperature_config_path[80];
-    snprintf(temperature_config_path, sizeof(temperature_config_path),
-             "/Temperature/%s/Current Temperature SK Path", name.c_str());
-    char temperature_title[80];
-    snprintf(temperature_title, sizeof(temperature_title), "%s Temperature SK Path",
-             name.c_str());
-    char temperature_description[80];
-    snprintf(temperature_description, sizeof(temperature_description),
-             "Signal K path for the %s temperature", name.c_str());
-    char temperature_sk_path[80];
-    snprintf(temperature_sk_path, sizeof(temperature_sk_path), "%s", // was dit "temperature.%s.currentTemperature"
-             sk_id.c_str());
-    char temperature_meta_display_name[80];
-    snprintf(temperature_meta_display_name, sizeof(temperature_meta_display_name),
-             "Temperature %s", name.c_str());
-    char temperature_meta_description[80];
-    snprintf(temperature_meta_description, sizeof(temperature_meta_description),
-             "Measured temperature in Kelvin for %s", name.c_str());
-
-    auto temperature_sk_output = new sensesp::SKOutputFloat(
-        temperature_sk_path, temperature_config_path,
-        new sensesp::SKMetadata("K", temperature_meta_display_name,
-                                temperature_meta_description));
+    auto temperature_sk_output = GraphNew<sensesp::SKOutputFloat>(
+        sensor.temperature_sk_path, sensor.temperature_config_path,
+        GraphNew<sensesp::SKMetadata>("K",
+                                      sensor.temperature_meta_display_name,
+                                      sensor.temperature_meta_description));
 
     ConfigItem(temperature_sk_output)
-        ->set_title(temperature_title)
-        ->set_description(temperature_description)
+        ->set_title(sensor.temperature_title)
+        ->set_description(sensor.temperature_description)
         ->set_sort_order(sort_order + 2);
 
-    temperature_kelvin->connect_to(temperature_sk_output);
+    temperature_kelvin->connect_to(GraphNew<SKDemandGate<float>>())
+        ->connect_to(temperature_sk_output);
   }
 
   return temperature_kelvin;
 }
 
-sensesp::FloatProducer* ConnectOilPressureSensor(Adafruit_ADS1115* ads1115,
-  int channel, const String& name,
-  const String& sk_id, int sort_order,
-  bool enable_signalk_output) {
-  const uint ads_read_delay = 500;  // ms
-
-  auto resistance_sensor =
-    new sensesp::RepeatSensor<float>(ads_read_delay, [ads1115, channel]() {
-    int16_t adc_output = ads1115->readADC_SingleEnded(channel);
-    float adc_output_volts = ads1115->computeVolts(adc_output);
-    return kVoltageDividerScale * adc_output_volts / kMeasurementCurrent;
-    });
-
-if (enable_signalk_output) {
-  char resistance_sk_path[80];
-  snprintf(resistance_sk_path, sizeof(resistance_sk_path),
-  "propulsion.%s.oilPressureResistance", sk_id.c_str());
-  auto sk_output_resistance = new sensesp::SKOutputFloat(
-  resistance_sk_path,
-  "/Propulsion/OilPressureSensor/Resistance",
-  new sensesp::SKMetadata("ohm", "Oil Pressure Resistance",
-  "Raw resistance of the oil pressure sensor"));
-
-  ConfigItem(sk_output_resistance)
-  ->set_title("Oil Pressure Sensor Resistance SK Path")
-  ->set_description("Signal K path for the oil pressure sensor resistance")
-  ->set_sort_order(sort_order);
-
-  resistance_sensor->connect_to(sk_output_resistance);
-}
+sensesp::FloatProducer* ConnectOilPressureSensor(
+    Adafruit_ADS1115* ads1115, const OilPressureChannel& sensor,
+    bool enable_signalk_output) {
+  // Default read interval (ms), adjustable in the web UI
+  const uint ads_read_delay = 500;
+  const int channel = sensor.channel;
+  const int sort_order = sensor.sort_order;
+
+  auto resistance_sensor = GraphNew<ADS1115ResistanceInput>(
+      ads1115, channel, sensor.sender_config_path, ads_read_delay,
+      sensor.limits);
+
+  ConfigItem(resistance_sensor)
+      ->set_title(sensor.sender_title)
+      ->set_description(sensor.sender_description)
+      ->set_sort_order(sort_order + 3);
 
-// Convert resistance to pressure (bar) using a curve
-auto pressure_curve =
-  (new sensesp::CurveInterpolator(nullptr, "/Propulsion/OilPressureSensor/Curve"))
-  ->set_input_title("Resistance (ohm)")
-  ->set_output_title("Pressure (bar)");
+  if (enable_signalk_output) {
+    ConnectSenderFault(
+        resistance_sensor, sensor.fault_sk_path,
+        "Oil pressure sensor fault: 0 ok, 1 open, 2 short, 3 range");
+
+    auto sk_output_resistance = GraphNew<sensesp::SKOutputFloat>(
+        sensor.resistance_sk_path, sensor.resistance_sk_config_path,
+        GraphNew<sensesp::SKMetadata>("ohm",
+                                      sensor.resistance_meta_display_name,
+                                      sensor.resistance_meta_description));
+
+    ConfigItem(sk_output_resistance)
+        ->set_title(sensor.resistance_title)
+        ->set_description(sensor.resistance_description)
+        ->set_sort_order(sort_order);
+
+    resistance_sensor->connect_to(GraphNew<SKDemandGate<float>>())
+        ->connect_to(GraphNew<Throttle<float>>(kResistanceOutputInterval))
+        ->connect_to(sk_output_resistance);
+  }
+
+  // Convert resistance to pressure (bar) using a curve
+  auto pressure_curve =
+      GraphNew<sensesp::CurveInterpolator>(nullptr, sensor.curve_config_path)
+          ->set_input_title("Resistance (ohm)")
+          ->set_output_title("Pressure (bar)");
 
   ConfigItem(pressure_curve)
-  ->set_title("Oil Pressure Sensor Curve")
-  ->set_description("Converts resistance to oil pressure")
-  ->set_sort_order(sort_order + 1);
+      ->set_title(sensor.curve_title)
+      ->set_description(sensor.curve_description)
+      ->set_sort_order(sort_order + 1);
 
   if (pressure_curve->get_samples().empty()) {
-  pressure_curve->clear_samples();
-  pressure_curve->add_sample({10.0, 0.0});
-  pressure_curve->add_sample({48.0, 1.0});
-  pressure_curve->add_sample({82.0, 2.0});
-  pressure_curve->add_sample({116.0, 3.0});
-  pressure_curve->add_sample({184.0, 5.0});
+    pressure_curve->clear_samples();
+    pressure_curve->add_sample({10.0, 0.0});
+    pressure_curve->add_sample({48.0, 1.0});
+    pressure_curve->add_sample({82.0, 2.0});
+    pressure_curve->add_sample({116.0, 3.0});
+    pressure_curve->add_sample({184.0, 5.0});
   }
 
-resistance_sensor->connect_to(pressure_curve);
-
-if (enable_signalk_output) {
-  char pressure_sk_path[80];
-  snprintf(pressure_sk_path, sizeof(pressure_sk_path),
-  "propulsion.%s.oilPressure", sk_id.c_str());
-  auto sk_output_pressure = new sensesp::SKOutputFloat(
-  pressure_sk_path,
-  "/Propulsion/OilPressureSensor/Pressure",
-  new sensesp::SKMetadata("bar", "Oil Pressure", "Oil pressure in bar"));
+  resistance_sensor->connect_to(pressure_curve);
 
-  ConfigItem(sk_output_pressure)
-  ->set_title("Oil Pressure SK Path")
-  ->set_description("Signal K path for oil pressure")
-  ->set_sort_order(sort_order + 2);
+  if (enable_signalk_output) {
+    auto sk_output_pressure = GraphNew<sensesp::SKOutputFloat>(
+        sensor.pressure_sk_path, sensor.pressure_config_path,
+        GraphNew<sensesp::SKMetadata>("bar", sensor.pressure_meta_display_name,
+                                      sensor.pressure_meta_description));
+
+    ConfigItem(sk_output_pressure)
+        ->set_title(sensor.pressure_title)
+        ->set_description(sensor.pressure_description)
+        ->set_sort_order(sort_order + 2);
 
-  pressure_curve->connect_to(sk_output_pressure);
-}
+    pressure_curve->connect_to(GraphNew<SKDemandGate<float>>())
+        ->connect_to(sk_output_pressure);
+  }
 
-return pressure_curve;
+  return pressure_curve;
 }
 
-
-
 }  // namespace halmet
\ No newline at end of file
@@ -3,7 +3,14 @@
 
 #include <Adafruit_ADS1X15.h>
 
+#include "ads1115_range.h"
+#include "allocation_scope.h"
+#include "halmet_channels.h"
+#include "i2c_bus.h"
+#include "latency_probe.h"
+#include "sender_validity.h"
 #include "sensesp/sensors/sensor.h"
+#include "sensesp/system/observablevalue.h"
 #include "sensesp_base_app.h"
 
 namespace halmet {
@@ -11,23 +18,267 @@ namespace halmet {
 // HALMET voltage divider scale factor
 const float kVoltageDividerScale = 33.3 / 3.3;
 
+// HALMET constant measurement current (A)
+const float kMeasurementCurrent = 0.01;
+
+// Resistance (ohms) of a sender fed by the measurement current, given the
+// voltage at the ADS1115 input
+inline float SenderResistance(float adc_volts) {
+  return kVoltageDividerScale * adc_volts / kMeasurementCurrent;
+}
+
 sensesp::FloatProducer* ConnectTankSender(Adafruit_ADS1115* ads1115,
-                                          int channel, const String& name,
-                                          const String& sk_id, int sort_order,
+                                          const TankChannel& tank,
                                           bool enable_signalk_output = true);
 
 // Temperature part
-sensesp::FloatProducer* ConnectTemperatureSensor(Adafruit_ADS1115* ads1115,
-                                                 int channel, const String& name,
-                                                 const String& sk_id, int sort_order,
-                                                 bool enable_signalk_output = true);
+sensesp::FloatProducer* ConnectTemperatureSensor(
+    Adafruit_ADS1115* ads1115, const TemperatureChannel& sensor,
+    bool enable_signalk_output = true);
 
 // OilPressure part
-sensesp::FloatProducer* ConnectOilPressureSensor(Adafruit_ADS1115* ads1115,
-                                                int channel, const String& name,
-                                                const String& sk_id, int sort_order,
-                                                bool enable_signalk_output = true);
+sensesp::FloatProducer* ConnectOilPressureSensor(
+    Adafruit_ADS1115* ads1115, const OilPressureChannel& sensor,
+    bool enable_signalk_output = true);
+
+// PGA settings in the order of kADS1115FullScale
+const adsGain_t kADS1115Gains[kADS1115Ranges] = {
+    GAIN_TWOTHIRDS, GAIN_ONE, GAIN_TWO, GAIN_FOUR, GAIN_EIGHT, GAIN_SIXTEEN};
+
+// Adafruit_ADS1X15 discards the results of its I2C transfers. A member
+// pointer taken in a derived class gives access to the library's I2C device,
+// so the same transfers can be made with their results checked.
+struct ADS1115Transfers : public Adafruit_ADS1115 {
+  static bool write_register(Adafruit_ADS1115* ads1115, uint8_t reg,
+                             uint16_t value) {
+    Adafruit_I2CDevice* device = ads1115->*(&ADS1115Transfers::m_i2c_dev);
+    uint8_t buffer[3] = {reg, static_cast<uint8_t>(value >> 8),
+                         static_cast<uint8_t>(value & 0xff)};
+    return device->write(buffer, 3);
+  }
+
+  static bool read_register(Adafruit_ADS1115* ads1115, uint8_t reg,
+                            uint16_t* value) {
+    Adafruit_I2CDevice* device = ads1115->*(&ADS1115Transfers::m_i2c_dev);
+    uint8_t buffer[2] = {reg, 0};
+    if (!device->write(buffer, 1) || !device->read(buffer, 2)) {
+      return false;
+    }
+    *value = (buffer[0] << 8) | buffer[1];
+    return true;
+  }
+
+  /// startADCReading() for a single-shot conversion at the current gain.
+  static bool start_reading(Adafruit_ADS1115* ads1115, uint16_t mux) {
+    uint16_t config =
+        ADS1X15_REG_CONFIG_CQUE_1CONV | ADS1X15_REG_CONFIG_CLAT_NONLAT |
+        ADS1X15_REG_CONFIG_CPOL_ACTVLOW | ADS1X15_REG_CONFIG_CMODE_TRAD |
+        ADS1X15_REG_CONFIG_MODE_SINGLE | ads1115->getGain() |
+        ads1115->getDataRate() | mux | ADS1X15_REG_CONFIG_OS_SINGLE;
+    return write_register(ads1115, ADS1X15_REG_POINTER_CONFIG, config) &&
+           write_register(ads1115, ADS1X15_REG_POINTER_HITHRESH, 0x8000) &&
+           write_register(ads1115, ADS1X15_REG_POINTER_LOWTHRESH, 0x0000);
+  }
+};
+
+/**
+ * @brief Per-channel gain selection for a shared ADS1115.
+ *
+ * The PGA gain is set before every conversion, so each channel reads at its
+ * own gain; computeVolts() then scales by the gain that was actually used.
+ * After each reading, the gain for the next one is chosen with
+ * SelectADS1115Range(). If a reading may have clipped, it is repeated at
+ * once in the wider range.
+ *
+ * Conversions are started and polled with a deadline instead of the
+ * library's unbounded wait. Every transfer is checked, and failures go to
+ * ADS1115Guard(). While the ADS1115 is faulted, read_volts() returns NAN
+ * without touching the bus.
+ */
+class ADS1115AutoRange {
+ public:
+  // Conversion time at the default 128 samples/s is 8 ms
+  static const uint32_t kConversionTimeoutMs = 20;
+
+  explicit ADS1115AutoRange(int range = 1) : range_{range} {}
+
+  float read_volts(Adafruit_ADS1115* ads1115, int channel) {
+    I2CDeviceGuard& guard = ADS1115Guard();
+    if (!guard.available(millis())) {
+      return NAN;
+    }
+    float volts = read_volts_at(ads1115, channel, range_);
+    if (!isnan(volts)) {
+      int range = SelectADS1115Range(range_, volts);
+      if (range < range_) {
+        volts = read_volts_at(ads1115, channel, range);
+      }
+      range_ = range;
+    }
+    if (isnan(volts)) {
+      I2CFailure(guard);
+    } else {
+      guard.record_success();
+    }
+    return volts;
+  }
+
+  int range() const { return range_; }
+
+ protected:
+  // Returns NAN if a transfer is not acknowledged or the conversion times
+  // out.
+  static float read_volts_at(Adafruit_ADS1115* ads1115, int channel,
+                             int range) {
+    ads1115->setGain(kADS1115Gains[range]);
+    if (!ADS1115Transfers::start_reading(ads1115, MUX_BY_CHANNEL[channel])) {
+      return NAN;
+    }
+    uint32_t start = millis();
+    uint16_t config;
+    while (true) {
+      if (!ADS1115Transfers::read_register(
+              ads1115, ADS1X15_REG_POINTER_CONFIG, &config)) {
+        return NAN;
+      }
+      if ((config & ADS1X15_REG_CONFIG_OS_MASK) != 0) {
+        break;
+      }
+      if (millis() - start > kConversionTimeoutMs) {
+        return NAN;
+      }
+    }
+    uint16_t raw;
+    if (!ADS1115Transfers::read_register(ads1115, ADS1X15_REG_POINTER_CONVERT,
+                                         &raw)) {
+      return NAN;
+    }
+    return ads1115->computeVolts(static_cast<int16_t>(raw));
+  }
+
+  int range_;
+};
+
+/**
+ * @brief Resistance of a sender connected to an ADS1115 channel.
+ *
+ * All ADC access of the resistive senders goes through read_volts(), and
+ * the conversion through SenderResistance(), so both can be exercised
+ * separately from the sensor graph. Each input selects its own gain.
+ *
+ * Every reading is checked against the sender limits. An open, shorted or
+ * out of range sender emits NAN, which the curves pass on and the N2k
+ * senders transmit as "not available", and fault_ reports the reason as a
+ * SenderFault code whenever it changes.
+ *
+ * The read interval can be changed in the web UI without a restart, as for
+ * ADS1115VoltageInput.
+ */
+class ADS1115ResistanceInput : public sensesp::FloatSensor {
+ public:
+  ADS1115ResistanceInput(Adafruit_ADS1115* ads1115, int channel,
+                         const String& config_path,
+                         unsigned int read_interval = 500,
+                         const SenderLimits& limits = kNoSenderLimits)
+      : sensesp::FloatSensor(config_path),
+        ads1115_{ads1115},
+        channel_{channel},
+        read_interval_{read_interval},
+        limits_{limits} {
+    load();
+
+    repeat_event_ = set_repeat_event(read_interval_);
+  }
+
+  // Nothing is emitted while the ADS1115 is faulted, so the downstream
+  // N2k sender inputs expire instead of carrying a stale value.
+  void update() {
+    AllocationScope allocation_scope(AllocationSource::kSample);
+    uint32_t sample_ms = millis();
+    float volts = read_volts();
+    if (isnan(volts)) {
+      return;
+    }
+    float ohms = SenderResistance(volts);
+    SenderFault fault = ClassifySenderResistance(ohms, limits_);
+    if (fault != fault_code_) {
+      fault_code_ = fault;
+      fault_.set(static_cast<int>(fault));
+    }
+    LatencySampleScope scope(sample_ms);
+    this->emit(fault == SenderFault::kValid ? ohms : NAN);
+  }
+
+  sensesp::ObservableValue<int> fault_;  // SenderFault code
+
+  virtual bool to_json(JsonObject& root) override {
+    root["read_interval"] = read_interval_;
+    return true;
+  }
+
+  virtual bool from_json(const JsonObject& config) override {
+    if (!config["read_interval"].is<unsigned int>()) {
+      return false;
+    }
+    unsigned int read_interval = config["read_interval"];
+    if (read_interval == 0) {
+      return false;
+    }
+    if (read_interval != read_interval_) {
+      read_interval_ = read_interval;
+      // Not yet scheduled while loading in the constructor
+      if (repeat_event_ != nullptr) {
+        set_repeat_event(read_interval_);
+      }
+    }
+    return true;
+  }
+
+ protected:
+  float read_volts() { return auto_range_.read_volts(ads1115_, channel_); }
+
+  reactesp::RepeatEvent* repeat_event_ = nullptr;
+
+  reactesp::RepeatEvent* set_repeat_event(unsigned int read_interval) {
+    if (repeat_event_ != nullptr) {
+      repeat_event_->remove(sensesp::event_loop());
+    }
+
+    repeat_event_ = sensesp::event_loop()->onRepeat(
+        read_interval, [this]() { this->update(); });
+    return repeat_event_;
+  }
+
+  Adafruit_ADS1115* ads1115_;
+  int channel_;
+  unsigned int read_interval_;
+  SenderLimits limits_;
+  // Not a valid code, so that the first reading is always reported
+  SenderFault fault_code_ = static_cast<SenderFault>(-1);
+  ADS1115AutoRange auto_range_;
+};
+
+inline const String ConfigSchema(const ADS1115ResistanceInput& obj) {
+  const char SCHEMA[] = R"###({
+      "type": "object",
+      "properties": {
+          "read_interval": { "title": "Read interval", "type": "integer", "minimum": 1, "description": "Time between readings (ms)" }
+      }
+    })###";
+
+  return SCHEMA;
+}
 
+inline const bool ConfigRequiresRestart(const ADS1115ResistanceInput& obj) {
+  return false;
+}
+
+/**
+ * @brief Calibrated voltage of an ADS1115 channel behind the HALMET divider.
+ *
+ * The calibration factor and the read interval can be changed in the web
+ * UI without a restart; a new read interval reschedules the read timer.
+ */
 class ADS1115VoltageInput : public sensesp::FloatSensor {
  public:
   ADS1115VoltageInput(Adafruit_ADS1115* ads1115, int channel,
@@ -45,22 +296,39 @@ class ADS1115VoltageInput : public sensesp::FloatSensor {
   }
 
   void update() {
-    int16_t adc_output = ads1115_->readADC_SingleEnded(channel_);
-    float adc_output_volts = ads1115_->computeVolts(adc_output);
+    AllocationScope allocation_scope(AllocationSource::kSample);
+    uint32_t sample_ms = millis();
+    float adc_output_volts = auto_range_.read_volts(ads1115_, channel_);
+    if (isnan(adc_output_volts)) {
+      return;
+    }
+    LatencySampleScope scope(sample_ms);
     this->emit(calibration_factor_ * kVoltageDividerScale * adc_output_volts);
   }
 
   virtual bool to_json(JsonObject& root) override {
     root["calibration_factor"] = calibration_factor_;
+    root["read_interval"] = read_interval_;
     return true;
   };
 
   virtual bool from_json(const JsonObject& config) override {
-    if (config["calibration_factor"].is<float>()) {
-      calibration_factor_ = config["calibration_factor"];
-      return true;
+    if (!config["calibration_factor"].is<float>()) {
+      return false;
     }
-    return false;
+    calibration_factor_ = config["calibration_factor"];
+    // Older configurations have no read interval
+    if (config["read_interval"].is<unsigned int>()) {
+      unsigned int read_interval = config["read_interval"];
+      if (read_interval > 0 && read_interval != read_interval_) {
+        read_interval_ = read_interval;
+        // Not yet scheduled while loading in the constructor
+        if (repeat_event_ != nullptr) {
+          set_repeat_event(read_interval_);
+        }
+      }
+    }
+    return true;
   }
 
  protected:
@@ -81,13 +349,15 @@ class ADS1115VoltageInput : public sensesp::FloatSensor {
   int channel_;
   unsigned int read_interval_;
   float calibration_factor_;
+  ADS1115AutoRange auto_range_;
 };
 
 inline const String ConfigSchema(const ADS1115VoltageInput& obj) {
   const char SCHEMA[] = R"###({
       "type": "object",
       "properties": {
-          "calibration_factor": { "title": "Calibration factor", "type": "number", "description": "Multiplier to apply to the raw input value" }
+          "calibration_factor": { "title": "Calibration factor", "type": "number", "description": "Multiplier to apply to the raw input value" },
+          "read_interval": { "title": "Read interval", "type": "integer", "description": "Time between readings (ms)" }
       }
     })###";
 
@@ -95,7 +365,7 @@ inline const String ConfigSchema(const ADS1115VoltageInput& obj) {
 }
 
 inline const bool ConfigRequiresRestart(const ADS1115VoltageInput& obj) {
-  return true;
+  return false;
 }
 
 }  // namespace halmet
@@ -0,0 +1,233 @@
+#ifndef HALMET_SRC_HALMET_CHANNELS_H_
+#define HALMET_SRC_HALMET_CHANNELS_H_
+
+// Channel topology tables for the Connect* helpers.
+//
+// Each HALMET_*_CHANNEL_STRINGS list holds the config paths, UI titles,
+// descriptions and Signal K metadata of one channel type, as string literal
+// patterns in NAME and SK_ID. It is the single source of these strings:
+//
+// - The HALMET_*_CHANNEL macros expand a list with literal NAME and SK_ID
+//   into an aggregate initializer. The strings are assembled by the
+//   compiler and live in flash; the Connect* helpers need no stack buffers
+//   or snprintf calls at boot.
+// - The channel manifest expands the same list with the placeholders
+//   below and substitutes them at runtime with ExpandChannelString(), so a
+//   channel keeps its configuration when it moves between the manifest and
+//   the compiled-in table.
+//
+// NAME and SK_ID must be string literals:
+//
+//   constexpr TankChannel kFuelTank =
+//       HALMET_TANK_CHANNEL(0, "Fuel", "fuel.main", 3000);
+
+#include <stddef.h>
+#include <string.h>
+
+#include "sender_validity.h"
+
+// Placeholders for NAME and SK_ID in the runtime patterns. Neither can
+// occur in a channel name or Signal K id.
+#define HALMET_CHANNEL_NAME "\x01"
+#define HALMET_CHANNEL_SK_ID "\x02"
+
+// X-macro helpers: declare a string member, or emit its initializer.
+#define HALMET_CHANNEL_STRING_MEMBER(FIELD, PATTERN) const char* FIELD;
+#define HALMET_CHANNEL_STRING_VALUE(FIELD, PATTERN) PATTERN,
+
+namespace halmet {
+
+/**
+ * @brief Substitute NAME and SK_ID into a channel string pattern.
+ *
+ * Writes the result to buffer, truncated to size - 1 characters, and
+ * returns the length of the full result.
+ */
+inline size_t ExpandChannelString(const char* pattern, const char* name,
+                                  const char* sk_id, char* buffer,
+                                  size_t size) {
+  size_t length = 0;
+  for (const char* p = pattern; *p != '\0'; p++) {
+    const char* insert = *p == HALMET_CHANNEL_NAME[0]    ? name
+                         : *p == HALMET_CHANNEL_SK_ID[0] ? sk_id
+                                                         : nullptr;
+    size_t count = insert != nullptr ? strlen(insert) : 1;
+    for (size_t i = 0; i < count; i++, length++) {
+      if (length + 1 < size) {
+        buffer[length] = insert != nullptr ? insert[i] : *p;
+      }
+    }
+  }
+  if (size > 0) {
+    buffer[length < size ? length : size - 1] = '\0';
+  }
+  return length;
+}
+
+#define HALMET_TANK_CHANNEL_STRINGS(X, NAME, SK_ID)                        \
+  X(resistance_sk_config_path, "/Tanks/" NAME "/Resistance/SK Path")       \
+  X(resistance_title, NAME " Tank Sender Resistance SK Path")              \
+  X(resistance_description,                                                \
+    "Signal K path for the sender resistance of the " NAME " tank")        \
+  X(resistance_sk_path, "tanks." SK_ID ".senderResistance")               \
+  X(resistance_meta_display_name, "Resistance " NAME)                      \
+  X(resistance_meta_description, "Measured tank " NAME " sender resistance") \
+                                                                           \
+  X(curve_config_path, "/Tanks/" NAME "/Level Curve")                      \
+  X(curve_title, NAME " Tank Level Curve")                                 \
+  X(curve_description, "Piecewise linear curve for the " NAME " tank level") \
+                                                                           \
+  X(level_config_path, "/Tanks/" NAME "/Current Level SK Path")            \
+  X(level_title, NAME " Tank Level SK Path")                               \
+  X(level_description, "Signal K path for the " NAME " tank level")        \
+  X(level_sk_path, "tanks." SK_ID ".currentLevel")                         \
+  X(level_meta_display_name, "Tank " NAME " level")                        \
+  X(level_meta_description, "Tank " NAME " level")                         \
+                                                                           \
+  X(volume_config_path, "/Tanks/" NAME "/Total Volume")                    \
+  X(volume_title, NAME " Tank Total Volume")                               \
+  X(volume_description, "Calculated total volume of the " NAME " tank")    \
+                                                                           \
+  X(volume_sk_config_path, "/Tanks/" NAME "/Current Volume SK Path")       \
+  X(volume_sk_title, NAME " Tank Volume SK Path")                          \
+  X(volume_sk_description, "Signal K path for the " NAME " tank volume")   \
+  X(volume_sk_path, "tanks." SK_ID ".currentVolume")                       \
+  X(volume_meta_display_name, "Tank " NAME " volume")                      \
+  X(volume_meta_description, "Calculated tank " NAME " remaining volume")  \
+                                                                           \
+  X(fault_sk_path, "tanks." SK_ID ".senderFault")                          \
+                                                                           \
+  X(sender_config_path, "/Tanks/" NAME "/Sender")                          \
+  X(sender_title, NAME " Tank Sender")                                     \
+  X(sender_description, "Read interval of the " NAME " tank sender")
+
+struct TankChannel {
+  int channel;
+  int sort_order;
+  HALMET_TANK_CHANNEL_STRINGS(HALMET_CHANNEL_STRING_MEMBER, , )
+  SenderLimits limits;
+};
+
+#define HALMET_TANK_CHANNEL(CHANNEL, NAME, SK_ID, SORT_ORDER)             \
+  {                                                                       \
+    CHANNEL, SORT_ORDER,                                                  \
+        HALMET_TANK_CHANNEL_STRINGS(HALMET_CHANNEL_STRING_VALUE, NAME,    \
+                                    SK_ID) kTankSenderLimits              \
+  }
+
+// SK_ID is the full Signal K path of the temperature value, e.g.
+// "propulsion.main.coolantTemperature".
+#define HALMET_TEMPERATURE_CHANNEL_STRINGS(X, NAME, SK_ID)                 \
+  X(resistance_sk_config_path, "/Temperature/" NAME "/Resistance/SK Path") \
+  X(resistance_title, NAME " Temperature Sensor Resistance SK Path")       \
+  X(resistance_description, "Signal K path for the sensor resistance of "  \
+                            "the " NAME " temperature sensor")             \
+  X(resistance_sk_path, SK_ID ".sensorResistance")                         \
+  X(resistance_meta_display_name, "Resistance " NAME)                      \
+  X(resistance_meta_description,                                           \
+    "Measured temperature " NAME " sensor resistance")                     \
+                                                                           \
+  X(curve_config_path, "/Temperature/" NAME "/Curve")                      \
+  X(curve_title, NAME " Temperature Curve")                                \
+  X(curve_description,                                                     \
+    "Piecewise linear curve for the " NAME " temperature sensor")          \
+                                                                           \
+  X(temperature_config_path,                                               \
+    "/Temperature/" NAME "/Current Temperature SK Path")                   \
+  X(temperature_title, NAME " Temperature SK Path")                        \
+  X(temperature_description, "Signal K path for the " NAME " temperature") \
+  X(temperature_sk_path, SK_ID)                                            \
+  X(temperature_meta_display_name, "Temperature " NAME)                    \
+  X(temperature_meta_description,                                          \
+    "Measured temperature in Kelvin for " NAME)                            \
+                                                                           \
+  X(fault_sk_path, SK_ID ".sensorFault")                                   \
+                                                                           \
+  X(sender_config_path, "/Temperature/" NAME "/Sensor")                    \
+  X(sender_title, NAME " Temperature Sensor")                              \
+  X(sender_description, "Read interval of the " NAME " temperature sensor")
+
+struct TemperatureChannel {
+  int channel;
+  int sort_order;
+  HALMET_TEMPERATURE_CHANNEL_STRINGS(HALMET_CHANNEL_STRING_MEMBER, , )
+  SenderLimits limits;
+};
+
+#define HALMET_TEMPERATURE_CHANNEL(CHANNEL, NAME, SK_ID, SORT_ORDER)       \
+  {                                                                        \
+    CHANNEL, SORT_ORDER,                                                   \
+        HALMET_TEMPERATURE_CHANNEL_STRINGS(HALMET_CHANNEL_STRING_VALUE,    \
+                                           NAME, SK_ID)                    \
+            kTemperatureSenderLimits                                       \
+  }
+
+// SK_ID is the propulsion id, e.g. "main". NAME is the word before
+// "Pressure" in the config paths and titles: "Oil" gives the paths
+// "/Propulsion/OilPressureSensor/...", a second sender could be "Port Oil".
+#define HALMET_OIL_PRESSURE_CHANNEL_STRINGS(X, NAME, SK_ID)                \
+  X(resistance_sk_config_path,                                             \
+    "/Propulsion/" NAME "PressureSensor/Resistance")                       \
+  X(resistance_title, NAME " Pressure Sensor Resistance SK Path")          \
+  X(resistance_description,                                                \
+    "Signal K path for the " NAME " pressure sensor resistance")           \
+  X(resistance_sk_path, "propulsion." SK_ID ".oilPressureResistance")      \
+  X(resistance_meta_display_name, NAME " Pressure Resistance")             \
+  X(resistance_meta_description,                                           \
+    "Raw resistance of the " NAME " pressure sensor")                      \
+                                                                           \
+  X(curve_config_path, "/Propulsion/" NAME "PressureSensor/Curve")         \
+  X(curve_title, NAME " Pressure Sensor Curve")                            \
+  X(curve_description, "Converts resistance to " NAME " pressure")         \
+                                                                           \
+  X(pressure_config_path, "/Propulsion/" NAME "PressureSensor/Pressure")   \
+  X(pressure_title, NAME " Pressure SK Path")                              \
+  X(pressure_description, "Signal K path for " NAME " pressure")           \
+  X(pressure_sk_path, "propulsion." SK_ID ".oilPressure")                  \
+  X(pressure_meta_display_name, NAME " Pressure")                          \
+  X(pressure_meta_description, NAME " pressure in bar")                    \
+                                                                           \
+  X(fault_sk_path, "propulsion." SK_ID ".oilPressureSensorFault")          \
+                                                                           \
+  X(sender_config_path, "/Propulsion/" NAME "PressureSensor/Sender")       \
+  X(sender_title, NAME " Pressure Sensor")                                 \
+  X(sender_description, "Read interval of the " NAME " pressure sensor")
+
+struct OilPressureChannel {
+  int channel;
+  int sort_order;
+  HALMET_OIL_PRESSURE_CHANNEL_STRINGS(HALMET_CHANNEL_STRING_MEMBER, , )
+  SenderLimits limits;
+};
+
+#define HALMET_OIL_PRESSURE_CHANNEL(CHANNEL, NAME, SK_ID, SORT_ORDER)      \
+  {                                                                        \
+    CHANNEL, SORT_ORDER,                                                   \
+        HALMET_OIL_PRESSURE_CHANNEL_STRINGS(HALMET_CHANNEL_STRING_VALUE,   \
+                                            NAME, SK_ID)                   \
+            kOilPressureSenderLimits                                       \
+  }
+
+// There is no SK_ID; NAME is also the propulsion id.
+#define HALMET_TACHO_CHANNEL_STRINGS(X, NAME, SK_ID)                      \
+  X(input_title, "Tacho " NAME " Pin")                                    \
+  X(input_description, "Tacho " NAME " Input Pin")                        \
+  X(multiplier_config_path, "/Tacho " NAME "/Revolution Multiplier")      \
+  X(sk_config_path, "/Tacho " NAME "/Revolutions SK Path")                \
+  X(sk_path, "propulsion." NAME ".revolutions")                           \
+  X(sk_title, "Tacho " NAME " Signal K Path")                             \
+  X(sk_description, "Tacho " NAME " Signal K Path")
+
+struct TachoChannel {
+  int pin;
+  HALMET_TACHO_CHANNEL_STRINGS(HALMET_CHANNEL_STRING_MEMBER, , )
+};
+
+#define HALMET_TACHO_CHANNEL(PIN, NAME)                                  \
+  {                                                                      \
+    PIN, HALMET_TACHO_CHANNEL_STRINGS(HALMET_CHANNEL_STRING_VALUE, NAME, ) \
+  }
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_HALMET_CHANNELS_H_
@@ -1,10 +1,13 @@
 #include "halmet_digital.h"
 
+#include "graph_arena.h"
+#include "latency_probe.h"
 #include "sensesp/sensors/digital_input.h"
 #include "sensesp/sensors/sensor.h"
 #include "sensesp/signalk/signalk_output.h"
 #include "sensesp/transforms/frequency.h"
 #include "sensesp/ui/config_item.h"
+#include "sk_demand.h"
 
 using namespace sensesp;
 
@@ -25,49 +28,39 @@ Pulses per Engine Revolution = 6 × 2.166 ≈ 13
 
 const float kDefaultFrequencyScale = 1 / 13.;
 
-FloatProducer* ConnectTachoSender(int pin, String name) {
-  char config_path[80];
-  char sk_path[80];
-  char config_title[80];
-  char config_description[80];
+// Pulses are counted over this window (ms) before each frequency update
+const unsigned int kTachoReadInterval = 500;
 
-  snprintf(config_path, sizeof(config_path), "", name.c_str());
-  snprintf(config_title, sizeof(config_title), "Tacho %s Pin", name.c_str());
-  snprintf(config_description, sizeof(config_description), "Tacho %s Input Pin",
-           name.c_str());
-  auto tacho_input =
-      new DigitalInputCounter(pin, INPUT, RISING, 500, config_path);
+Frequency* ConnectTachoSender(const halmet::TachoChannel& tacho) {
+  auto tacho_input = halmet::GraphNew<DigitalInputCounter>(
+      tacho.pin, INPUT, RISING, kTachoReadInterval, "");
 
   ConfigItem(tacho_input)
-      ->set_title(config_title)
-      ->set_description(config_description);
-
-  snprintf(config_path, sizeof(config_path), "/Tacho %s/Revolution Multiplier",
-           name.c_str());
-  snprintf(config_title, sizeof(config_title), "Tacho %s Multiplier",
-           name.c_str());
-  snprintf(config_description, sizeof(config_description),
-           "Tacho %s Multiplier", name.c_str());
-  auto tacho_frequency = new Frequency(kDefaultFrequencyScale, config_path);
-
+      ->set_title(tacho.input_title)
+      ->set_description(tacho.input_description);
+
+  auto tacho_frequency = halmet::GraphNew<Frequency>(
+      kDefaultFrequencyScale, tacho.multiplier_config_path);
+
+#ifdef ENABLE_LATENCY_PROBES
+  // Time the tacho latency from the start of each counting window
+  tacho_input->connect_to(halmet::GraphNew<halmet::LatencyStamp<int>>(
+                               kTachoReadInterval))
+      ->connect_to(tacho_frequency);
+#else
   tacho_input->connect_to(tacho_frequency);
+#endif
 
 #ifdef ENABLE_SIGNALK
-  snprintf(config_path, sizeof(config_path), "/Tacho %s/Revolutions SK Path",
-           name.c_str());
-  snprintf(sk_path, sizeof(sk_path), "propulsion.%s.revolutions", name.c_str());
-  snprintf(config_title, sizeof(config_title), "Tacho %s Signal K Path",
-           name.c_str());
-  snprintf(config_description, sizeof(config_description),
-           "Tacho %s Signal K Path", name.c_str());
-
-  auto tacho_frequency_sk_output = new SKOutputFloat(sk_path, config_path);
+  auto tacho_frequency_sk_output =
+      halmet::GraphNew<SKOutputFloat>(tacho.sk_path, tacho.sk_config_path);
 
   ConfigItem(tacho_frequency_sk_output)
-      ->set_title(config_title)
-      ->set_description(config_description);
+      ->set_title(tacho.sk_title)
+      ->set_description(tacho.sk_description);
 
-  tacho_frequency->connect_to(tacho_frequency_sk_output);
+  tacho_frequency->connect_to(halmet::GraphNew<halmet::SKDemandGate<float>>())
+      ->connect_to(tacho_frequency_sk_output);
 #endif
 
   return tacho_frequency;
@@ -79,7 +72,7 @@ BoolProducer* ConnectAlarmSender(int pin, String name) {
   char config_title[80];
   char config_description[80];
 
-  auto* alarm_input = new DigitalInputState(pin, INPUT, 100);
+  auto* alarm_input = halmet::GraphNew<DigitalInputState>(pin, INPUT, 100);
 
 #ifdef ENABLE_SIGNALK
   snprintf(config_path, sizeof(config_path), "/Alarm %s/SK Path", name.c_str());
@@ -89,14 +82,39 @@ BoolProducer* ConnectAlarmSender(int pin, String name) {
   snprintf(config_description, sizeof(config_description),
            "Alarm %s Signal K Path", name.c_str());
 
-  auto alarm_sk_output = new SKOutputBool(sk_path, config_path);
+  auto alarm_sk_output = halmet::GraphNew<SKOutputBool>(sk_path, config_path);
 
   ConfigItem(alarm_sk_output)
       ->set_title(config_title)
       ->set_description(config_description);
 
-  alarm_input->connect_to(alarm_sk_output);
+  alarm_input->connect_to(halmet::GraphNew<halmet::SKDemandGate<bool>>())
+      ->connect_to(alarm_sk_output);
 #endif
 
   return alarm_input;
 }
+
+halmet::PulseCounter* ConnectPulseCounter(int pin, String name,
+                                          int sort_order) {
+  char config_path[80];
+  char config_title[80];
+  char config_description[80];
+
+  snprintf(config_path, sizeof(config_path), "/Pulse Counter %s",
+           name.c_str());
+  snprintf(config_title, sizeof(config_title), "%s Pulse Counter",
+           name.c_str());
+  snprintf(config_description, sizeof(config_description),
+           "Hardware pulse counter %s; rate in units/s, total in units",
+           name.c_str());
+
+  auto* counter = halmet::GraphNew<halmet::PulseCounter>(config_path, pin);
+
+  ConfigItem(counter)
+      ->set_title(config_title)
+      ->set_description(config_description)
+      ->set_sort_order(sort_order);
+
+  return counter;
+}
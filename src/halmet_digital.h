@@ -1,11 +1,19 @@
 #ifndef __SRC_HALMET_DIGITAL_H__
 #define __SRC_HALMET_DIGITAL_H__
 
+#include "halmet_channels.h"
+#include "pulse_counter.h"
 #include "sensesp/sensors/sensor.h"
+#include "sensesp/transforms/frequency.h"
 
 using namespace sensesp;
 
-FloatProducer* ConnectTachoSender(int pin, String name);
+// Returns the frequency transform, so that its multiplier can be read back
+Frequency* ConnectTachoSender(const halmet::TachoChannel& tacho);
 BoolProducer* ConnectAlarmSender(int pin, String name);
+// Count a fast pulse train, e.g. a fuel flow meter, in hardware. Use this
+// instead of ConnectTachoSender above a few hundred Hz.
+halmet::PulseCounter* ConnectPulseCounter(int pin, String name,
+                                          int sort_order = 3200);
 
 #endif
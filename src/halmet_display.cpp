@@ -3,20 +3,54 @@
 
 #include <WiFi.h>
 
+#include "graph_arena.h"
+#include "i2c_bus.h"
+
 namespace halmet {
 
 // OLED display width and height, in pixels
 const int kScreenWidth = 128;
 const int kScreenHeight = 64;
+const uint8_t kDisplayAddress = 0x3C;
+
+static TwoWire* display_i2c = nullptr;
+
+/// Check that the display answers before sending it a frame buffer. A
+/// missing display is retried with back-off instead of at every update.
+static bool DisplayReachable() {
+  I2CDeviceGuard& guard = DisplayGuard();
+  if (display_i2c == nullptr || !guard.available(millis())) {
+    return false;
+  }
+  display_i2c->beginTransmission(kDisplayAddress);
+  if (display_i2c->endTransmission() != 0) {
+    I2CFailure(guard);
+    return false;
+  }
+  guard.record_success();
+  return true;
+}
+
+/// Send the frame buffer to the display. Adafruit_SSD1306::display() does
+/// not report transfer errors, so the display is checked again afterwards
+/// and a failure goes to DisplayGuard().
+static void SendFrame(Adafruit_SSD1306* display) {
+  if (DisplayReachable()) {
+    display->display();
+    DisplayReachable();
+  }
+}
 
 bool InitializeSSD1306(sensesp::SensESPBaseApp* sensesp_app,
                        Adafruit_SSD1306** display, TwoWire* i2c) {
-  *display = new Adafruit_SSD1306(kScreenWidth, kScreenHeight, i2c, -1);
-  bool init_successful = (*display)->begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  *display = GraphNew<Adafruit_SSD1306>(kScreenWidth, kScreenHeight, i2c, -1);
+  bool init_successful =
+      (*display)->begin(SSD1306_SWITCHCAPVCC, kDisplayAddress);
   if (!init_successful) {
     debugD("SSD1306 allocation failed");
     return false;
   }
+  display_i2c = i2c;
   delay(100);
   (*display)->setRotation(2);
   (*display)->clearDisplay();
@@ -24,7 +58,7 @@ bool InitializeSSD1306(sensesp::SensESPBaseApp* sensesp_app,
   (*display)->setTextColor(SSD1306_WHITE);
   (*display)->setCursor(0, 0);
   (*display)->printf("Host: %s\n", sensesp_app->get_hostname().c_str());
-  (*display)->display();
+  SendFrame(*display);
 
   return true;
 }
@@ -34,19 +68,20 @@ void ClearRow(Adafruit_SSD1306* display, int row) {
   display->fillRect(0, 8 * row, kScreenWidth, 8, 0);
 }
 
-void PrintValue(Adafruit_SSD1306* display, int row, String title, float value) {
+void PrintValue(Adafruit_SSD1306* display, int row, const char* title,
+                float value) {
   ClearRow(display, row);
   display->setCursor(0, 8 * row);
-  display->printf("%s: %.1f", title.c_str(), value);
-  display->display();
+  display->printf("%s: %.1f", title, value);
+  SendFrame(display);
 }
 
-void PrintValue(Adafruit_SSD1306* display, int row, String title,
-                String value) {
+void PrintValue(Adafruit_SSD1306* display, int row, const char* title,
+                const char* value) {
   ClearRow(display, row);
   display->setCursor(0, 8 * row);
-  display->printf("%s: %s", title.c_str(), value.c_str());
-  display->display();
+  display->printf("%s: %s", title, value);
+  SendFrame(display);
 }
 
 }  // namespace halmet
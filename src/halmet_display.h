@@ -8,13 +8,26 @@
 
 namespace halmet {
 
+// Minimum time between redraws of a display row, in ms. Every redraw sends
+// the whole frame buffer over I2C.
+const unsigned int kDisplayUpdateInterval = 1000;
+
+// Text rows on the display. Row 0 shows the hostname and row 1 the IP
+// address; the value rows start at kFirstValueRow.
+const int kDisplayRows = 8;
+const int kFirstValueRow = 2;
+
 bool InitializeSSD1306(sensesp::SensESPBaseApp* sensesp_app,
                        Adafruit_SSD1306** display, TwoWire* i2c);
 
 void ClearRow(Adafruit_SSD1306* display, int row);
 
-void PrintValue(Adafruit_SSD1306* display, int row, String title, float value);
-void PrintValue(Adafruit_SSD1306* display, int row, String title, String value);
+// Titles and values are printed in place; no String copies are made on
+// these per-sample paths.
+void PrintValue(Adafruit_SSD1306* display, int row, const char* title,
+                float value);
+void PrintValue(Adafruit_SSD1306* display, int row, const char* title,
+                const char* value);
 
 }  // namespace halmet
 
@@ -0,0 +1,152 @@
+#include "halmet_nmea2000.h"
+
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+// Upper bound on ParseMessages() calls per batch, in case frames keep
+// arriving while the batch is being drained.
+static const int kMaxParseCallsPerBatch = 8;
+// The wake-up task only peeks at the queue and sends a notification. It
+// runs above the CAN task so that the notification is not delayed.
+static const uint32_t kRxWakeTaskStackSize = 2048;
+static const UBaseType_t kRxWakeTaskPriority = 11;
+
+HalmetNMEA2000::HalmetNMEA2000(gpio_num_t tx_pin, gpio_num_t rx_pin,
+                               unsigned int stats_interval_ms)
+    : tNMEA2000_esp32(tx_pin, rx_pin),
+      stats_interval_ms_{stats_interval_ms} {
+  sensesp::event_loop()->onRepeat(stats_interval_ms_,
+                                  [this]() { this->update_stats(); });
+}
+
+void HalmetNMEA2000::set_rx_buffer_size(uint16_t size) {
+  rx_buffer_size_ = size;
+  SetN2kCANReceiveFrameBufSize(size);
+}
+
+bool HalmetNMEA2000::enable_rx_interrupt(TaskHandle_t notify_task) {
+  if (RxQueue == nullptr) {
+    debugE("N2k receive queue not created; call Open() first");
+    return false;
+  }
+  rx_notify_task_ = notify_task;
+  BaseType_t result = xTaskCreate(rx_wake_task, "n2k_rx", kRxWakeTaskStackSize,
+                                  this, kRxWakeTaskPriority, &rx_wake_task_);
+  if (result != pdPASS) {
+    rx_wake_task_ = nullptr;
+    debugE("Failed to start the NMEA 2000 receive wake-up task");
+    return false;
+  }
+  return true;
+}
+
+void HalmetNMEA2000::rx_wake_task(void* parameter) {
+  auto self = static_cast<HalmetNMEA2000*>(parameter);
+  tCANFrame frame;
+  while (true) {
+    // Block until the driver's interrupt handler has queued a frame. The
+    // frame stays in the queue for ParseMessages().
+    xQueuePeek(self->RxQueue, &frame, portMAX_DELAY);
+    self->rx_pending_.store(true);
+    if (self->rx_notify_task_ != nullptr) {
+      xTaskNotifyGive(self->rx_notify_task_);
+    }
+    // Wait until the queue has been drained before peeking again
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+void HalmetNMEA2000::size_tx_buffer(const N2kTxBudget& budget) {
+  tx_buffer_size_ = budget.buffer_frames();
+  SetN2kCANSendFrameBufSize(tx_buffer_size_);
+  debugI(
+      "N2k send buffer: %u frames for %u senders (burst %u frames, "
+      "%.1f frames/s)",
+      tx_buffer_size_, budget.senders(), budget.burst_frames(),
+      budget.frames_per_second());
+  if (budget.may_overflow()) {
+    debugW(
+        "N2k send buffer may overflow: %u frames required, %u allocated. "
+        "Reduce the number of senders.",
+        budget.required_buffer_frames(), tx_buffer_size_);
+  }
+}
+
+bool HalmetNMEA2000::CANSendFrame(unsigned long id, unsigned char len,
+                                  const unsigned char* buf, bool wait_sent) {
+  tx_window_frames_++;
+  return tNMEA2000_esp32::CANSendFrame(id, len, buf, wait_sent);
+}
+
+bool HalmetNMEA2000::CANGetFrame(unsigned long& id, unsigned char& len,
+                                 unsigned char* buf) {
+  bool received = tNMEA2000_esp32::CANGetFrame(id, len, buf);
+  if (received) {
+    batch_frames_++;
+  }
+  return received;
+}
+
+size_t HalmetNMEA2000::parse_batch() {
+  batch_frames_ = 0;
+  if (RxQueue != nullptr && uxQueueSpacesAvailable(RxQueue) == 0) {
+    overflows_++;
+  }
+  for (int i = 0; i < kMaxParseCallsPerBatch; i++) {
+    uint32_t before = batch_frames_;
+    ParseMessages();
+    if (batch_frames_ == before) {
+      break;
+    }
+  }
+
+  // Frames handed to the driver since the previous pass have either been
+  // transmitted or are still waiting in the send buffer.
+  if (tx_window_frames_ > tx_high_water_) {
+    tx_high_water_ = tx_window_frames_;
+  }
+  tx_window_frames_ = 0;
+
+  rx_frames_ += batch_frames_;
+  if (batch_frames_ > batch_high_water_) {
+    batch_high_water_ = batch_frames_;
+  }
+  return batch_frames_;
+}
+
+bool HalmetNMEA2000::parse_if_pending() {
+  if (rx_wake_task_ == nullptr || !rx_pending_.exchange(false)) {
+    return false;
+  }
+  parse_batch();
+  // Frames queued after the last ParseMessages() call make the wake-up task
+  // return from its next peek at once, so they are not left waiting.
+  xTaskNotifyGive(rx_wake_task_);
+  return true;
+}
+
+void HalmetNMEA2000::update_stats() {
+  uint32_t frames = rx_frames_;
+  rx_frame_rate_.set((frames - last_rx_frames_) * 1000.0f / stats_interval_ms_);
+  last_rx_frames_ = frames;
+  rx_batch_high_water_.set(batch_high_water_);
+  if (rx_buffer_size_ > 0 && batch_high_water_ >= rx_buffer_size_) {
+    debugW("N2k receive batch of %u frames reached the %u frame receive "
+           "buffer",
+           batch_high_water_.load(), rx_buffer_size_);
+  }
+  uint32_t overflows = overflows_;
+  if (overflows != static_cast<uint32_t>(rx_overflows_.get())) {
+    debugW("N2k receive queue found full %u times; frames were dropped",
+           overflows);
+  }
+  rx_overflows_.set(overflows);
+  tx_burst_high_water_.set(tx_high_water_);
+  if (tx_buffer_size_ > 0 && tx_high_water_ >= tx_buffer_size_) {
+    debugW("N2k send burst of %u frames reached the %u frame send buffer",
+           tx_high_water_.load(), tx_buffer_size_);
+  }
+}
+
+}  // namespace halmet
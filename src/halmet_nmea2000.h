@@ -0,0 +1,91 @@
+#ifndef HALMET_SRC_HALMET_NMEA2000_H_
+#define HALMET_SRC_HALMET_NMEA2000_H_
+
+#include <NMEA2000_esp32.h>
+
+#include <atomic>
+
+#include "n2k_tx_budget.h"
+#include "sensesp/system/observablevalue.h"
+
+namespace halmet {
+
+/**
+ * @brief tNMEA2000_esp32 with receive statistics and interrupt-driven parsing.
+ *
+ * By default, ParseMessages() is polled every millisecond whether or not
+ * frames have arrived. After enable_rx_interrupt(), a small wake-up task
+ * blocks on the receive queue that the CAN driver's interrupt handler
+ * fills. When the first frame of a burst arrives, it marks the bus as
+ * active and notifies the parsing task, then waits until
+ * parse_if_pending() has drained the queue and re-armed it. A frame that
+ * arrives while the queue is being drained wakes the parsing task again
+ * right after re-arming, so no burst is missed.
+ *
+ * Frame counts are kept for both modes. Every stats_interval_ms they are
+ * published as the receive frame rate, the largest batch drained in one
+ * wake-up, and the number of times the driver's receive queue was found
+ * full. The driver drops frames while its queue is full and keeps no count
+ * of them, so each overflow stands for one or more lost frames.
+ *
+ * The send buffer is sized from the registered senders' transmit budget
+ * with size_tx_buffer(). Frames handed to the CAN driver between two parse
+ * passes are counted as well; their maximum is an upper bound on the send
+ * buffer fill level and is published next to the receive statistics.
+ */
+class HalmetNMEA2000 : public tNMEA2000_esp32 {
+ public:
+  HalmetNMEA2000(gpio_num_t tx_pin, gpio_num_t rx_pin,
+                 unsigned int stats_interval_ms = 10000);
+
+  void set_rx_buffer_size(uint16_t size);
+
+  /// Size the send buffer for the senders registered in budget. Must be
+  /// called before Open().
+  void size_tx_buffer(const N2kTxBudget& budget);
+
+  /// Start the wake-up task, which sets a pending flag and, if notify_task
+  /// is set, gives it a FreeRTOS task notification when frames arrive. Must
+  /// be called after Open().
+  bool enable_rx_interrupt(TaskHandle_t notify_task = nullptr);
+
+  /// Parse all frames received so far. Returns the number of frames read.
+  size_t parse_batch();
+
+  /// Parse a batch and re-arm the wake-up task if frames have arrived since
+  /// the last batch.
+  bool parse_if_pending();
+
+  sensesp::ObservableValue<float> rx_frame_rate_;     // frames/s
+  sensesp::ObservableValue<int> rx_batch_high_water_;  // frames
+  sensesp::ObservableValue<int> rx_overflows_;         // full queue events
+  sensesp::ObservableValue<int> tx_burst_high_water_;  // frames
+
+ protected:
+  bool CANGetFrame(unsigned long& id, unsigned char& len,
+                   unsigned char* buf) override;
+  bool CANSendFrame(unsigned long id, unsigned char len,
+                    const unsigned char* buf, bool wait_sent = true) override;
+
+  void update_stats();
+  static void rx_wake_task(void* parameter);
+
+  std::atomic<bool> rx_pending_{false};
+  TaskHandle_t rx_wake_task_ = nullptr;
+  TaskHandle_t rx_notify_task_ = nullptr;
+  uint16_t rx_buffer_size_ = 0;
+  uint16_t tx_buffer_size_ = 0;
+  unsigned int stats_interval_ms_;
+
+  std::atomic<uint32_t> rx_frames_{0};
+  std::atomic<uint32_t> batch_high_water_{0};
+  std::atomic<uint32_t> overflows_{0};
+  std::atomic<uint32_t> tx_high_water_{0};
+  uint32_t last_rx_frames_ = 0;
+  uint32_t batch_frames_ = 0;
+  uint32_t tx_window_frames_ = 0;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_HALMET_NMEA2000_H_
@@ -0,0 +1,82 @@
+#ifndef HALMET_SRC_HOLT_TREND_H_
+#define HALMET_SRC_HOLT_TREND_H_
+
+#include <math.h>
+#include <stdint.h>
+
+namespace halmet {
+
+/**
+ * @brief Streaming level and rate of change of a noisy signal.
+ *
+ * Holt's double exponential smoothing, adapted to irregular sample times:
+ * the level follows the samples with time constant level_tau and the trend
+ * follows the level's rate of change with time constant trend_tau. Each
+ * sample takes constant time and no memory is allocated.
+ */
+class HoltTrend {
+ public:
+  HoltTrend(float level_tau_s = 5, float trend_tau_s = 60)
+      : level_tau_{level_tau_s}, trend_tau_{trend_tau_s} {}
+
+  /// Add a sample. Times are in ms and may wrap around.
+  void add(uint32_t time_ms, float value) {
+    if (!started_) {
+      started_ = true;
+      level_ = value;
+      trend_ = 0;
+      age_ = 0;
+      last_ms_ = time_ms;
+      return;
+    }
+    // Signed, so that an out-of-order sample is not taken for one from the
+    // far future
+    float dt = static_cast<int32_t>(time_ms - last_ms_) / 1000.0f;
+    if (dt <= 0) {
+      return;
+    }
+    float alpha = dt / (level_tau_ + dt);
+    float beta = dt / (trend_tau_ + dt);
+    float previous = level_;
+    level_ = alpha * value + (1 - alpha) * (level_ + trend_ * dt);
+    trend_ = beta * (level_ - previous) / dt + (1 - beta) * trend_;
+    age_ += dt;
+    last_ms_ = time_ms;
+  }
+
+  void reset() { started_ = false; }
+
+  /// True once the trend has settled, i.e. after one trend time constant.
+  bool ready() const { return started_ && age_ >= trend_tau_; }
+
+  float level() const { return level_; }
+  /// Rate of change, in units per second
+  float trend() const { return trend_; }
+
+  /**
+   * @brief Seconds until the level reaches threshold at the current trend.
+   *
+   * INFINITY if the trend points away from the threshold, which includes a
+   * level that is already past it.
+   */
+  float time_to(float threshold) const {
+    float distance = threshold - level_;
+    if (trend_ == 0 || (distance > 0) != (trend_ > 0)) {
+      return INFINITY;
+    }
+    return distance / trend_;
+  }
+
+ protected:
+  float level_tau_;
+  float trend_tau_;
+  bool started_ = false;
+  float level_ = 0;
+  float trend_ = 0;
+  float age_ = 0;  // seconds since the first sample
+  uint32_t last_ms_ = 0;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_HOLT_TREND_H_
@@ -0,0 +1,100 @@
+#include "hot_path_benchmark.h"
+
+#include "halmet_analog.h"
+#include "halmet_display.h"
+#include "sensesp/transforms/curveinterpolator.h"
+#include "sensesp/transforms/lambda_transform.h"
+#include "sensesp/transforms/linear.h"
+
+namespace halmet {
+
+// Results are written here so that the compiler cannot drop the calls
+static volatile float sink;
+
+void HotPathBenchmark::run(N2kEngineParameterDynamicSender* dynamic_sender,
+                           Adafruit_SSD1306* display) {
+  num_results_ = 0;
+  overhead_ = 0;
+  measure("loop", []() {});
+  overhead_ = results_[0].cycles;
+  num_results_ = 0;
+
+  // Vary the input so that nothing is computed at compile time
+  volatile float input = 0;
+
+  measure("sender_resistance", [&input]() {
+    input = input + 0.001f;
+    sink = SenderResistance(input);
+  });
+
+  // The default tank curve from ConnectTankSender()
+  sensesp::CurveInterpolator curve(nullptr, "");
+  curve.add_sample(sensesp::CurveInterpolator::Sample(0, 0));
+  curve.add_sample(sensesp::CurveInterpolator::Sample(95., 0.5));
+  curve.add_sample(sensesp::CurveInterpolator::Sample(190., 1));
+  input = 0;
+  measure("curve_interpolator", [&input, &curve]() {
+    input = input + 0.5f;
+    curve.set(input);
+    sink = curve.get();
+  });
+
+  sensesp::Linear linear(0.07, 0, "");
+  measure("linear", [&input, &linear]() {
+    input = input + 0.5f;
+    linear.set(input);
+    sink = linear.get();
+  });
+
+  // The Hz to rpm conversion in N2kEngineParameterRapidSender
+  sensesp::LambdaTransform<double, double> rpm(
+      [](double value) { return 60 * value; });
+  measure("rapid_rpm_lambda", [&input, &rpm]() {
+    input = input + 0.5f;
+    rpm.set(input);
+    sink = rpm.get();
+  });
+
+  if (dynamic_sender != nullptr) {
+    measure("engine_status_1", [dynamic_sender]() {
+      sink = dynamic_sender->get_engine_status_1().Status;
+    });
+  }
+
+  measure("set_engine_dynamic_param", [&input]() {
+    input = input + 0.5f;
+    tN2kMsg msg;
+    SetN2kEngineDynamicParam(msg, 0, input * 1000, N2kDoubleNA, 350.0, 14.1,
+                             N2kDoubleNA, 3600, N2kDoubleNA, N2kDoubleNA,
+                             N2kInt8NA, N2kInt8NA, 0, 0);
+    sink = msg.DataLen;
+  });
+
+  if (display != nullptr) {
+    // Includes the I2C transfer of the display buffer, so keep it short
+    measure(
+        "print_value",
+        [&input, display]() {
+          input = input + 0.5f;
+          PrintValue(display, 7, "Benchmark", input);
+        },
+        5);
+    ClearRow(display, 7);
+    display->display();
+  }
+
+  print_json(Serial);
+}
+
+void HotPathBenchmark::print_json(Print& out) const {
+  out.printf("HOT_PATH_BENCHMARK {\"target\":\"esp32\",\"cpu_mhz\":%u,"
+             "\"iterations\":%u,\"cycles\":{",
+             getCpuFrequencyMhz(), iterations_);
+  for (size_t i = 0; i < num_results_; i++) {
+    out.printf("%s\"%s\":%.1f", i == 0 ? "" : ",", results_[i].name,
+               results_[i].cycles);
+  }
+  out.print("}}\n");
+}
+
+}  // namespace halmet
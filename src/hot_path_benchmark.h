@@ -0,0 +1,76 @@
+#ifndef HALMET_SRC_HOT_PATH_BENCHMARK_H_
+#define HALMET_SRC_HOT_PATH_BENCHMARK_H_
+
+#include <Adafruit_SSD1306.h>
+#include <Arduino.h>
+
+#include "n2k_senders.h"
+
+namespace halmet {
+
+/**
+ * @brief Cycle counts of the code that runs for every sample or message.
+ *
+ * Each path is run in several batches of the given number of iterations,
+ * using the CPU cycle counter. The fastest batch, less the loop overhead,
+ * is reported, since interrupts and the other core only ever add cycles.
+ *
+ * The results are printed to the serial port as a single JSON line
+ * starting with "HOT_PATH_BENCHMARK ". tools/hot_path_check.py compares
+ * them with tools/hot_path_baseline_esp32.json and fails when a path has
+ * become slower than the allowed threshold. The paths that do not need the
+ * Arduino core are also timed on the host by test/test_hot_path.
+ */
+class HotPathBenchmark {
+ public:
+  static const size_t kMaxResults = 12;
+  static const int kBatches = 5;
+
+  explicit HotPathBenchmark(unsigned int iterations = 200)
+      : iterations_{iterations} {}
+
+  /// Measure all hot paths and print the results. display may be nullptr.
+  void run(N2kEngineParameterDynamicSender* dynamic_sender,
+           Adafruit_SSD1306* display);
+
+  /// Measure fn() and store the mean cycles per call under name.
+  template <typename F>
+  void measure(const char* name, F fn, unsigned int iterations = 0) {
+    if (num_results_ >= kMaxResults) {
+      return;
+    }
+    if (iterations == 0) {
+      iterations = iterations_;
+    }
+    uint32_t best = UINT32_MAX;
+    for (int batch = 0; batch < kBatches; batch++) {
+      uint32_t start = ESP.getCycleCount();
+      for (unsigned int i = 0; i < iterations; i++) {
+        fn();
+      }
+      uint32_t cycles = ESP.getCycleCount() - start;
+      if (cycles < best) {
+        best = cycles;
+      }
+    }
+    float per_call = static_cast<float>(best) / iterations - overhead_;
+    results_[num_results_++] = {name, per_call > 0 ? per_call : 0};
+  }
+
+  void print_json(Print& out) const;
+
+ protected:
+  struct Result {
+    const char* name;
+    float cycles;
+  };
+
+  unsigned int iterations_;
+  float overhead_ = 0;
+  Result results_[kMaxResults];
+  size_t num_results_ = 0;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_HOT_PATH_BENCHMARK_H_
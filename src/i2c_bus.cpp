@@ -0,0 +1,82 @@
+#include "i2c_bus.h"
+
+#include <Arduino.h>
+
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+// Half period of the recovery clock, for about 100 kHz
+static const uint32_t kRecoveryHalfPeriodUs = 5;
+
+static TwoWire* i2c_bus = nullptr;
+static int i2c_sda_pin = -1;
+static int i2c_scl_pin = -1;
+
+void BeginI2CBus(TwoWire* i2c, int sda_pin, int scl_pin) {
+  i2c_bus = i2c;
+  i2c_sda_pin = sda_pin;
+  i2c_scl_pin = scl_pin;
+  i2c_bus->begin(sda_pin, scl_pin);
+  i2c_bus->setTimeOut(kI2CTimeoutMs);
+}
+
+void RecoverI2CBus() {
+  if (i2c_bus == nullptr) {
+    return;
+  }
+  i2c_bus->end();
+
+  pinMode(i2c_sda_pin, INPUT_PULLUP);
+  pinMode(i2c_scl_pin, OUTPUT_OPEN_DRAIN);
+  digitalWrite(i2c_scl_pin, HIGH);
+  int pulses = 0;
+  while (pulses < 9 && digitalRead(i2c_sda_pin) == LOW) {
+    digitalWrite(i2c_scl_pin, LOW);
+    delayMicroseconds(kRecoveryHalfPeriodUs);
+    digitalWrite(i2c_scl_pin, HIGH);
+    delayMicroseconds(kRecoveryHalfPeriodUs);
+    pulses++;
+  }
+
+  // STOP: SDA rises while SCL is high
+  pinMode(i2c_sda_pin, OUTPUT_OPEN_DRAIN);
+  digitalWrite(i2c_sda_pin, LOW);
+  delayMicroseconds(kRecoveryHalfPeriodUs);
+  digitalWrite(i2c_scl_pin, HIGH);
+  delayMicroseconds(kRecoveryHalfPeriodUs);
+  digitalWrite(i2c_sda_pin, HIGH);
+  delayMicroseconds(kRecoveryHalfPeriodUs);
+
+  bool released = digitalRead(i2c_sda_pin) == HIGH;
+  i2c_bus->begin(i2c_sda_pin, i2c_scl_pin);
+  i2c_bus->setTimeOut(kI2CTimeoutMs);
+  debugW("I2C bus recovery after %d clock pulses: SDA %s", pulses,
+         released ? "released" : "still held low");
+}
+
+void I2CFailure(I2CDeviceGuard& guard) {
+  uint32_t failures = guard.record_failure(millis());
+  if (failures == 1) {
+    debugW("I2C: %s not responding", guard.name());
+  }
+  if (failures == 2) {
+    RecoverI2CBus();
+  }
+  if (failures >= 2) {
+    debugW("I2C: %s still not responding, next attempt in %u ms",
+           guard.name(), guard.backoff_ms());
+  }
+}
+
+I2CDeviceGuard& ADS1115Guard() {
+  static I2CDeviceGuard guard("ADS1115");
+  return guard;
+}
+
+I2CDeviceGuard& DisplayGuard() {
+  static I2CDeviceGuard guard("SSD1306");
+  return guard;
+}
+
+}  // namespace halmet
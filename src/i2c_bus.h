@@ -0,0 +1,36 @@
+#ifndef HALMET_SRC_I2C_BUS_H_
+#define HALMET_SRC_I2C_BUS_H_
+
+#include <Wire.h>
+
+#include "i2c_device_guard.h"
+
+namespace halmet {
+
+// Longest time a single I2C transaction may block the event loop
+const uint16_t kI2CTimeoutMs = 20;
+
+/// Start the shared I2C bus with a bounded transaction time, and remember
+/// the pins for RecoverI2CBus().
+void BeginI2CBus(TwoWire* i2c, int sda_pin, int scl_pin);
+
+/**
+ * @brief Free a bus held low by a device and restart the controller.
+ *
+ * A device that lost a clock edge in the middle of a read can keep SDA low
+ * indefinitely. Up to nine SCL pulses let it finish the byte, and a STOP
+ * condition then returns the bus to idle.
+ */
+void RecoverI2CBus();
+
+/// Record a failed transaction on a device. The bus is recovered on the
+/// second consecutive failure, in case a stuck SDA line is the cause.
+void I2CFailure(I2CDeviceGuard& guard);
+
+/// Guards of the devices on the HALMET I2C bus.
+I2CDeviceGuard& ADS1115Guard();
+I2CDeviceGuard& DisplayGuard();
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_I2C_BUS_H_
@@ -0,0 +1,68 @@
+#ifndef HALMET_SRC_I2C_DEVICE_GUARD_H_
+#define HALMET_SRC_I2C_DEVICE_GUARD_H_
+
+#include <stdint.h>
+
+namespace halmet {
+
+/**
+ * @brief Error counter and retry back-off for one I2C device.
+ *
+ * After a failed transaction, the device is left alone for a back-off time
+ * that starts at kMinBackoffMs and doubles with every further consecutive
+ * failure, up to kMaxBackoffMs. A device that has been unplugged therefore
+ * costs one bounded transaction every 30 s instead of one per reading. The
+ * first successful transaction clears the fault.
+ *
+ * Times are passed in, so the class does not depend on the Arduino core.
+ */
+class I2CDeviceGuard {
+ public:
+  static const uint32_t kMinBackoffMs = 500;
+  static const uint32_t kMaxBackoffMs = 30000;
+
+  explicit I2CDeviceGuard(const char* name) : name_{name} {}
+
+  /// True if the device may be accessed at now_ms.
+  bool available(uint32_t now_ms) const {
+    return failures_ == 0 ||
+           static_cast<int32_t>(now_ms - retry_at_ms_) >= 0;
+  }
+
+  void record_success() {
+    failures_ = 0;
+    backoff_ms_ = 0;
+  }
+
+  /// Record a failed transaction. Returns the number of consecutive
+  /// failures, including this one.
+  uint32_t record_failure(uint32_t now_ms) {
+    errors_++;
+    failures_++;
+    if (backoff_ms_ == 0) {
+      backoff_ms_ = kMinBackoffMs;
+    } else if (backoff_ms_ < kMaxBackoffMs / 2) {
+      backoff_ms_ *= 2;
+    } else {
+      backoff_ms_ = kMaxBackoffMs;
+    }
+    retry_at_ms_ = now_ms + backoff_ms_;
+    return failures_;
+  }
+
+  bool faulted() const { return failures_ > 0; }
+  uint32_t errors() const { return errors_; }
+  uint32_t backoff_ms() const { return backoff_ms_; }
+  const char* name() const { return name_; }
+
+ protected:
+  const char* name_;
+  uint32_t errors_ = 0;    // failed transactions since boot
+  uint32_t failures_ = 0;  // consecutive failed transactions
+  uint32_t backoff_ms_ = 0;
+  uint32_t retry_at_ms_ = 0;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_I2C_DEVICE_GUARD_H_
@@ -0,0 +1,106 @@
+#include "latency_probe.h"
+
+#include <Arduino.h>
+
+#include "graph_arena.h"
+#include "sensesp/signalk/signalk_output.h"
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+static const size_t kMaxLatencyProbes = 8;
+static LatencyProbe* latency_probes[kMaxLatencyProbes];
+static size_t num_latency_probes = 0;
+
+// The sample time of the innermost active scope. Only the event loop emits
+// values, so there is one of each.
+static bool sample_scope_active = false;
+static uint32_t sample_scope_ms = 0;
+
+LatencySampleScope::LatencySampleScope(uint32_t sample_ms)
+    : outer_active_{sample_scope_active}, outer_sample_ms_{sample_scope_ms} {
+  sample_scope_active = true;
+  sample_scope_ms = sample_ms;
+}
+
+LatencySampleScope::~LatencySampleScope() {
+  sample_scope_active = outer_active_;
+  sample_scope_ms = outer_sample_ms_;
+}
+
+uint32_t LatencySampleTime() {
+  return sample_scope_active ? sample_scope_ms : millis();
+}
+
+LatencyProbe::LatencyProbe(const char* name, uint32_t pgn, float threshold,
+                           unsigned int report_interval)
+    : name_{name}, pgn_{pgn}, stats_{threshold} {
+  if (num_latency_probes < kMaxLatencyProbes) {
+    latency_probes[num_latency_probes++] = this;
+  } else {
+    debugE("LatencyProbe: Too many probes, %s is not measured", name);
+  }
+  sensesp::event_loop()->onRepeat(report_interval,
+                                  [this]() { this->report(); });
+}
+
+void LatencyProbe::set(const float& value) {
+  uint32_t sample_ms = LatencySampleTime();
+  portENTER_CRITICAL(&lock_);
+  stats_.sample(value, sample_ms);
+  portEXIT_CRITICAL(&lock_);
+}
+
+void LatencyProbe::on_send(uint32_t pgn) {
+  if (pgn != pgn_) {
+    return;
+  }
+  uint32_t now = millis();
+  portENTER_CRITICAL(&lock_);
+  stats_.sent(now);
+  portEXIT_CRITICAL(&lock_);
+}
+
+void LatencyProbe::report() {
+  portENTER_CRITICAL(&lock_);
+  LatencyStats stats = stats_;
+  stats_.reset();
+  portEXIT_CRITICAL(&lock_);
+
+  if (stats.count() == 0) {
+    return;
+  }
+  debugI("Latency %s -> PGN %u: mean %.0f ms, max %u ms (%u changes)", name_,
+         pgn_, stats.mean_ms(), stats.max_ms(), stats.count());
+  max_latency_.set(stats.max_ms());
+  mean_latency_.set(stats.mean_ms());
+}
+
+void NotifyLatencyProbes(uint32_t pgn) {
+  for (size_t i = 0; i < num_latency_probes; i++) {
+    latency_probes[i]->on_send(pgn);
+  }
+}
+
+LatencyProbe* ConnectLatencyProbe(sensesp::FloatProducer* producer,
+                                  const char* name, uint32_t pgn) {
+  if (producer == nullptr) {
+    return nullptr;
+  }
+  auto probe = GraphNew<LatencyProbe>(name, pgn);
+  producer->connect_to(probe);
+
+#ifdef ENABLE_SIGNALK
+  String path = String("sensors.halmet.latency.") + name;
+  probe->max_latency_.connect_to(GraphNew<sensesp::SKOutputFloat>(
+      path + ".max", "",
+      GraphNew<sensesp::SKMetadata>("ms", "Maximum latency to NMEA 2000")));
+  probe->mean_latency_.connect_to(GraphNew<sensesp::SKOutputFloat>(
+      path + ".mean", "",
+      GraphNew<sensesp::SKMetadata>("ms", "Mean latency to NMEA 2000")));
+#endif
+
+  return probe;
+}
+
+}  // namespace halmet
@@ -0,0 +1,110 @@
+#ifndef HALMET_SRC_LATENCY_PROBE_H_
+#define HALMET_SRC_LATENCY_PROBE_H_
+
+#include <Arduino.h>
+
+#include "latency_stats.h"
+#include "sensesp/system/observablevalue.h"
+#include "sensesp/system/valueconsumer.h"
+#include "sensesp/system/valueproducer.h"
+#include "sensesp/transforms/transform.h"
+
+namespace halmet {
+
+/**
+ * @brief Marks the values emitted within its lifetime as sampled at
+ * sample_ms.
+ *
+ * Inputs create one around emit(), with the time at which they read the
+ * hardware. The sensor graph passes values on synchronously, so a latency
+ * probe further down sees the physical sample time instead of the time the
+ * value reached it. Values emitted outside any scope, for example by a
+ * library sensor or a transform's own timer, are timed on arrival.
+ */
+class LatencySampleScope {
+ public:
+  explicit LatencySampleScope(uint32_t sample_ms);
+  ~LatencySampleScope();
+
+ protected:
+  bool outer_active_;
+  uint32_t outer_sample_ms_;
+};
+
+/// Sample time of the value being emitted: that of the innermost
+/// LatencySampleScope, or now if there is none.
+uint32_t LatencySampleTime();
+
+/**
+ * @brief Pass-through that times the values as sampled when they pass.
+ *
+ * Place it directly after an input whose read cannot be scoped, such as a
+ * library sensor. For a counter that is read every window_ms, the sample
+ * time is the start of the counting window.
+ */
+template <typename T>
+class LatencyStamp : public sensesp::SymmetricTransform<T> {
+ public:
+  explicit LatencyStamp(uint32_t window_ms = 0)
+      : sensesp::SymmetricTransform<T>(""), window_ms_{window_ms} {}
+
+  void set(const T& input) override {
+    LatencySampleScope scope(millis() - window_ms_);
+    this->emit(input);
+  }
+
+ protected:
+  uint32_t window_ms_;
+};
+
+/**
+ * @brief Measures the delay from a sensor sample to its NMEA 2000 PGN.
+ *
+ * Connect the probe to a sensor output. When the value changes by more
+ * than the relative threshold, the sample time is recorded (see
+ * LatencySampleScope). The next time a message with the probe's PGN is
+ * sent, the delay since the sample is added to the statistics.
+ *
+ * Messages may be sent from the CAN task in dual-core mode, so the
+ * statistics are guarded by a spinlock. The maximum and mean delay are
+ * published and logged every report_interval ms, and reset after each
+ * report.
+ */
+class LatencyProbe : public sensesp::ValueConsumer<float> {
+ public:
+  LatencyProbe(const char* name, uint32_t pgn, float threshold = 0.05,
+               unsigned int report_interval = 60000);
+
+  void set(const float& value) override;
+
+  /// Called for every transmitted message.
+  void on_send(uint32_t pgn);
+
+  sensesp::ObservableValue<float> max_latency_;   // ms
+  sensesp::ObservableValue<float> mean_latency_;  // ms
+
+ protected:
+  void report();
+
+  const char* name_;
+  uint32_t pgn_;
+  LatencyStats stats_;
+  portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+};
+
+/// Pass a transmitted PGN to all latency probes.
+void NotifyLatencyProbes(uint32_t pgn);
+
+/**
+ * @brief Attach a latency probe to a sensor output.
+ *
+ * The statistics are published as sensors.halmet.latency.<name>.max and
+ * .mean if Signal K output is enabled. Returns nullptr without creating a
+ * probe if producer is nullptr.
+ */
+LatencyProbe* ConnectLatencyProbe(sensesp::FloatProducer* producer,
+                                  const char* name, uint32_t pgn);
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_LATENCY_PROBE_H_
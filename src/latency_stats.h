@@ -0,0 +1,81 @@
+#ifndef HALMET_SRC_LATENCY_STATS_H_
+#define HALMET_SRC_LATENCY_STATS_H_
+
+#include <math.h>
+#include <stdint.h>
+
+namespace halmet {
+
+/**
+ * @brief Delay statistics from a sampled value change to its transmission.
+ *
+ * sample() records the sample time of a value that differs from the last
+ * recorded one by more than the relative threshold. The next sent() adds
+ * the delay since that sample time. Changes arriving while one is pending
+ * are ignored, so each measurement covers a full sender period.
+ *
+ * Times are passed in, so the class does not depend on the Arduino core.
+ */
+class LatencyStats {
+ public:
+  explicit LatencyStats(float threshold = 0.05) : threshold_{threshold} {}
+
+  void sample(float value, uint32_t sample_ms) {
+    if (isnan(value)) {
+      return;
+    }
+    bool changed = isnan(last_value_) ||
+                   fabsf(value - last_value_) > threshold_ * fabsf(last_value_);
+    if (!changed) {
+      return;
+    }
+    last_value_ = value;
+    if (!pending_) {
+      pending_ = true;
+      changed_ms_ = sample_ms;
+    }
+  }
+
+  /// Call when the message carrying the value has been sent at now_ms.
+  void sent(uint32_t now_ms) {
+    if (!pending_) {
+      return;
+    }
+    pending_ = false;
+    uint32_t latency = now_ms - changed_ms_;
+    count_++;
+    sum_ms_ += latency;
+    if (latency > max_ms_) {
+      max_ms_ = latency;
+    }
+  }
+
+  bool pending() const { return pending_; }
+  uint32_t count() const { return count_; }
+  uint32_t max_ms() const { return max_ms_; }
+  float mean_ms() const {
+    return count_ == 0 ? NAN : static_cast<float>(sum_ms_) / count_;
+  }
+
+  /// Clear the statistics, but not a pending change.
+  void reset() {
+    count_ = 0;
+    sum_ms_ = 0;
+    max_ms_ = 0;
+  }
+
+ protected:
+  float threshold_;
+
+  float last_value_ = NAN;
+  bool pending_ = false;
+  uint32_t changed_ms_ = 0;
+
+  uint32_t count_ = 0;
+  uint32_t sum_ms_ = 0;
+  uint32_t max_ms_ = 0;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_LATENCY_STATS_H_
@@ -16,7 +16,18 @@
 #include <NMEA2000_esp32.h>
 #endif
 
+#include "allocation_counter.h"
+#include "binary_telemetry.h"
+#include "data_logger.h"
+#include "fuel_rate_estimator.h"
+#include "graph_arena.h"
+#include "hot_path_benchmark.h"
+#include "i2c_bus.h"
+#include "latency_probe.h"
+#include "n2k_listener.h"
 #include "n2k_senders.h"
+#include "n2k_task.h"
+#include "power_manager.h"
 #include "sensesp/net/discovery.h"
 #include "sensesp/sensors/analog_input.h"
 #include "sensesp/sensors/digital_input.h"
@@ -27,6 +38,11 @@
 #include "sensesp/transforms/lambda_transform.h"
 #include "sensesp/transforms/linear.h"
 #include "sensesp/ui/config_item.h"
+#include "sk_demand.h"
+#include "system_diagnostics.h"
+#include "tacho_self_test.h"
+#include "throttle.h"
+#include "trend_alarm.h"
 
 #ifdef ENABLE_SIGNALK
 #include "sensesp_app_builder.h"
@@ -35,10 +51,12 @@
 #include "sensesp_minimal_app_builder.h"
 #endif
 
+#include "channel_manifest.h"
 #include "halmet_analog.h"
 #include "halmet_const.h"
 #include "halmet_digital.h"
 #include "halmet_display.h"
+#include "halmet_nmea2000.h"
 #include "halmet_serial.h"
 #include "sensesp/net/http_server.h"
 #include "sensesp/net/networking.h"
@@ -70,7 +88,13 @@ uint read_delay = 500;
 // Declare some global variables required for the firmware operation.
 
 #ifdef ENABLE_NMEA2000_OUTPUT
-tNMEA2000* nmea2000;
+HalmetNMEA2000* nmea2000;
+// Receive buffer size. At full bus load, about 50 ms of traffic. The
+// rxOverflows output shows whether this is enough on a given network.
+const uint16_t kN2kReceiveBufferFrames = 96;
+#ifdef ENABLE_N2K_LISTENER
+N2kListener* n2k_listener;
+#endif
 elapsedMillis n2k_time_since_rx = 0;
 elapsedMillis n2k_time_since_tx = 0;
 #endif
@@ -78,6 +102,10 @@ elapsedMillis n2k_time_since_tx = 0;
 TwoWire* i2c;
 Adafruit_SSD1306* display;
 
+#ifdef ENABLE_POWER_MANAGEMENT
+PowerManager* power_manager;
+#endif
+
 // Store alarm states in an array for local display output
 bool alarm_states[4] = {false, false, false, false};
 
@@ -94,6 +122,33 @@ bool alarm_states[4] = {false, false, false, false};
 
 const adsGain_t kADS1115Gain = GAIN_ONE;
 
+/////////////////////////////////////////////////////////////////////
+// Channel topology. The config paths, titles and Signal K metadata of each
+// channel are generated at compile time from these declarations.
+// EDIT: To enable more tanks, add more HALMET_TANK_CHANNEL entries here
+// and connect them in setup().
+
+constexpr TankChannel kFuelTank =
+    HALMET_TANK_CHANNEL(0, "Fuel", "fuel.main", 3000);  // A1 channel is 0
+// constexpr TankChannel kTankA2 = HALMET_TANK_CHANNEL(1, "A2", "A2", 3020);
+// constexpr TankChannel kTankA3 = HALMET_TANK_CHANNEL(2, "A3", "A3", 3040);
+// constexpr TankChannel kTankA4 = HALMET_TANK_CHANNEL(3, "A4", "A4", 3060);
+
+constexpr TemperatureChannel kCoolantTemperature = HALMET_TEMPERATURE_CHANNEL(
+    2, "Coolant", "propulsion.main.coolantTemperature", 3000);  // A3 channel is 2
+
+constexpr OilPressureChannel kOilPressure =
+    HALMET_OIL_PRESSURE_CHANNEL(3, "Oil", "main", 3000);  // A4 channel is 3
+
+constexpr TachoChannel kMainTacho =
+    HALMET_TACHO_CHANNEL(kDigitalInputPin1, "main");
+
+#ifdef ENABLE_CHANNEL_MANIFEST
+// SPIFFS path of the optional channel manifest. If the file exists, it
+// replaces the channel layout above. See channel_manifest.h for the format.
+const char kChannelManifestPath[] = "/channels.json";
+#endif
+
 /////////////////////////////////////////////////////////////////////
 // Test output pin configuration. If ENABLE_TEST_OUTPUT_PIN is defined,
 // GPIO 33 will output a pulse wave at 380 Hz with a 50% duty cycle.
@@ -102,6 +157,7 @@ const adsGain_t kADS1115Gain = GAIN_ONE;
 #define ENABLE_TEST_OUTPUT_PIN
 #ifdef ENABLE_TEST_OUTPUT_PIN
 const int kTestOutputPin = GPIO_NUM_33;
+const int kTestOutputChannel = 0;  // LEDC channel
 // With the default pulse rate of 100 pulses per revolution (configured in
 // halmet_digital.cpp), this frequency corresponds to 3.8 r/s or about 228 rpm.
 
@@ -117,145 +173,104 @@ const int kTestOutputFrequency = 217;
 #endif
 
 
+#ifdef ENABLE_NMEA2000_OUTPUT
 /////////////////////////////////////////////////////////////////////
-// The setup function performs one-time application initialization.
-void setup() {
-  SetupLogging(ESP_LOG_DEBUG);
-
-  // These calls can be used for fine-grained control over the logging level.
-  // esp_log_level_set("*", esp_log_level_t::ESP_LOG_DEBUG);
-
-  Serial.begin(115200);
-
-  /////////////////////////////////////////////////////////////////////
-  // Initialize the application framework
-
-  // Construct the global SensESPApp() object
-  BUILDER_CLASS builder;
-  sensesp_app = (&builder)
-                    // EDIT: Set a custom hostname for the app.
-                    ->set_hostname("halmet")
-                    // EDIT: Optionally, hard-code the WiFi and Signal K server
-                    // settings. This is normally not needed.
-                    //->set_wifi_client("***", "***")
-                    //->set_sk_server("192.168.1.251", 3000)
-                    // EDIT: Enable OTA updates with a password.
-                    ->enable_ota("otakees")
-                    ->get_app();
-
-
-  // initialize the I2C bus
-  i2c = new TwoWire(0);
-  i2c->begin(kSDAPin, kSCLPin);
-
-  // Initialize ADS1115
-  auto ads1115 = new Adafruit_ADS1115();
-
-  ads1115->setGain(kADS1115Gain);
-  bool ads_initialized = ads1115->begin(kADS1115Address, i2c);
-  debugD("ADS1115 initialized: %d", ads_initialized);
+// Size the send buffer for the senders created in setup(), open the bus and
+// start parsing incoming messages. Called at the end of setup().
+static void OpenNMEA2000() {
+  nmea2000->size_tx_buffer(N2kTransmitBudget());
+  nmea2000->Open();
 
-#ifdef ENABLE_TEST_OUTPUT_PIN
-  pinMode(kTestOutputPin, OUTPUT);
-  // Set the LEDC peripheral to a 13-bit resolution
-  ledcSetup(0, kTestOutputFrequency, 13);
-  // Attach the channel to the GPIO pin to be controlled
-  ledcAttachPin(kTestOutputPin, 0);
-  // Set the duty cycle to 50%
-  // Duty cycle value is calculated based on the resolution
-  // For 13-bit resolution, max value is 8191, so 50% is 4096
-  ledcWrite(0, 4096);
+#ifdef ENABLE_N2K_RX_INTERRUPT
+  const bool n2k_rx_interrupt = true;
+#else
+  const bool n2k_rx_interrupt = false;
 #endif
 
-#ifndef ENABLE_SIGNALK
-  // Initialize components that would normally be present in SensESPApp
-  networking = new Networking("/System/WiFi Settings", "", "");
-  ConfigItem(networking);
-  mdns_discovery = new MDNSDiscovery();
-  http_server = new HTTPServer();
-  system_status_led = new SystemStatusLed(LED_BUILTIN);
+#ifdef ENABLE_DUAL_CORE
+  // Parse and transmit on a dedicated task on core 0 so that WiFi and web UI
+  // activity in the main loop cannot delay the bus.
+  StartN2kTask(nmea2000, n2k_rx_interrupt);
+#else
+#ifdef ENABLE_POWER_MANAGEMENT
+  // Wake the idling loop as soon as frames arrive
+  TaskHandle_t n2k_rx_notify_task = power_manager->task();
+#else
+  TaskHandle_t n2k_rx_notify_task = nullptr;
+#endif
+  if (n2k_rx_interrupt && nmea2000->enable_rx_interrupt(n2k_rx_notify_task)) {
+    // Parse only after frames have been received. The slow repeat keeps
+    // the library's address claim and heartbeat timing running.
+    event_loop()->onTick([]() { nmea2000->parse_if_pending(); });
+    event_loop()->onRepeat(10, []() { nmea2000->parse_batch(); });
+  } else {
+    // No need to parse the messages at every single loop iteration; 1 ms
+    // will do
+    event_loop()->onRepeat(1, []() { nmea2000->parse_batch(); });
+  }
 #endif
 
+#ifdef ENABLE_SIGNALK
+  nmea2000->rx_frame_rate_.connect_to(GraphNew<SKOutputFloat>(
+      "sensors.halmet.n2k.rxFrameRate", "",
+      GraphNew<SKMetadata>("Hz", "NMEA 2000 received frame rate")));
+  nmea2000->rx_batch_high_water_.connect_to(GraphNew<SKOutputInt>(
+      "sensors.halmet.n2k.rxBatchHighWater", "",
+      GraphNew<SKMetadata>("", "NMEA 2000 largest receive batch")));
+  nmea2000->rx_overflows_.connect_to(GraphNew<SKOutputInt>(
+      "sensors.halmet.n2k.rxOverflows", "",
+      GraphNew<SKMetadata>("", "NMEA 2000 receive queue overflows")));
+  nmea2000->tx_burst_high_water_.connect_to(GraphNew<SKOutputInt>(
+      "sensors.halmet.n2k.txBurstHighWater", "",
+      GraphNew<SKMetadata>("", "NMEA 2000 largest transmit burst")));
+#endif
+}
+#endif
 
-  // Initialize the OLED display
-  bool display_present = InitializeSSD1306(sensesp_app.get(), &display, i2c);
+#if defined(ENABLE_DATA_LOGGER) || defined(ENABLE_BINARY_TELEMETRY)
+/////////////////////////////////////////////////////////////////////
+// Connect an optional channel to a feature input.
+static void ConnectIfPresent(FloatProducer* channel,
+                             ValueConsumer<float>* consumer) {
+  if (channel != nullptr) {
+    channel->connect_to(consumer);
+  }
+}
+#endif
 
+/////////////////////////////////////////////////////////////////////
+// The compiled-in channel layout, used when there is no channel manifest.
+// Stores the channels that the optional features use in channel_graph.
+static void ConnectDefaultChannels(Adafruit_ADS1115* ads1115,
+                                   bool display_present,
+                                   bool enable_signalk_output,
+                                   ChannelGraph* channel_graph) {
   ///////////////////////////////////////////////////////////////////
   // Analog inputs
 
-#ifdef ENABLE_SIGNALK
-  bool enable_signalk_output = true;
-#else
-  bool enable_signalk_output = false;
-#endif
-
   // Connect the tank senders.
   // EDIT: To enable more tanks, uncomment the lines below.
-  auto tank_a1_volume = ConnectTankSender(ads1115, 0, "Fuel", "fuel.main", 3000,
-                                          enable_signalk_output); // A1 channel is 0
-  // auto tank_a2_volume = ConnectTankSender(ads1115, 1, "A2");
-  // auto tank_a3_volume = ConnectTankSender(ads1115, 2, "A3");
-  // auto tank_a4_volume = ConnectTankSender(ads1115, 3, "A4");
+  auto tank_a1_volume =
+      ConnectTankSender(ads1115, kFuelTank, enable_signalk_output);
+  // auto tank_a2_volume = ConnectTankSender(ads1115, kTankA2);
+  // auto tank_a3_volume = ConnectTankSender(ads1115, kTankA3);
+  // auto tank_a4_volume = ConnectTankSender(ads1115, kTankA4);
 
   // Connect the temperature senders.
-  auto temperature_a3_kelvin = ConnectTemperatureSensor(ads1115, 2, "Coolant", "propulsion.main.coolantTemperature", 3000, // Geen idee of dit klopt, hier mimic een soort tank setup maar het is temperature.
-    enable_signalk_output); // A3 channel is 2
+  auto temperature_a3_kelvin = ConnectTemperatureSensor(
+      ads1115, kCoolantTemperature, enable_signalk_output);
 
   // Connect the oil pressure senders
-  auto oilpressure_a4_bar = ConnectOilPressureSensor(ads1115, 3, "Oil", "main", 3000, // Geen idee of dit klopt, hier mimic een soort tank setup maar het is oil pressure.
-    enable_signalk_output); // A4 channel is 3
+  auto oilpressure_a4_bar =
+      ConnectOilPressureSensor(ads1115, kOilPressure, enable_signalk_output);
 
 #ifdef ENABLE_NMEA2000_OUTPUT
 
-  /////////////////////////////////////////////////////////////////////
-  // Initialize NMEA 2000 functionality
-
-  nmea2000 = new tNMEA2000_esp32(kCANTxPin, kCANRxPin);
-
-  // Reserve enough buffer for sending all messages.
-  nmea2000->SetN2kCANSendFrameBufSize(250);
-  nmea2000->SetN2kCANReceiveFrameBufSize(250);
-
-  // Set Product information
-  // EDIT: Change the values below to match your device.
-  nmea2000->SetProductInformation(
-      "20231229",  // Manufacturer's Model serial code (max 32 chars)
-      104,         // Manufacturer's product code
-      "HALMET",    // Manufacturer's Model ID (max 33 chars)
-      "1.0.0",     // Manufacturer's Software version code (max 40 chars)
-      "1.0.0"      // Manufacturer's Model version (max 24 chars)
-  );
-
-  // For device class/function information, see:
-  // http://www.nmea.org/Assets/20120726%20nmea%202000%20class%20&%20function%20codes%20v%202.00.pdf
-
-  // For mfg registration list, see:
-  // https://actisense.com/nmea-certified-product-providers/
-  // The format is inconvenient, but the manufacturer code below should be
-  // one not already on the list.
-
-  // EDIT: Change the class and function values below to match your device.
-  nmea2000->SetDeviceInformation(
-      GetBoardSerialNumber(),  // Unique number. Use e.g. Serial number.
-      140,                     // Device function: Engine
-      50,                      // Device class: Propulsion
-      2046);                   // Manufacturer code
-
-  nmea2000->SetMode(tNMEA2000::N2km_NodeOnly,
-                    71  // Default N2k node address
-  );
-  nmea2000->EnableForward(false);
-  nmea2000->Open();
-
-  // No need to parse the messages at every single loop iteration; 1 ms will do
-  event_loop()->onRepeat(1, []() { nmea2000->ParseMessages(); });
-
-
   // Tank 1, instance 0. Capacity 200 liters. You can change the capacity
   // in the web UI as well.
   // EDIT: Make sure this matches your tank configuration above.
   // Standaard Tank van Sun Odyssey 32 is 70L
-  N2kFluidLevelSender* tank_a1_sender = new N2kFluidLevelSender(
+  N2kFluidLevelSender* tank_a1_sender = GraphNew<N2kFluidLevelSender>(
       "/Tanks/Fuel/NMEA 2000", 0, N2kft_Fuel, 70, nmea2000);
 
   ConfigItem(tank_a1_sender)
@@ -268,14 +283,14 @@ void setup() {
 #endif  // ENABLE_NMEA2000_OUTPUT
 
   // Read the voltage level of analog input A2
-  auto a2_voltage = new ADS1115VoltageInput(ads1115, 1, "/Voltage A2");
+  auto a2_voltage = GraphNew<ADS1115VoltageInput>(ads1115, 1, "/Voltage A2");
 
   ConfigItem(a2_voltage)
       ->set_title("Analog Voltage A2")
       ->set_description("Voltage level of analog input A2")
       ->set_sort_order(3000);
 
-  a2_voltage->connect_to(new LambdaConsumer<float>(
+  a2_voltage->connect_to(GraphNew<LambdaConsumer<float>>(
       [](float value) { debugD("Voltage A2: %f", value); }));
 
   // If you want to output something else than the voltage value,
@@ -286,9 +301,9 @@ void setup() {
   // a2_voltage->connect_to(a2_distance);
 
 #ifdef ENABLE_SIGNALK
-  a2_voltage->connect_to(
-      new SKOutputFloat("propulsion.main.alternatorVoltage", "Analog Voltage A2", // origineel was "sensors.a2.voltage", "Analog Voltage A2"
-                        new SKMetadata("V","Analog Voltage A2")));
+  a2_voltage->connect_to(GraphNew<SKDemandGate<float>>())->connect_to(
+      GraphNew<SKOutputFloat>("propulsion.main.alternatorVoltage", "Analog Voltage A2", // origineel was "sensors.a2.voltage", "Analog Voltage A2"
+                        GraphNew<SKMetadata>("V","Analog Voltage A2")));
   // Example of how to output the distance value to Signal K.
   // a2_distance->connect_to(
   //     new SKOutputFloat("sensors.a2.distance", "Analog Distance A2",
@@ -303,23 +318,27 @@ void setup() {
   // Make sure to not define a pin for both a tacho and an alarm.
   auto alarm_d2_input = ConnectAlarmSender(kDigitalInputPin2, "D2"); // low oil pressure alarm
   auto alarm_d3_input = ConnectAlarmSender(kDigitalInputPin3, "D3"); // engine high temp alarm
+#ifndef ENABLE_FUEL_FLOW_METER
   auto alarm_d4_input = ConnectAlarmSender(kDigitalInputPin4, "D4"); // bilge alarm
+#endif
 
   // Update the alarm states based on the input value changes.
   // EDIT: If you added more alarm inputs, uncomment the respective lines below.
   alarm_d2_input->connect_to(
-      new LambdaConsumer<bool>([](bool value) { alarm_states[1] = value; }));
+      GraphNew<LambdaConsumer<bool>>([](bool value) { alarm_states[1] = value; }));
   // In this example, alarm_d3_input is active low, so invert the value.
   auto alarm_d3_inverted = alarm_d3_input->connect_to(
-      new LambdaTransform<bool, bool>([](bool value) { return !value; }));
+      GraphNew<LambdaTransform<bool, bool>>([](bool value) { return !value; }));
   alarm_d3_inverted->connect_to(
-      new LambdaConsumer<bool>([](bool value) { alarm_states[2] = value; }));
+      GraphNew<LambdaConsumer<bool>>([](bool value) { alarm_states[2] = value; }));
+#ifndef ENABLE_FUEL_FLOW_METER
   alarm_d4_input->connect_to(
-      new LambdaConsumer<bool>([](bool value) { alarm_states[3] = value; }));
+      GraphNew<LambdaConsumer<bool>>([](bool value) { alarm_states[3] = value; }));
+#endif
 
   // Connect the tacho senders. Engine name is "main".
   // EDIT: More tacho inputs can be defined by duplicating the line below.
-  auto tacho_d1_frequency = ConnectTachoSender(kDigitalInputPin1, "main");
+  auto tacho_d1_frequency = ConnectTachoSender(kMainTacho);
 
 
   // Connect outputs to the N2k senders.
@@ -327,7 +346,7 @@ void setup() {
   // EDIT: This example connects the D2 alarm input to the low oil pressure
   // warning. Modify according to your needs.
   N2kEngineParameterDynamicSender* engine_dynamic_sender =
-      new N2kEngineParameterDynamicSender("/NMEA 2000/Engine 1 Dynamic", 0,
+      GraphNew<N2kEngineParameterDynamicSender>("/NMEA 2000/Engine 1 Dynamic", 0,
                                           nmea2000);
 
   ConfigItem(engine_dynamic_sender)
@@ -346,14 +365,14 @@ void setup() {
   temperature_a3_kelvin->connect_to(engine_dynamic_sender->temperature_);
 
   //Oil pressure conversion from bar to kPa then send to nmea
-  auto oilpressure_a4_kpa = new Linear(100.0,0.0);  // bar → kPa
+  auto oilpressure_a4_kpa = GraphNew<Linear>(100.0,0.0);  // bar → kPa
     oilpressure_a4_bar->connect_to(oilpressure_a4_kpa)->connect_to(engine_dynamic_sender->oil_pressure_);
 
   // EDIT: Make sure this matches your tacho configuration above.
   //       Duplicate the lines below to connect more tachos, but be sure to
   //       use different engine instances
   N2kEngineParameterRapidSender* engine_rapid_sender =
-      new N2kEngineParameterRapidSender("/NMEA 2000/Engine 1 Rapid Update", 0,
+      GraphNew<N2kEngineParameterRapidSender>("/NMEA 2000/Engine 1 Rapid Update", 0,
                                         nmea2000);  // Engine 1, instance 0
 
   ConfigItem(engine_rapid_sender)
@@ -364,15 +383,17 @@ void setup() {
   tacho_d1_frequency->connect_to(&(engine_rapid_sender->engine_speed_));
 
 
+#ifndef ENABLE_FUEL_FLOW_METER
  // Initialize the N2kBilgeAlarmSender with appropriate values
   String bilge_config_path = "/bilge_alarm";  // Or use the path where the config is stored
   uint8_t bilge_instance = 1;  // Set a unique instance ID
   bool initial_alarm_state = alarm_d4_input->get();  // Start with the initial state
 
   // Create N2kBilgeAlarmSender instance
-  N2kBilgeAlarmSender* bilge_alarm_sender = new N2kBilgeAlarmSender(bilge_config_path, bilge_instance, initial_alarm_state, nmea2000);
+  N2kBilgeAlarmSender* bilge_alarm_sender = GraphNew<N2kBilgeAlarmSender>(bilge_config_path, bilge_instance, initial_alarm_state, nmea2000);
 
   alarm_d4_input->connect_to(bilge_alarm_sender->alarm_state_);
+#endif
 
 
 #endif 
@@ -381,17 +402,17 @@ void setup() {
 
 //////////// ONE WIRE
   #ifdef ENABLE_ONE_WIRE
-    DallasTemperatureSensors* dts = new DallasTemperatureSensors(OneWirePin);
+    DallasTemperatureSensors* dts = GraphNew<DallasTemperatureSensors>(OneWirePin);
 
     // Measure temperature 1
-    auto probe_1_temp = new OneWireTemperature(dts, read_delay, "/exhaustTemperature/oneWire");
+    auto probe_1_temp = GraphNew<OneWireTemperature>(dts, read_delay, "/exhaustTemperature/oneWire");
 
     ConfigItem(probe_1_temp)
       ->set_title("1Wire Temp 1")
       ->set_description("Temp from 1 Wire sensor #1")
       ->set_sort_order(3100);
 
-    probe_1_temp->connect_to(new LambdaConsumer<float>(
+    probe_1_temp->connect_to(GraphNew<LambdaConsumer<float>>(
         [](float value) { debugD("Temp T1: %f", value); }));
 
     // SEND NMEA One wire
@@ -403,7 +424,7 @@ void setup() {
     uint8_t exhaust_instance = 1;                  // Unique instance ID for the exhaust probe
 
     // Create the N2kExhaustTemperatureSender instance
-    N2kExhaustTemperatureSender* exhaust_temp_sender = new N2kExhaustTemperatureSender(exhaust_config_path, exhaust_instance, 0.0, nmea2000);
+    N2kExhaustTemperatureSender* exhaust_temp_sender = GraphNew<N2kExhaustTemperatureSender>(exhaust_config_path, exhaust_instance, 0.0, nmea2000);
 
     // Connect the temperature data producer to the N2kExhaustTemperatureSender
     probe_1_temp->connect_to(exhaust_temp_sender->temperature_);
@@ -411,8 +432,8 @@ void setup() {
     #endif
 
     #ifdef ENABLE_SIGNALK
-      probe_1_temp->connect_to(
-          new SKOutputFloat("propulsion.main.exhaustTemperature", "1",new SKMetadata("K","1Wire Temp Value T1"))
+      probe_1_temp->connect_to(GraphNew<SKDemandGate<float>>())->connect_to(
+          GraphNew<SKOutputFloat>("propulsion.main.exhaustTemperature", "1",GraphNew<SKMetadata>("K","1Wire Temp Value T1"))
         );
     #endif
   #endif
@@ -422,14 +443,10 @@ void setup() {
  // Create a frequency transform
 
   // create a propulsion state lambda transform
-  auto* propulsion_state = new LambdaTransform<float, String>(
-    [](bool freq) {
-      if (freq > 0) {
-        return "started";
-      } else {
-        return "stopped";
-      }
-    },
+  // Both states fit in String's inline buffer, so emitting them for every
+  // tacho sample does not allocate. Keep them short.
+  auto* propulsion_state = GraphNew<LambdaTransform<float, String>>(
+    [](float freq) -> String { return freq > 0 ? "started" : "stopped"; },
     "/Transforms/Propulsion State");
 
 ConfigItem(propulsion_state)
@@ -437,29 +454,43 @@ ConfigItem(propulsion_state)
     ->set_description("Propulsion State Description")
     ->set_sort_order(1200);
 
-tacho_d1_frequency->connect_to(propulsion_state);
+// The state only feeds Signal K
+tacho_d1_frequency->connect_to(GraphNew<SKDemandGate<float>>())
+    ->connect_to(propulsion_state);
 
 // create engine hours counter using PersistentDuration
-auto* engine_hours = new TimeCounter<float>("/Transforms/Engine Hours");
+auto* engine_hours = GraphNew<TimeCounter<float>>("/Transforms/Engine Hours");
 
 ConfigItem(engine_hours)
     ->set_title("Engine Hours")
     ->set_description("Engine Hours Description")
     ->set_sort_order(1300);
 
+#ifdef ENABLE_TACHO_SELF_TEST
+// The self-test signal on the tacho input is not engine running time
+tacho_d1_frequency
+    ->connect_to(GraphNew<LambdaTransform<float, float>>(
+        [](float hz) { return TachoSelfTestRunning() ? 0 : hz; }))
+    ->connect_to(engine_hours);
+#else
 tacho_d1_frequency->connect_to(engine_hours);
+#endif
+
+#ifdef ENABLE_POWER_MANAGEMENT
+tacho_d1_frequency->connect_to(&(power_manager->engine_frequency_));
+#endif
 
 
 // Note; voor NMEA moet ik het nog fixen dat hij alleen maar uren stuurt. Dus dan engine_hours_offset delen door 3600.
 
 #ifdef ENABLE_SIGNALK
 // create and connect the propulsion state output object
-propulsion_state->connect_to(new SKOutput<String>(
-    "propulsion.main.state", "", new SKMetadata("", "Main Engine State")));
+propulsion_state->connect_to(GraphNew<SKOutput<String>>(
+    "propulsion.main.state", "", GraphNew<SKMetadata>("", "Main Engine State")));
 
 // Connect engine_hours to the offset transform
-engine_hours->connect_to(new SKOutput<float>("propulsion.main.runTime", "",
-                                  new SKMetadata("s", "Main Engine running time")));
+engine_hours->connect_to(GraphNew<SKOutput<float>>("propulsion.main.runTime", "",
+                                  GraphNew<SKMetadata>("s", "Main Engine running time")));
 #endif
 
 
@@ -468,32 +499,30 @@ engine_hours->connect_to(new SKOutput<float>("propulsion.main.runTime", "",
 // send through NMEA2000 the total engine hours
 
 auto engine_hours_in_hours = engine_hours->connect_to(
-    new LambdaTransform<float, float>([](float seconds) { return seconds / 3600.0f; }));
+    GraphNew<LambdaTransform<float, float>>([](float seconds) { return seconds / 3600.0f; }));
 
   engine_hours_in_hours
       ->connect_to(engine_dynamic_sender->total_engine_hours_);  // Send converted value to NMEA
 
 #endif
 
+
   ///////////////////////////////////////////////////////////////////
   // Display setup
 
-  // Connect the outputs to the display
+  // Connect the outputs to the display. Each row is redrawn at most once
+  // per kDisplayUpdateInterval, always ending with the latest value.
   if (display_present) {
-#ifdef ENABLE_SIGNALK
-    event_loop()->onRepeat(1000, []() {
-     PrintValue(display, 1, "IP:", WiFi.localIP().toString());
-    });
-#endif
-
 // Display tank level
 // EDIT: Duplicate the lines below to make the display show all your tanks.
 
-    tank_a1_volume->connect_to(new LambdaConsumer<float>(
+    tank_a1_volume->connect_to(GraphNew<Throttle<float>>(kDisplayUpdateInterval))
+      ->connect_to(GraphNew<LambdaConsumer<float>>(
         [](float value) { PrintValue(display, 2, "Diesel Tank A1", 100 * value); }));
 
 // Display RPM
-    tacho_d1_frequency->connect_to(new LambdaConsumer<float>(
+    tacho_d1_frequency->connect_to(GraphNew<Throttle<float>>(kDisplayUpdateInterval))
+      ->connect_to(GraphNew<LambdaConsumer<float>>(
         [](float value) { PrintValue(display, 3, "RPM D1", 60 * value); }));
         // note the '60' here is because it's measured in Hz and converting Hz to RPM is 60
 
@@ -509,23 +538,523 @@ auto engine_hours_in_hours = engine_hours->connect_to(
 */
 
 // Display voltage A2
-    a2_voltage->connect_to(new LambdaConsumer<float>(
+    a2_voltage->connect_to(GraphNew<Throttle<float>>(kDisplayUpdateInterval))
+      ->connect_to(GraphNew<LambdaConsumer<float>>(
       [](float value) { PrintValue(display, 4, "A2 Voltage", value); }));
 
 // Display Temp A3 - resistive sensor coolant
-temperature_a3_kelvin->connect_to(new LambdaConsumer<float>(
+temperature_a3_kelvin->connect_to(GraphNew<Throttle<float>>(kDisplayUpdateInterval))
+      ->connect_to(GraphNew<LambdaConsumer<float>>(
   [](float value) { PrintValue(display, 5, "A3 Kelvin", value); }));
 
 // Display Temp T1 - onewire temp exhaust
-    probe_1_temp->connect_to(new LambdaConsumer<float>(
+    probe_1_temp->connect_to(GraphNew<Throttle<float>>(kDisplayUpdateInterval))
+      ->connect_to(GraphNew<LambdaConsumer<float>>(
       [](float value) { PrintValue(display, 6, "T1 Kelvin", value); }));
 
-  }
-
 // Display Engine Hours
-engine_hours_in_hours->connect_to(new LambdaConsumer<float>(
+engine_hours_in_hours->connect_to(GraphNew<Throttle<float>>(kDisplayUpdateInterval))
+      ->connect_to(GraphNew<LambdaConsumer<float>>(
   [](float value) { PrintValue(display, 7, "Engine Hours", value); }));
+  }
+
+  channel_graph->fuel_tank_level = tank_a1_volume;
+  channel_graph->coolant_temperature = temperature_a3_kelvin;
+  channel_graph->oil_pressure = oilpressure_a4_bar;
+  channel_graph->alternator_voltage = a2_voltage;
+  channel_graph->engine_frequency = tacho_d1_frequency;
+#ifdef ENABLE_ONE_WIRE
+  channel_graph->exhaust_temperature = probe_1_temp;
+#endif
+#ifdef ENABLE_NMEA2000_OUTPUT
+  channel_graph->fuel_tank_sender = tank_a1_sender;
+  channel_graph->engine_dynamic_sender = engine_dynamic_sender;
+  channel_graph->engine_rapid_sender = engine_rapid_sender;
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////
+// The setup function performs one-time application initialization.
+void setup() {
+  SetupLogging(ESP_LOG_DEBUG);
 
+  // These calls can be used for fine-grained control over the logging level.
+  // esp_log_level_set("*", esp_log_level_t::ESP_LOG_DEBUG);
+
+  Serial.begin(115200);
+
+  /////////////////////////////////////////////////////////////////////
+  // Initialize the application framework
+
+  // Construct the global SensESPApp() object
+  BUILDER_CLASS builder;
+  sensesp_app = (&builder)
+                    // EDIT: Set a custom hostname for the app.
+                    ->set_hostname("halmet")
+                    // EDIT: Optionally, hard-code the WiFi and Signal K server
+                    // settings. This is normally not needed.
+                    //->set_wifi_client("***", "***")
+                    //->set_sk_server("192.168.1.251", 3000)
+                    // EDIT: Enable OTA updates with a password.
+                    ->enable_ota("otakees")
+                    ->get_app();
+
+
+  // Time the sensor graph build from here; see ReportGraphArena()
+  StartGraphBuild();
+
+  // initialize the I2C bus
+  i2c = GraphNew<TwoWire>(0);
+  BeginI2CBus(i2c, kSDAPin, kSCLPin);
+
+  // Initialize ADS1115
+  auto ads1115 = GraphNew<Adafruit_ADS1115>();
+
+  // Initial gain only; each analog input selects its own gain per reading
+  ads1115->setGain(kADS1115Gain);
+  bool ads_initialized = ads1115->begin(kADS1115Address, i2c);
+  debugD("ADS1115 initialized: %d", ads_initialized);
+  if (!ads_initialized) {
+    // Retried with back-off by the analog inputs
+    I2CFailure(ADS1115Guard());
+  }
+
+#ifdef ENABLE_TEST_OUTPUT_PIN
+  pinMode(kTestOutputPin, OUTPUT);
+  // Set the LEDC peripheral to a 13-bit resolution
+  ledcSetup(kTestOutputChannel, kTestOutputFrequency, 13);
+  // Attach the channel to the GPIO pin to be controlled
+  ledcAttachPin(kTestOutputPin, kTestOutputChannel);
+  // Set the duty cycle to 50%
+  // Duty cycle value is calculated based on the resolution
+  // For 13-bit resolution, max value is 8191, so 50% is 4096
+  ledcWrite(kTestOutputChannel, 4096);
+#endif
+
+#ifndef ENABLE_SIGNALK
+  // Initialize components that would normally be present in SensESPApp
+  networking = new Networking("/System/WiFi Settings", "", "");
+  ConfigItem(networking);
+  mdns_discovery = new MDNSDiscovery();
+  http_server = new HTTPServer();
+  system_status_led = new SystemStatusLed(LED_BUILTIN);
+#endif
+
+
+  // Initialize the OLED display
+  bool display_present = InitializeSSD1306(sensesp_app.get(), &display, i2c);
+
+#ifdef ENABLE_SIGNALK
+  bool enable_signalk_output = true;
+
+  // Values only flow into the Signal K outputs while the server is
+  // connected; see SKDemandGate.
+  SetSignalKDemand(false);
+  event_loop()->onRepeat(1000, []() {
+    SetSignalKDemand(sensesp_app->get_ws_client()->is_connected());
+  });
+#else
+  bool enable_signalk_output = false;
+#endif
+
+#ifdef ENABLE_NMEA2000_OUTPUT
+
+  /////////////////////////////////////////////////////////////////////
+  // Initialize NMEA 2000 functionality
+
+  nmea2000 = GraphNew<HalmetNMEA2000>(kCANTxPin, kCANRxPin);
+
+  // The send buffer is sized from the senders in OpenNMEA2000().
+  nmea2000->set_rx_buffer_size(kN2kReceiveBufferFrames);
+
+  // Set Product information
+  // EDIT: Change the values below to match your device.
+  nmea2000->SetProductInformation(
+      "20231229",  // Manufacturer's Model serial code (max 32 chars)
+      104,         // Manufacturer's product code
+      "HALMET",    // Manufacturer's Model ID (max 33 chars)
+      "1.0.0",     // Manufacturer's Software version code (max 40 chars)
+      "1.0.0"      // Manufacturer's Model version (max 24 chars)
+  );
+
+  // For device class/function information, see:
+  // http://www.nmea.org/Assets/20120726%20nmea%202000%20class%20&%20function%20codes%20v%202.00.pdf
+
+  // For mfg registration list, see:
+  // https://actisense.com/nmea-certified-product-providers/
+  // The format is inconvenient, but the manufacturer code below should be
+  // one not already on the list.
+
+  // EDIT: Change the class and function values below to match your device.
+  nmea2000->SetDeviceInformation(
+      GetBoardSerialNumber(),  // Unique number. Use e.g. Serial number.
+      140,                     // Device function: Engine
+      50,                      // Device class: Propulsion
+      2046);                   // Manufacturer code
+
+  nmea2000->SetMode(tNMEA2000::N2km_NodeOnly,
+                    71  // Default N2k node address
+  );
+  nmea2000->EnableForward(false);
+  // Open() is called once all senders have been created, see OpenNMEA2000().
+
+#ifdef ENABLE_N2K_LISTENER
+  // Cache selected PGNs from other devices on the bus for local use.
+  // EDIT: Subscribe to the values your transforms need.
+  n2k_listener = GraphNew<N2kListener>(nmea2000);
+
+#ifdef ENABLE_SIGNALK
+  n2k_listener->subscribe(N2kField::kSpeedThroughWater)
+      ->connect_to(GraphNew<SKDemandGate<float>>())
+      ->connect_to(GraphNew<SKOutputFloat>(
+          "sensors.halmet.n2k.speedThroughWater", "",
+          GraphNew<SKMetadata>("m/s", "Speed through water from NMEA 2000")));
+#endif
+#endif
+#endif  // ENABLE_NMEA2000_OUTPUT
+
+  if (display_present) {
+#ifdef ENABLE_SIGNALK
+    event_loop()->onRepeat(1000, []() {
+      // Formatted in place; IPAddress::toString() allocates a String
+      IPAddress ip = WiFi.localIP();
+      char ip_string[16];
+      snprintf(ip_string, sizeof(ip_string), "%u.%u.%u.%u", ip[0], ip[1],
+               ip[2], ip[3]);
+      PrintValue(display, 1, "IP:", ip_string);
+    });
+#endif
+  }
+
+#ifdef ENABLE_POWER_MANAGEMENT
+  // Idle the CPU while the engine is stopped. The engine state is connected
+  // to the tacho below.
+  power_manager = GraphNew<PowerManager>();
+
+#ifdef ENABLE_SIGNALK
+  power_manager->duty_cycle_.connect_to(GraphNew<SKOutputFloat>(
+      "sensors.halmet.loopDutyCycle", "",
+      GraphNew<SKMetadata>("ratio", "Event loop duty cycle")));
+#endif
+#endif
+
+#ifdef ENABLE_SYSTEM_DIAGNOSTICS
+  // Heap, stack and event loop statistics on the status page and in
+  // sensors.halmet.diagnostics
+  ConnectSystemDiagnostics(enable_signalk_output);
+#endif
+
+  /////////////////////////////////////////////////////////////////////
+  // Channel layout. If a channel manifest is present in SPIFFS, the
+  // channels are built from it instead of the compiled-in layout.
+
+  ChannelGraph channel_graph;
+  bool manifest_built = false;
+
+#ifdef ENABLE_CHANNEL_MANIFEST
+  ManifestContext manifest_context;
+  manifest_context.ads1115 = ads1115;
+  manifest_context.display = display_present ? display : nullptr;
+  manifest_context.enable_signalk_output = enable_signalk_output;
+#ifdef ENABLE_NMEA2000_OUTPUT
+  manifest_context.nmea2000 = nmea2000;
+#endif
+#ifdef ENABLE_POWER_MANAGEMENT
+  manifest_context.power_manager = power_manager;
+#endif
+  manifest_built = BuildGraphFromManifest(kChannelManifestPath,
+                                          manifest_context, &channel_graph);
+#endif
+
+  if (!manifest_built) {
+    ConnectDefaultChannels(ads1115, display_present, enable_signalk_output,
+                           &channel_graph);
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Optional features. They connect to the channels in channel_graph,
+  // whether those were built from the manifest or from the compiled-in
+  // layout, and are skipped with a warning if a channel they need is
+  // missing.
+
+#if defined(ENABLE_FUEL_RATE_ESTIMATOR) && defined(ENABLE_NMEA2000_OUTPUT)
+  if (channel_graph.fuel_tank_level != nullptr &&
+      channel_graph.fuel_tank_sender != nullptr &&
+      channel_graph.engine_frequency != nullptr) {
+    // Estimate the fuel rate from the fuel tank level while the engine runs.
+    // The tank capacity is the one configured in the tank's N2k sender.
+    N2kFluidLevelSender* fuel_tank_sender = channel_graph.fuel_tank_sender;
+    auto fuel_rate_estimator = GraphNew<FuelRateEstimator>(
+        "/Tanks/Fuel/Fuel Rate Estimator", [fuel_tank_sender]() {
+          return static_cast<float>(fuel_tank_sender->tank_capacity());
+        });
+
+    ConfigItem(fuel_rate_estimator)
+        ->set_title("Fuel Rate Estimator")
+        ->set_description("Fuel consumption estimated from the tank level")
+        ->set_sort_order(3006);
+
+    channel_graph.fuel_tank_level->connect_to(
+        &(fuel_rate_estimator->tank_level_));
+    channel_graph.engine_frequency->connect_to(
+        &(fuel_rate_estimator->engine_frequency_));
+
+// A fuel flow meter, if present, provides the fuel rate instead
+#ifndef ENABLE_FUEL_FLOW_METER
+    if (channel_graph.engine_dynamic_sender != nullptr) {
+      fuel_rate_estimator->fuel_rate_.connect_to(
+          channel_graph.engine_dynamic_sender->fuel_rate_);
+    }
+#endif
+
+#ifdef ENABLE_SIGNALK
+#ifndef ENABLE_FUEL_FLOW_METER
+    fuel_rate_estimator->fuel_rate_
+        .connect_to(GraphNew<Linear>(1 / 3600000.0, 0.0))  // l/h -> m3/s
+        ->connect_to(GraphNew<SKOutputFloat>(
+            "propulsion.main.fuel.rate", "",
+            GraphNew<SKMetadata>("m3/s", "Main Engine fuel rate")));
+#endif
+    fuel_rate_estimator->hours_remaining_
+        .connect_to(GraphNew<Linear>(3600.0, 0.0))  // h -> s
+        ->connect_to(GraphNew<SKOutputFloat>(
+            "tanks.fuel.main.timeRemaining", "",
+            GraphNew<SKMetadata>("s", "Fuel time remaining at current rate")));
+#endif
+  } else {
+    debugW(
+        "Fuel rate estimator disabled: no fuel tank with an N2k sender or no "
+        "engine 0 tacho");
+  }
+#endif
+
+#ifdef ENABLE_FUEL_FLOW_METER
+  // Fuel flow meter on D4, counted in hardware. The D4 bilge alarm is not
+  // created in this configuration, and a channel manifest cannot use D4.
+  // EDIT: set the meter's pulses per liter in the web UI.
+  auto fuel_flow = ConnectPulseCounter(kDigitalInputPin4, "Fuel Flow");
+
+#ifdef ENABLE_NMEA2000_OUTPUT
+  if (channel_graph.engine_dynamic_sender != nullptr) {
+    fuel_flow->rate_
+        .connect_to(GraphNew<Linear>(3600.0, 0.0))  // l/s -> l/h
+        ->connect_to(channel_graph.engine_dynamic_sender->fuel_rate_);
+  }
+#endif
+
+#ifdef ENABLE_SIGNALK
+  fuel_flow->rate_.connect_to(GraphNew<SKDemandGate<float>>())
+      ->connect_to(GraphNew<Linear>(0.001, 0.0))  // l/s -> m3/s
+      ->connect_to(GraphNew<SKOutputFloat>(
+          "propulsion.main.fuel.rate", "",
+          GraphNew<SKMetadata>("m3/s", "Main Engine fuel rate")));
+  fuel_flow->total_.connect_to(GraphNew<SKDemandGate<float>>())
+      ->connect_to(GraphNew<Linear>(0.001, 0.0))  // l -> m3
+      ->connect_to(GraphNew<SKOutputFloat>(
+          "propulsion.main.fuel.used", "",
+          GraphNew<SKMetadata>("m3", "Main Engine fuel used since boot")));
+#endif
+#endif
+
+#if defined(ENABLE_TREND_ALARMS) && defined(ENABLE_NMEA2000_OUTPUT)
+  if (channel_graph.coolant_temperature != nullptr &&
+      channel_graph.oil_pressure != nullptr &&
+      channel_graph.engine_frequency != nullptr &&
+      channel_graph.engine_dynamic_sender != nullptr) {
+    // Warn before the coolant temperature or oil pressure reaches its
+    // limit, well before the D2/D3 switches trip. EDIT: adjust the limits
+    // to your engine.
+    auto coolant_trend = GraphNew<TrendAlarm>(
+        "/Alarms/Coolant Trend", TrendAlarm::kRising, 368.15, 300);  // 95 C
+
+    ConfigItem(coolant_trend)
+        ->set_title("Coolant Temperature Trend")
+        ->set_description("Warn when the coolant temperature is projected to "
+                          "reach the threshold (K) within the horizon")
+        ->set_sort_order(3011);
+
+    auto oil_trend = GraphNew<TrendAlarm>("/Alarms/Oil Pressure Trend",
+                                          TrendAlarm::kFalling, 0.5, 120, true);
+
+    ConfigItem(oil_trend)
+        ->set_title("Oil Pressure Trend")
+        ->set_description("Warn when the oil pressure is projected to drop to "
+                          "the threshold (bar) within the horizon")
+        ->set_sort_order(3012);
+
+    channel_graph.coolant_temperature->connect_to(&(coolant_trend->input_));
+    channel_graph.oil_pressure->connect_to(&(oil_trend->input_));
+    channel_graph.engine_frequency->connect_to(&(oil_trend->engine_frequency_));
+
+    // Level 1 is the early warning, level 2 a limit that has been reached
+    auto engine_sender = channel_graph.engine_dynamic_sender;
+    auto trend_warning = GraphNew<LambdaConsumer<bool>>(
+        [coolant_trend, oil_trend, engine_sender](bool) {
+          engine_sender->warning_level_1_->set(
+              coolant_trend->warning_.get() || oil_trend->warning_.get());
+        });
+    coolant_trend->warning_.connect_to(trend_warning);
+    oil_trend->warning_.connect_to(trend_warning);
+
+    auto trend_alarm = GraphNew<LambdaConsumer<bool>>(
+        [coolant_trend, oil_trend, engine_sender](bool) {
+          engine_sender->warning_level_2_->set(
+              coolant_trend->alarm_.get() || oil_trend->alarm_.get());
+        });
+    coolant_trend->alarm_.connect_to(trend_alarm);
+    oil_trend->alarm_.connect_to(trend_alarm);
+  } else {
+    debugW("Trend alarms disabled: engine 0 has no coolant temperature, "
+           "oil pressure, tacho or N2k sender");
+  }
+#endif
+
+#if defined(ENABLE_LATENCY_PROBES) && defined(ENABLE_NMEA2000_OUTPUT)
+  // Measure the delay from a sensor value change to the PGN carrying it.
+  // Compare with the worst case printed by tools/manifest_check.py.
+  ConnectLatencyProbe(channel_graph.engine_frequency, "rpm",
+                      N2kEngineParameterRapidSender::kPGN);
+  ConnectLatencyProbe(channel_graph.coolant_temperature, "coolant",
+                      N2kEngineParameterDynamicSender::kPGN);
+  ConnectLatencyProbe(channel_graph.oil_pressure, "oilPressure",
+                      N2kEngineParameterDynamicSender::kPGN);
+  ConnectLatencyProbe(channel_graph.fuel_tank_level, "fuelTank",
+                      N2kFluidLevelSender::kPGN);
+  ConnectLatencyProbe(channel_graph.exhaust_temperature, "exhaust",
+                      N2kExhaustTemperatureSender::kPGN);
+#endif
+
+#ifdef ENABLE_DATA_LOGGER
+  // Keep a circular log of engine data in the "datalog" flash partition
+  // (see partitions_datalog.csv). Download it from /datalog and convert it
+  // with tools/datalog_decode.py. Missing channels are logged as missing.
+  // Resolution: tacho 1/6 Hz (10 rpm), coolant 0.1 K, oil pressure
+  // 0.05 bar, exhaust 0.1 K.
+  const float data_log_scales[DataLogger::kChannels] = {6, 10, 20, 10};
+  auto data_logger = GraphNew<DataLogger>(data_log_scales);
+
+  ConnectIfPresent(channel_graph.engine_frequency, &(data_logger->inputs_[0]));
+  ConnectIfPresent(channel_graph.coolant_temperature,
+                   &(data_logger->inputs_[1]));
+  ConnectIfPresent(channel_graph.oil_pressure, &(data_logger->inputs_[2]));
+  ConnectIfPresent(channel_graph.exhaust_temperature,
+                   &(data_logger->inputs_[3]));
+
+  if (data_logger->begin()) {
+    auto data_log_handler = std::make_shared<HTTPRequestHandler>(
+        1 << HTTP_GET, "/datalog", [data_logger](httpd_req_t* req) {
+          return data_logger->handle_download(req);
+        });
+#ifdef ENABLE_SIGNALK
+    sensesp_app->get_http_server()->add_handler(data_log_handler);
+#else
+    http_server->add_handler(data_log_handler);
+#endif
+  }
+#endif
+
+#ifdef ENABLE_BINARY_TELEMETRY
+  // Send engine data as compact binary UDP frames at 10 Hz. The schema is
+  // served from /telemetry/schema; see tools/telemetry_decode.py.
+  auto telemetry = GraphNew<BinaryTelemetry>("/Telemetry/Binary UDP");
+
+  ConfigItem(telemetry)
+      ->set_title("Binary Telemetry")
+      ->set_description("Binary UDP telemetry stream")
+      ->set_sort_order(1400);
+
+  ConnectIfPresent(
+      channel_graph.engine_frequency,
+      telemetry->add_channel("propulsion.main.revolutions", "Hz", 100));
+  ConnectIfPresent(
+      channel_graph.coolant_temperature,
+      telemetry->add_channel("propulsion.main.coolantTemperature", "K", 50));
+  ConnectIfPresent(
+      channel_graph.oil_pressure,
+      telemetry->add_channel("propulsion.main.oilPressure", "bar", 1000));
+  ConnectIfPresent(
+      channel_graph.fuel_tank_level,
+      telemetry->add_channel("tanks.fuel.main.currentLevel", "ratio", 10000));
+  ConnectIfPresent(
+      channel_graph.alternator_voltage,
+      telemetry->add_channel("propulsion.main.alternatorVoltage", "V", 1000));
+  ConnectIfPresent(
+      channel_graph.exhaust_temperature,
+      telemetry->add_channel("propulsion.main.exhaustTemperature", "K", 20));
+
+  telemetry->begin();
+  auto telemetry_schema_handler = std::make_shared<HTTPRequestHandler>(
+      1 << HTTP_GET, "/telemetry/schema", [telemetry](httpd_req_t* req) {
+        return telemetry->handle_schema(req);
+      });
+#ifdef ENABLE_SIGNALK
+  sensesp_app->get_http_server()->add_handler(telemetry_schema_handler);
+#else
+  http_server->add_handler(telemetry_schema_handler);
+#endif
+
+#ifdef ENABLE_TELEMETRY_BENCHMARK
+  telemetry->benchmark();
+#endif
+#endif
+
+#if defined(ENABLE_TACHO_SELF_TEST) && defined(ENABLE_TEST_OUTPUT_PIN) && \
+    defined(ENABLE_NMEA2000_OUTPUT)
+  if (channel_graph.engine_frequency != nullptr &&
+      channel_graph.engine_rapid_sender != nullptr) {
+    // Sweep the test output over the rpm range and measure the accuracy and
+    // settling time of the tacho as seen by the N2k rapid sender. Wire the
+    // test output pin to the engine 0 tacho input. Start the sweep from
+    // /tacho_test, where the results are shown.
+    auto tacho_self_test = GraphNew<TachoSelfTest>(
+        channel_graph.engine_frequency, channel_graph.engine_rapid_sender,
+        kTestOutputChannel, kTestOutputFrequency);
+
+    auto tacho_test_handler = std::make_shared<HTTPRequestHandler>(
+        1 << HTTP_GET, "/tacho_test", [tacho_self_test](httpd_req_t* req) {
+          return tacho_self_test->handle_results(req);
+        });
+    auto tacho_test_start_handler = std::make_shared<HTTPRequestHandler>(
+        1 << HTTP_POST, "/tacho_test/start",
+        [tacho_self_test](httpd_req_t* req) {
+          return tacho_self_test->handle_start(req);
+        });
+#ifdef ENABLE_SIGNALK
+    sensesp_app->get_http_server()->add_handler(tacho_test_handler);
+    sensesp_app->get_http_server()->add_handler(tacho_test_start_handler);
+#else
+    http_server->add_handler(tacho_test_handler);
+    http_server->add_handler(tacho_test_start_handler);
+#endif
+  } else {
+    debugW("Tacho self-test disabled: no engine 0 tacho or rapid sender");
+  }
+#endif
+
+#if defined(ENABLE_HOT_PATH_BENCHMARK) && defined(ENABLE_NMEA2000_OUTPUT)
+  // Print the cycle counts of the per-sample code paths. Check them against
+  // a baseline with tools/hot_path_check.py.
+  if (channel_graph.engine_dynamic_sender != nullptr) {
+    HotPathBenchmark().run(channel_graph.engine_dynamic_sender,
+                           display_present ? display : nullptr);
+  }
+#endif
+
+#ifdef ENABLE_ALLOCATION_COUNTER
+  // Log the heap allocations made by the event loop after a warm-up, and
+  // flag them on the status page. The per-sample paths should not allocate
+  // at all.
+  ConnectAllocationMonitor();
+#endif
+
+#ifdef ENABLE_NMEA2000_OUTPUT
+  OpenNMEA2000();
+#endif
+
+  ReportGraphArena();
+#ifdef ENABLE_STATIC_ARENA
+  LogGraphNodeBytes();
+#endif
 
   // To avoid garbage collecting all shared pointers created in setup(),
   // loop from here.
@@ -536,4 +1065,10 @@ engine_hours_in_hours->connect_to(new LambdaConsumer<float>(
 
 
 
-void loop() { event_loop()->tick(); }
+void loop() {
+#ifdef ENABLE_POWER_MANAGEMENT
+  power_manager->tick();
+#else
+  event_loop()->tick();
+#endif
+}
@@ -0,0 +1,82 @@
+#include "n2k_listener.h"
+
+#include <Arduino.h>
+
+#include "graph_arena.h"
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+N2kListener::N2kListener(tNMEA2000* nmea2000, unsigned int expiry_ms,
+                         unsigned int poll_interval_ms)
+    : nmea2000_{nmea2000}, expiry_ms_{expiry_ms} {
+  sensesp::event_loop()->onRepeat(poll_interval_ms,
+                                  [this]() { this->poll(); });
+}
+
+N2kSubscription* N2kListener::subscribe(N2kField field, uint8_t instance,
+                                        uint8_t source) {
+  if (num_subscriptions_ >= kMaxSubscriptions ||
+      !listen(N2kPgnCache::pgn(field))) {
+    debugE("N2kListener: Too many subscriptions");
+    return nullptr;
+  }
+  auto subscription = GraphNew<N2kSubscription>(field, instance, source);
+  subscriptions_[num_subscriptions_++] = subscription;
+  return subscription;
+}
+
+bool N2kListener::listen(uint32_t pgn) {
+  if (is_listening(pgn)) {
+    return true;
+  }
+  if (num_pgns_ >= kMaxSubscriptions) {
+    return false;
+  }
+  pgns_[num_pgns_++] = pgn;
+  if (nmea2000_ != nullptr) {
+    // The handler attaches itself to the library's handler list
+    GraphNew<PgnHandler>(pgn, nmea2000_, this);
+  }
+  return true;
+}
+
+bool N2kListener::is_listening(uint32_t pgn) const {
+  for (size_t i = 0; i < num_pgns_; i++) {
+    if (pgns_[i] == pgn) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void N2kListener::handle(const tN2kMsg& msg) {
+  if (is_listening(msg.PGN)) {
+    cache_.decode(msg, millis());
+  }
+}
+
+void N2kListener::poll() {
+  uint32_t now = millis();
+
+  for (size_t s = 0; s < num_subscriptions_; s++) {
+    N2kSubscription* subscription = subscriptions_[s];
+    N2kPgnCache::Reading reading =
+        cache_.read(subscription->field_, subscription->instance_,
+                    subscription->source_, now);
+
+    if (reading.found && reading.age_ms <= expiry_ms_) {
+      if (subscription->expired_ ||
+          reading.sequence != subscription->last_sequence_) {
+        subscription->last_sequence_ = reading.sequence;
+        subscription->expired_ = false;
+        subscription->emit(reading.value);
+      }
+    } else if (!subscription->expired_) {
+      subscription->expired_ = true;
+      subscription->emit(NAN);
+    }
+  }
+}
+
+}  // namespace halmet
@@ -0,0 +1,94 @@
+#ifndef HALMET_SRC_N2K_LISTENER_H_
+#define HALMET_SRC_N2K_LISTENER_H_
+
+#include <N2kMsg.h>
+#include <NMEA2000.h>
+
+#include "n2k_pgn_cache.h"
+#include "sensesp/system/valueproducer.h"
+
+namespace halmet {
+
+/**
+ * @brief A value read from the listener's PGN cache.
+ *
+ * Emits each new value of one field from messages with the given instance
+ * and source. Emits NAN once when the cached message expires.
+ */
+class N2kSubscription : public sensesp::ValueProducer<float> {
+ public:
+  N2kSubscription(N2kField field, uint8_t instance, uint8_t source)
+      : field_{field}, instance_{instance}, source_{source} {}
+
+ protected:
+  friend class N2kListener;
+
+  N2kField field_;
+  uint8_t instance_;
+  uint8_t source_;
+  uint32_t last_sequence_ = 0;
+  bool expired_ = true;
+};
+
+/**
+ * @brief Cache of the latest values of selected PGNs from other devices.
+ *
+ * The first subscription to a field attaches a message handler for its PGN.
+ * The handler decodes the library's reassembled message into an
+ * N2kPgnCache.
+ *
+ * The handler runs wherever ParseMessages() runs, which is the CAN task in
+ * dual-core mode. The subscriptions are updated from the event loop every
+ * poll_interval_ms. Entries older than expiry_ms are reported as expired.
+ *
+ * handle() is public so that captured messages can be replayed into the
+ * cache without a bus.
+ */
+class N2kListener {
+ public:
+  static const size_t kMaxSubscriptions = 16;
+
+  N2kListener(tNMEA2000* nmea2000, unsigned int expiry_ms = 5000,
+              unsigned int poll_interval_ms = 100);
+
+  /**
+   * @brief Subscribe to a field of an incoming PGN.
+   *
+   * @param instance Engine or tank instance. Ignored for PGNs without one.
+   * @param source Source address, or kN2kAnySource.
+   * @return nullptr if the subscription table is full.
+   */
+  N2kSubscription* subscribe(N2kField field, uint8_t instance = 0,
+                             uint8_t source = kN2kAnySource);
+
+  /// Decode a message into the cache if its PGN is subscribed.
+  void handle(const tN2kMsg& msg);
+
+ protected:
+  class PgnHandler : public tNMEA2000::tMsgHandler {
+   public:
+    PgnHandler(unsigned long pgn, tNMEA2000* nmea2000, N2kListener* listener)
+        : tNMEA2000::tMsgHandler(pgn, nmea2000), listener_{listener} {}
+    void HandleMsg(const tN2kMsg& msg) override { listener_->handle(msg); }
+
+   protected:
+    N2kListener* listener_;
+  };
+
+  bool listen(uint32_t pgn);
+  bool is_listening(uint32_t pgn) const;
+  void poll();
+
+  tNMEA2000* nmea2000_;
+  unsigned int expiry_ms_;
+
+  N2kPgnCache cache_;
+  N2kSubscription* subscriptions_[kMaxSubscriptions] = {};
+  size_t num_subscriptions_ = 0;
+  uint32_t pgns_[kMaxSubscriptions] = {};
+  size_t num_pgns_ = 0;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_N2K_LISTENER_H_
@@ -0,0 +1,232 @@
+#ifndef HALMET_SRC_N2K_PGN_CACHE_H_
+#define HALMET_SRC_N2K_PGN_CACHE_H_
+
+#include <N2kMessages.h>
+#include <N2kMsg.h>
+#include <math.h>
+
+#include <atomic>
+
+namespace halmet {
+
+/**
+ * @brief Values that can be read from incoming NMEA 2000 messages.
+ *
+ * Units are those of the NMEA2000 library parsers.
+ */
+enum class N2kField : uint8_t {
+  kEngineSpeed,         // 127488, rpm
+  kFuelRate,            // 127489, l/h
+  kEngineHours,         // 127489, s
+  kCoolantTemperature,  // 127489, K
+  kOilPressure,         // 127489, Pa
+  kSpeedThroughWater,   // 128259, m/s
+  kSpeedOverGround,     // 128259, m/s
+  kTankLevel,           // 127505, %
+  kTankCapacity,        // 127505, l
+};
+
+/// Matches messages from any source address.
+const uint8_t kN2kAnySource = 0xff;
+
+/**
+ * @brief Latest values of selected PGNs, keyed by PGN, source and instance.
+ *
+ * decode() parses a message in place into a fixed table; there is no copy
+ * of the message and no allocation. When the table is full, the least
+ * recently updated entry is replaced. decode() and read() may run on
+ * different tasks: each entry is guarded by a sequence counter, and read()
+ * retries while an entry is being written. There must be only one writer.
+ *
+ * Times are passed in, so the class does not depend on the Arduino core.
+ */
+class N2kPgnCache {
+ public:
+  static const size_t kMaxEntries = 16;
+  static const size_t kMaxValues = 4;
+
+  struct Reading {
+    bool found = false;
+    uint32_t sequence = 0;  // changes whenever the entry is updated
+    uint32_t age_ms = 0;
+    float value = NAN;  // NAN if the field was not available
+  };
+
+  /// PGN that carries field.
+  static uint32_t pgn(N2kField field) { return location(field).pgn; }
+
+  /// Store the values of msg, received at now_ms. Returns false if the PGN
+  /// is not one of the fields' PGNs or the message could not be parsed.
+  bool decode(const tN2kMsg& msg, uint32_t now_ms) {
+    double values[kMaxValues];
+    unsigned char instance = 0;
+    size_t count = 0;
+
+    switch (msg.PGN) {
+      case 127488: {
+        double boost_pressure;
+        int8_t tilt_trim;
+        if (ParseN2kEngineParamRapid(msg, instance, values[0], boost_pressure,
+                                     tilt_trim)) {
+          count = 1;
+        }
+        break;
+      }
+      case 127489: {
+        double oil_temperature, alternator_voltage, coolant_pressure,
+            fuel_pressure;
+        int8_t load, torque;
+        tN2kEngineDiscreteStatus1 status1;
+        tN2kEngineDiscreteStatus2 status2;
+        if (ParseN2kEngineDynamicParam(
+                msg, instance, values[3], oil_temperature, values[2],
+                alternator_voltage, values[0], values[1], coolant_pressure,
+                fuel_pressure, load, torque, status1, status2)) {
+          count = 4;
+        }
+        break;
+      }
+      case 128259: {
+        unsigned char sid;
+        tN2kSpeedWaterReferenceType reference_type;
+        if (ParseN2kBoatSpeed(msg, sid, values[0], values[1],
+                              reference_type)) {
+          count = 2;
+        }
+        break;
+      }
+      case 127505: {
+        tN2kFluidType fluid_type;
+        if (ParseN2kFluidLevel(msg, instance, fluid_type, values[0],
+                               values[1])) {
+          count = 2;
+        }
+        break;
+      }
+    }
+
+    if (count == 0) {
+      return false;
+    }
+    store(msg.PGN, msg.Source, instance, values, count, now_ms);
+    return true;
+  }
+
+  /**
+   * @brief The most recent value of field.
+   *
+   * @param instance Engine or tank instance. Ignored for PGNs without one.
+   * @param source Source address, or kN2kAnySource.
+   */
+  Reading read(N2kField field, uint8_t instance, uint8_t source,
+               uint32_t now_ms) const {
+    const FieldLocation& field_location = location(field);
+    Reading reading;
+    for (size_t i = 0; i < kMaxEntries; i++) {
+      const Entry& entry = entries_[i];
+      uint32_t sequence, pgn, updated_ms;
+      uint8_t entry_source, entry_instance;
+      float value;
+      do {
+        sequence = entry.sequence.load(std::memory_order_acquire);
+        pgn = entry.pgn;
+        entry_source = entry.source;
+        entry_instance = entry.instance;
+        updated_ms = entry.updated_ms;
+        value = entry.values[field_location.index];
+        std::atomic_thread_fence(std::memory_order_acquire);
+      } while ((sequence & 1) ||
+               sequence != entry.sequence.load(std::memory_order_relaxed));
+
+      if (pgn != field_location.pgn || entry_instance != instance ||
+          (source != kN2kAnySource && entry_source != source)) {
+        continue;
+      }
+      uint32_t age = now_ms - updated_ms;
+      if (!reading.found || age < reading.age_ms) {
+        reading.found = true;
+        reading.sequence = sequence;
+        reading.age_ms = age;
+        reading.value = value;
+      }
+    }
+    return reading;
+  }
+
+ protected:
+  // Where each field is stored: the PGN it is parsed from and the index in
+  // the entry's value array.
+  struct FieldLocation {
+    uint32_t pgn;
+    uint8_t index;
+  };
+
+  struct Entry {
+    std::atomic<uint32_t> sequence{0};  // odd while being written
+    uint32_t pgn = 0;
+    uint8_t source = 0;
+    uint8_t instance = 0;
+    uint32_t updated_ms = 0;
+    float values[kMaxValues];
+  };
+
+  static const FieldLocation& location(N2kField field) {
+    static const FieldLocation kFieldLocations[] = {
+        {127488, 0},  // kEngineSpeed
+        {127489, 0},  // kFuelRate
+        {127489, 1},  // kEngineHours
+        {127489, 2},  // kCoolantTemperature
+        {127489, 3},  // kOilPressure
+        {128259, 0},  // kSpeedThroughWater
+        {128259, 1},  // kSpeedOverGround
+        {127505, 0},  // kTankLevel
+        {127505, 1},  // kTankCapacity
+    };
+    return kFieldLocations[static_cast<int>(field)];
+  }
+
+  Entry* find_or_replace(uint32_t pgn, uint8_t source, uint8_t instance) {
+    Entry* oldest = &entries_[0];
+    for (size_t i = 0; i < kMaxEntries; i++) {
+      Entry* entry = &entries_[i];
+      if (entry->pgn == pgn && entry->source == source &&
+          entry->instance == instance) {
+        return entry;
+      }
+      if (entry->pgn == 0) {
+        // Unused entries come last
+        return entry;
+      }
+      if (entry->updated_ms - oldest->updated_ms > 0x80000000UL) {
+        oldest = entry;
+      }
+    }
+    return oldest;
+  }
+
+  void store(uint32_t pgn, uint8_t source, uint8_t instance,
+             const double* values, size_t count, uint32_t now_ms) {
+    Entry* entry = find_or_replace(pgn, source, instance);
+
+    // Readers retry while the sequence number is odd or has changed.
+    uint32_t sequence = entry->sequence.load(std::memory_order_relaxed);
+    entry->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    entry->pgn = pgn;
+    entry->source = source;
+    entry->instance = instance;
+    entry->updated_ms = now_ms;
+    for (size_t i = 0; i < kMaxValues; i++) {
+      entry->values[i] = i < count && !N2kIsNA(values[i]) ? values[i] : NAN;
+    }
+
+    entry->sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  Entry entries_[kMaxEntries];
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_N2K_PGN_CACHE_H_
@@ -4,6 +4,12 @@
 #include <N2kMessages.h>
 #include <NMEA2000.h>
 
+#include <atomic>
+
+#include "allocation_scope.h"
+#include "graph_arena.h"
+#include "n2k_task.h"
+#include "n2k_tx_budget.h"
 #include "sensesp/system/saveable.h"
 #include "sensesp/transforms/lambda_transform.h"
 #include "sensesp/transforms/repeat.h"
@@ -11,12 +17,21 @@
 
 namespace halmet {
 
+/// NMEA 2000 "not available" for values that are NAN, e.g. from a sender
+/// that is open or shorted. The message encoders do not handle NAN.
+inline double N2kValueOrNA(double value) {
+  return isnan(value) ? N2kDoubleNA : value;
+}
+
 /**
  * @brief Transmit NMEA 2000 PGN 127488: Engine Parameters, Rapid Update
  *
  */
 class N2kEngineParameterRapidSender : public sensesp::FileSystemSaveable {
  public:
+  static constexpr uint32_t kPGN = 127488;
+  static constexpr uint8_t kFrames = N2kFrameCount(8);  // single frame
+
   N2kEngineParameterRapidSender(String config_path, uint8_t engine_instance,
                                 tNMEA2000* nmea2000)
       : sensesp::FileSystemSaveable{config_path},
@@ -25,19 +40,47 @@ class N2kEngineParameterRapidSender : public sensesp::FileSystemSaveable {
         repeat_interval_{100},  // In ms. Dictated by NMEA 2000 standard!
         expiry_{1000}           // In ms. When the inputs expire.
   {
+    load();
+    N2kTransmitBudget().add({kPGN, kFrames, repeat_interval_});
     this->initialize_members(repeat_interval_, expiry_);
+#ifdef ENABLE_DUAL_CORE
+    // Send from the CAN task, so that WiFi and web UI activity on the event
+    // loop cannot delay the rapid PGN. The values are copied over as the
+    // event loop updates them.
+    engine_speed_rpm_->connect_to(&task_engine_speed_rpm_);
+    engine_boost_pressure_->connect_to(&task_engine_boost_pressure_);
+    engine_tilt_trim_->connect_to(&task_engine_tilt_trim_);
+    AddN2kTaskSender(repeat_interval_, [this](tN2kMsg& N2kMsg) {
+      if (this->suppressed_) {
+        return false;
+      }
+      SetN2kEngineParamRapid(
+          N2kMsg, this->engine_instance_,
+          N2kValueOrNA(this->task_engine_speed_rpm_.get()),
+          N2kValueOrNA(this->task_engine_boost_pressure_.get()),
+          this->task_engine_tilt_trim_.get());
+      return true;
+    });
+#else
     sensesp::event_loop()->onRepeat(repeat_interval_, [this]() {
+      AllocationScope allocation_scope(AllocationSource::kSample);
+      if (this->suppressed_) {
+        return;
+      }
       tN2kMsg N2kMsg;
       // At the moment, the PGN is sent regardless of whether all the values
       // are invalid or not.
       SetN2kEngineParamRapid(
-          N2kMsg, this->engine_instance_, this->engine_speed_rpm_->get(),
-          this->engine_boost_pressure_->get(), this->engine_tilt_trim_->get());
-      this->nmea2000_->SendMsg(N2kMsg);
+          N2kMsg, this->engine_instance_,
+          N2kValueOrNA(this->engine_speed_rpm_->get()),
+          N2kValueOrNA(this->engine_boost_pressure_->get()),
+          this->engine_tilt_trim_->get());
+      SendN2kMsg(this->nmea2000_, N2kMsg);
     });
+#endif
 
     engine_speed_
-        .connect_to(new sensesp::LambdaTransform<double, double>(
+        .connect_to(GraphNew<sensesp::LambdaTransform<double, double>>(
             [](double value) { return 60 * value; }))
         ->connect_to(engine_speed_rpm_);
   }
@@ -55,6 +98,10 @@ class N2kEngineParameterRapidSender : public sensesp::FileSystemSaveable {
     return true;
   }
 
+  /// Stop sending the PGN while suppressed, e.g. while a self-test drives
+  /// the tacho input with a test signal.
+  void set_suppressed(bool suppressed) { suppressed_ = suppressed; }
+
   sensesp::ObservableValue<double>
       engine_speed_;  // Connected to engine_speed_rpm_
   std::shared_ptr<sensesp::RepeatExpiring<double>> engine_boost_pressure_;
@@ -68,6 +115,14 @@ class N2kEngineParameterRapidSender : public sensesp::FileSystemSaveable {
   std::shared_ptr<sensesp::RepeatExpiring<double>> engine_speed_rpm_;
 
   uint8_t engine_instance_ = 0;
+  // Also read by the CAN task with ENABLE_DUAL_CORE
+  std::atomic<bool> suppressed_{false};
+
+#ifdef ENABLE_DUAL_CORE
+  N2kTaskValue<double> task_engine_speed_rpm_{N2kDoubleNA};
+  N2kTaskValue<double> task_engine_boost_pressure_{N2kDoubleNA};
+  N2kTaskValue<int8_t> task_engine_tilt_trim_{N2kInt8NA};
+#endif
 
  private:
   void initialize_members(unsigned int repeat_interval, unsigned int expiry) {
@@ -81,7 +136,7 @@ class N2kEngineParameterRapidSender : public sensesp::FileSystemSaveable {
   }
 };
 
-const String ConfigSchema(const N2kEngineParameterRapidSender& obj) {
+inline const String ConfigSchema(const N2kEngineParameterRapidSender& obj) {
   return R"###({
     "type": "object",
     "properties": {
@@ -96,6 +151,9 @@ const String ConfigSchema(const N2kEngineParameterRapidSender& obj) {
  */
 class N2kEngineParameterDynamicSender : public sensesp::FileSystemSaveable {
  public:
+  static constexpr uint32_t kPGN = 127489;
+  static constexpr uint8_t kFrames = N2kFrameCount(26);  // fast packet
+
   N2kEngineParameterDynamicSender(String config_path, uint8_t engine_instance,
                                   tNMEA2000* nmea2000)
       : sensesp::FileSystemSaveable{config_path},
@@ -104,19 +162,26 @@ class N2kEngineParameterDynamicSender : public sensesp::FileSystemSaveable {
         repeat_interval_{500},  // In ms. Dictated by NMEA 2000 standard!
         expiry_{5000}           // In ms. When the inputs expire.
   {
+    load();
+    N2kTransmitBudget().add({kPGN, kFrames, repeat_interval_});
     this->initialize_members(repeat_interval_, expiry_);
 
     sensesp::event_loop()->onRepeat(repeat_interval_, [this]() {
+      AllocationScope allocation_scope(AllocationSource::kSample);
       tN2kMsg N2kMsg;
       SetN2kEngineDynamicParam(
-          N2kMsg, this->engine_instance_, this->oil_pressure_->get(),
-          this->oil_temperature_->get(), this->temperature_->get(),
-          this->alternator_potential_->get(), this->fuel_rate_->get(),
-          this->total_engine_hours_->get(), this->coolant_pressure_->get(),
-          this->fuel_pressure_->get(), this->engine_load_->get(),
+          N2kMsg, this->engine_instance_,
+          N2kValueOrNA(this->oil_pressure_->get()),
+          N2kValueOrNA(this->oil_temperature_->get()),
+          N2kValueOrNA(this->temperature_->get()),
+          N2kValueOrNA(this->alternator_potential_->get()),
+          N2kValueOrNA(this->fuel_rate_->get()),
+          this->total_engine_hours_->get(),
+          N2kValueOrNA(this->coolant_pressure_->get()),
+          N2kValueOrNA(this->fuel_pressure_->get()), this->engine_load_->get(),
           this->engine_torque_->get(), this->get_engine_status_1(),
           this->get_engine_status_2());
-      this->nmea2000_->SendMsg(N2kMsg);
+      SendN2kMsg(this->nmea2000_, N2kMsg);
     });
   }
 
@@ -171,7 +236,8 @@ class N2kEngineParameterDynamicSender : public sensesp::FileSystemSaveable {
     return true;
   }
 
- protected:
+  /// Engine status 1 bits from the current inputs, with CheckEngine set if
+  /// any other bit is set.
   tN2kEngineDiscreteStatus1 get_engine_status_1() {
     tN2kEngineDiscreteStatus1 status = 0;
 
@@ -206,6 +272,7 @@ class N2kEngineParameterDynamicSender : public sensesp::FileSystemSaveable {
     return status;
   }
 
+ protected:
   tN2kEngineDiscreteStatus2 get_engine_status_2() {
     tN2kEngineDiscreteStatus2 status = 0;
     status.Bits.WarningLevel1 = warning_level_1_->get();
@@ -300,7 +367,7 @@ class N2kEngineParameterDynamicSender : public sensesp::FileSystemSaveable {
   }
 };
 
-const String ConfigSchema(const N2kEngineParameterDynamicSender& obj) {
+inline const String ConfigSchema(const N2kEngineParameterDynamicSender& obj) {
   return R"###({
     "type": "object",
     "properties": {
@@ -315,6 +382,9 @@ const String ConfigSchema(const N2kEngineParameterDynamicSender& obj) {
  */
 class N2kFluidLevelSender : public sensesp::FileSystemSaveable {
  public:
+  static constexpr uint32_t kPGN = 127505;
+  static constexpr uint8_t kFrames = N2kFrameCount(8);  // single frame
+
   N2kFluidLevelSender(String config_path, uint8_t tank_instance,
                       tN2kFluidType tank_type, double tank_capacity,
                       tNMEA2000* nmea2000)
@@ -326,30 +396,37 @@ class N2kFluidLevelSender : public sensesp::FileSystemSaveable {
         repeat_interval_{2500},  // In ms. Dictated by NMEA 2000 standard!
         expiry_{10000}           // In ms. When the inputs expire.
   {
+    load();
+    N2kTransmitBudget().add({kPGN, kFrames, repeat_interval_});
     tank_level_
-        .connect_to(new sensesp::LambdaTransform<double, double>(
+        .connect_to(GraphNew<sensesp::LambdaTransform<double, double>>(
             [this](double value) { return 100 * value; }))
         ->connect_to(&tank_level_percent_);
 
     sensesp::event_loop()->onRepeat(repeat_interval_, [this]() {
+      AllocationScope allocation_scope(AllocationSource::kSample);
       tN2kMsg N2kMsg;
       // At the moment, the PGN is sent regardless of whether all the values
       // are invalid or not.
       SetN2kFluidLevel(N2kMsg, this->tank_instance_, this->tank_type_,
-                       this->tank_level_percent_.get(), this->tank_capacity_);
-      this->nmea2000_->SendMsg(N2kMsg);
+                       N2kValueOrNA(this->tank_level_percent_.get()),
+                       this->tank_capacity_);
+      SendN2kMsg(this->nmea2000_, N2kMsg);
     });
   }
 
   virtual bool from_json(const JsonObject& config) override {
-    String expected[] = {"tank_instance", "tank_type", "tank_capacity"};
+    const char* expected[] = {"tank_instance", "tank_type"};
     for (auto str : expected) {
       if (!config[str].is<int>()) {
-        debugE("N2kFluidLevelSender: Missing configuration key %s",
-               str.c_str());
+        debugE("N2kFluidLevelSender: Missing configuration key %s", str);
         return false;
       }
     }
+    if (!config["tank_capacity"].is<double>()) {
+      debugE("N2kFluidLevelSender: Missing configuration key tank_capacity");
+      return false;
+    }
     tank_instance_ = config["tank_instance"];
     tank_type_ = config["tank_type"];
     tank_capacity_ = config["tank_capacity"];
@@ -363,6 +440,8 @@ class N2kFluidLevelSender : public sensesp::FileSystemSaveable {
     return true;
   }
 
+  double tank_capacity() const { return tank_capacity_; }  // liters
+
   sensesp::ObservableValue<double> tank_level_;  // ratio
 
  protected:
@@ -377,7 +456,7 @@ class N2kFluidLevelSender : public sensesp::FileSystemSaveable {
                                                       expiry_};
 };
 
-const String ConfigSchema(const N2kFluidLevelSender& obj) {
+inline const String ConfigSchema(const N2kFluidLevelSender& obj) {
   return R"###({
       "type": "object",
       "properties": {
@@ -392,11 +471,14 @@ const String ConfigSchema(const N2kFluidLevelSender& obj) {
 
 
 // Function declaration for SetN2kBilgeAlarm
-void SetN2kBilgeAlarm(tN2kMsg& N2kMsg, uint8_t instance, bool alarm_state);
+inline void SetN2kBilgeAlarm(tN2kMsg& N2kMsg, uint8_t instance, bool alarm_state);
 
 // In N2kBilgeAlarmSender class:
 class N2kBilgeAlarmSender : public sensesp::FileSystemSaveable {
  public:
+  static constexpr uint32_t kPGN = 126984;
+  static constexpr uint8_t kFrames = N2kFrameCount(2);  // single frame
+
   N2kBilgeAlarmSender(String config_path, uint8_t instance, bool alarm_state,
                       tNMEA2000* nmea2000)
       : sensesp::FileSystemSaveable{config_path},
@@ -405,30 +487,30 @@ class N2kBilgeAlarmSender : public sensesp::FileSystemSaveable {
         nmea2000_{nmea2000},
         repeat_interval_{2500},
         expiry_{10000} {
+    load();
+    N2kTransmitBudget().add({kPGN, kFrames, repeat_interval_});
     sensesp::event_loop()->onRepeat(repeat_interval_, [this]() {
+      AllocationScope allocation_scope(AllocationSource::kSample);
       tN2kMsg N2kMsg;
       // Ensure the SetN2kBilgeAlarm function is available
       SetN2kBilgeAlarm(N2kMsg, this->instance_, this->alarm_state_.get());
-      this->nmea2000_->SendMsg(N2kMsg);
+      SendN2kMsg(this->nmea2000_, N2kMsg);
     });
   }
 
+  // The alarm state is a live input, not configuration: restoring a saved
+  // state at boot would report a stale alarm.
   virtual bool from_json(const JsonObject& config) override {
-    String expected[] = {"instance", "alarm_state"};
-    for (auto str : expected) {
-      if (!config[str].is<bool>()) {
-        debugE("N2kBilgeAlarmSender: Missing configuration key %s", str.c_str());
-        return false;
-      }
+    if (!config["instance"].is<int>()) {
+      debugE("N2kBilgeAlarmSender: Missing configuration key instance");
+      return false;
     }
     instance_ = config["instance"];
-    alarm_state_.set(config["alarm_state"]);
     return true;
   }
 
   virtual bool to_json(JsonObject& config) override {
     config["instance"] = instance_;
-    config["alarm_state"] = alarm_state_.get();
     return true;
   }
 
@@ -443,7 +525,7 @@ class N2kBilgeAlarmSender : public sensesp::FileSystemSaveable {
 };
 
 // Function definition for SetN2kBilgeAlarm
-void SetN2kBilgeAlarm(tN2kMsg& N2kMsg, uint8_t instance, bool alarm_state) {
+inline void SetN2kBilgeAlarm(tN2kMsg& N2kMsg, uint8_t instance, bool alarm_state) {
     N2kMsg.SetPGN(126984);  // Set the PGN to 126984 (NMEA 2000 Alert PGN for alarms)
 
     N2kMsg.Priority = 3;  // Priority for alarms (could be changed)
@@ -455,7 +537,7 @@ void SetN2kBilgeAlarm(tN2kMsg& N2kMsg, uint8_t instance, bool alarm_state) {
 }
 
 // Function to set exhaust temperature message
-void SetN2kExhaustTemperature(tN2kMsg& N2kMsg, uint8_t instance, float temperature) {
+inline void SetN2kExhaustTemperature(tN2kMsg& N2kMsg, uint8_t instance, float temperature) {
     // PGN for Engine Exhaust Temperature (Raymarine standard)
     N2kMsg.SetPGN(130316);  // Engine Exhaust Temperature (Raymarine PGN)
     N2kMsg.Priority = 3;    // Standard Priority (could be adjusted)
@@ -469,6 +551,9 @@ void SetN2kExhaustTemperature(tN2kMsg& N2kMsg, uint8_t instance, float temperatu
 
 class N2kExhaustTemperatureSender : public sensesp::FileSystemSaveable {
 public:
+    static constexpr uint32_t kPGN = 130316;
+    static constexpr uint8_t kFrames = N2kFrameCount(5);  // single frame
+
     N2kExhaustTemperatureSender(String config_path, uint8_t instance, float initial_temp, tNMEA2000* nmea2000)
         : sensesp::FileSystemSaveable{config_path},
           instance_{instance},
@@ -477,30 +562,30 @@ public:
           repeat_interval_{2500},      // Interval to send the data (ms)
           expiry_{10000}               // Expiry (ms), after which data stops if not updated
     {
+        load();
+        N2kTransmitBudget().add({kPGN, kFrames, repeat_interval_});
         sensesp::event_loop()->onRepeat(repeat_interval_, [this]() {
+            AllocationScope allocation_scope(AllocationSource::kSample);
             tN2kMsg N2kMsg;
             // Send Exhaust Temperature using PGN 130316
             SetN2kExhaustTemperature(N2kMsg, this->instance_, this->temperature_.get());
-            this->nmea2000_->SendMsg(N2kMsg);
+            SendN2kMsg(this->nmea2000_, N2kMsg);
         });
     }
 
+    // Like the bilge alarm state, the temperature is a live input and is
+    // not restored from the configuration.
     virtual bool from_json(const JsonObject& config) override {
-        String expected[] = {"instance", "temperature"};
-        for (auto str : expected) {
-            if (!config[str].is<float>()) {
-                debugE("N2kExhaustTemperatureSender: Missing configuration key %s", str.c_str());
-                return false;
-            }
+        if (!config["instance"].is<int>()) {
+            debugE("N2kExhaustTemperatureSender: Missing configuration key instance");
+            return false;
         }
         instance_ = config["instance"];
-        temperature_.set(config["temperature"]);
         return true;
     }
 
     virtual bool to_json(JsonObject& config) override {
         config["instance"] = instance_;
-        config["temperature"] = temperature_.get();
         return true;
     }
 
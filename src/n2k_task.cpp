@@ -0,0 +1,143 @@
+#include "n2k_task.h"
+
+#include <Arduino.h>
+
+#include <vector>
+
+#include "allocation_scope.h"
+#include "sensesp_base_app.h"
+#include "spsc_queue.h"
+
+#ifdef ENABLE_LATENCY_PROBES
+#include "latency_probe.h"
+#endif
+
+namespace halmet {
+
+// Room for a few sender periods' worth of messages. Each slot holds a whole
+// tN2kMsg, so keep this small.
+static const size_t kN2kTxQueueSize = 16;
+static const uint32_t kN2kTaskStackSize = 4096;
+// Above the Arduino loop task (1), below the WiFi and lwIP tasks.
+static const UBaseType_t kN2kTaskPriority = 10;
+static const BaseType_t kN2kTaskCore = 0;
+// With the RX interrupt, the longest the task sleeps without a wake-up.
+// Keeps the library's address claim and heartbeat timing running.
+static const uint32_t kN2kIdleWakeupMs = 10;
+
+struct N2kTaskSender {
+  uint32_t interval_ms;
+  uint32_t due_ms;
+  std::function<bool(tN2kMsg&)> build;
+};
+
+static SpscQueue<tN2kMsg, kN2kTxQueueSize> n2k_tx_queue;
+// Filled in setup() before the task starts; read only by the task after.
+static std::vector<N2kTaskSender> n2k_task_senders;
+static TaskHandle_t n2k_task_handle = nullptr;
+static bool n2k_task_rx_interrupt = false;
+
+bool SendN2kMsg(tNMEA2000* nmea2000, const tN2kMsg& msg) {
+#ifdef ENABLE_LATENCY_PROBES
+  NotifyLatencyProbes(msg.PGN);
+#endif
+  if (n2k_task_handle == nullptr) {
+    return nmea2000->SendMsg(msg);
+  }
+  bool queued = n2k_tx_queue.push(msg);
+  if (n2k_task_rx_interrupt) {
+    xTaskNotifyGive(n2k_task_handle);
+  }
+  return queued;
+}
+
+void AddN2kTaskSender(unsigned int interval_ms,
+                      std::function<bool(tN2kMsg&)> build) {
+  n2k_task_senders.push_back({interval_ms, 0, build});
+}
+
+// Run the senders that are due and return the time until the next one is.
+static uint32_t RunN2kTaskSenders(HalmetNMEA2000* nmea2000) {
+  uint32_t now = millis();
+  uint32_t wait_ms = kN2kIdleWakeupMs;
+  for (auto& sender : n2k_task_senders) {
+    if (static_cast<int32_t>(now - sender.due_ms) >= 0) {
+      // Keep the schedule unless the task fell a whole period behind
+      sender.due_ms += sender.interval_ms;
+      if (static_cast<int32_t>(now - sender.due_ms) >= 0) {
+        sender.due_ms = now + sender.interval_ms;
+      }
+      tN2kMsg msg;
+      if (sender.build(msg)) {
+#ifdef ENABLE_LATENCY_PROBES
+        NotifyLatencyProbes(msg.PGN);
+#endif
+        nmea2000->SendMsg(msg);
+      }
+    }
+    uint32_t until_due = sender.due_ms - now;
+    if (until_due < wait_ms) {
+      wait_ms = until_due;
+    }
+  }
+  return wait_ms;
+}
+
+static void N2kTask(void* parameter) {
+  auto nmea2000 = static_cast<HalmetNMEA2000*>(parameter);
+  uint32_t now = millis();
+  for (auto& sender : n2k_task_senders) {
+    sender.due_ms = now + sender.interval_ms;
+  }
+  tN2kMsg msg;
+  while (true) {
+    uint32_t wait_ms = RunN2kTaskSenders(nmea2000);
+    while (n2k_tx_queue.pop(msg)) {
+      nmea2000->SendMsg(msg);
+    }
+    if (n2k_task_rx_interrupt) {
+      // Drain the pending burst and re-arm the RX interrupt, or, after a
+      // transmit or timeout wake-up, only run the library housekeeping.
+      if (!nmea2000->parse_if_pending()) {
+        nmea2000->parse_batch();
+      }
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
+    } else {
+      nmea2000->parse_batch();
+      vTaskDelay(pdMS_TO_TICKS(1));
+    }
+  }
+}
+
+void StartN2kTask(HalmetNMEA2000* nmea2000, bool rx_interrupt) {
+  n2k_task_rx_interrupt = rx_interrupt;
+  BaseType_t result = xTaskCreatePinnedToCore(
+      N2kTask, "n2k", kN2kTaskStackSize, nmea2000, kN2kTaskPriority,
+      &n2k_task_handle, kN2kTaskCore);
+  if (result != pdPASS) {
+    n2k_task_handle = nullptr;
+    debugE("Failed to start the NMEA 2000 task");
+    for (auto& sender : n2k_task_senders) {
+      auto build = sender.build;
+      sensesp::event_loop()->onRepeat(sender.interval_ms,
+                                      [nmea2000, build]() {
+                                        AllocationScope allocation_scope(
+                                            AllocationSource::kSample);
+                                        tN2kMsg msg;
+                                        if (build(msg)) {
+                                          SendN2kMsg(nmea2000, msg);
+                                        }
+                                      });
+    }
+    return;
+  }
+  if (rx_interrupt) {
+    nmea2000->enable_rx_interrupt(n2k_task_handle);
+  }
+}
+
+size_t N2kTxQueueHighWaterMark() { return n2k_tx_queue.high_water_mark(); }
+
+size_t N2kTxQueueDropped() { return n2k_tx_queue.dropped(); }
+
+}  // namespace halmet
@@ -0,0 +1,88 @@
+#ifndef HALMET_SRC_N2K_TASK_H_
+#define HALMET_SRC_N2K_TASK_H_
+
+#include <NMEA2000.h>
+
+#include <functional>
+
+#include "halmet_nmea2000.h"
+#include "sensesp/system/valueconsumer.h"
+
+namespace halmet {
+
+/**
+ * @brief Send an NMEA 2000 message.
+ *
+ * Once StartN2kTask() has been called, the message is copied into a
+ * lock-free queue and transmitted by the CAN task. Before that, or if the
+ * dual-core mode is not used, it is sent directly.
+ *
+ * @return false if the message could not be sent or queued.
+ */
+bool SendN2kMsg(tNMEA2000* nmea2000, const tN2kMsg& msg);
+
+/**
+ * @brief Move all NMEA 2000 bus I/O to a dedicated task.
+ *
+ * The task is pinned to core 0 and runs at a higher priority than the
+ * Arduino loop task, which keeps running the SensESP event loop, WiFi
+ * clients and the web UI on core 1. The task runs the senders registered
+ * with AddN2kTaskSender(), transmits the messages queued by SendN2kMsg()
+ * and parses incoming frames, either every millisecond or, with
+ * rx_interrupt, when the RX interrupt or a queued message wakes it. From
+ * this point on, only the CAN task may call into the NMEA 2000 object.
+ *
+ * Sensor inputs, including the ADC reads, stay on the event loop on core 1;
+ * a stalled event loop delays value updates but not the task's senders.
+ */
+void StartN2kTask(HalmetNMEA2000* nmea2000, bool rx_interrupt = false);
+
+/**
+ * @brief Send a message every interval_ms from the CAN task.
+ *
+ * build fills in the message and returns false to skip this period; it
+ * runs on the CAN task and may only read values handed over through
+ * N2kTaskValue or atomics. Register all senders before StartN2kTask(). If
+ * the task cannot be started, the senders fall back to event loop timers.
+ */
+void AddN2kTaskSender(unsigned int interval_ms,
+                      std::function<bool(tN2kMsg&)> build);
+
+/**
+ * @brief A value written by the event loop and read by the CAN task.
+ *
+ * Connect a producer on the event loop side and read the latest value with
+ * get() in an AddN2kTaskSender() callback. A spinlock guards the copy, so T
+ * may be wider than a machine word.
+ */
+template <typename T>
+class N2kTaskValue : public sensesp::ValueConsumer<T> {
+ public:
+  explicit N2kTaskValue(T value) : value_{value} {}
+
+  void set(const T& value) override {
+    portENTER_CRITICAL(&lock_);
+    value_ = value;
+    portEXIT_CRITICAL(&lock_);
+  }
+
+  T get() {
+    portENTER_CRITICAL(&lock_);
+    T value = value_;
+    portEXIT_CRITICAL(&lock_);
+    return value;
+  }
+
+ protected:
+  T value_;
+  portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+};
+
+/// Largest number of messages waiting in the transmit queue so far.
+size_t N2kTxQueueHighWaterMark();
+/// Number of messages dropped because the transmit queue was full.
+size_t N2kTxQueueDropped();
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_N2K_TASK_H_
@@ -0,0 +1,100 @@
+#ifndef HALMET_SRC_N2K_TX_BUDGET_H_
+#define HALMET_SRC_N2K_TX_BUDGET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace halmet {
+
+/// Number of CAN frames needed for an NMEA 2000 message with data_len bytes.
+/// Up to 8 bytes fit in a single frame. Longer messages are sent as fast
+/// packets with 6 data bytes in the first frame and 7 in each following one.
+constexpr uint8_t N2kFrameCount(size_t data_len) {
+  return data_len <= 8 ? 1 : 1 + (data_len - 6 + 7 - 1) / 7;
+}
+
+/**
+ * @brief Transmit demand of one periodic PGN sender.
+ */
+struct N2kTxDemand {
+  uint32_t pgn;
+  uint8_t frames;      // CAN frames per message
+  uint32_t period_ms;  // transmit interval
+};
+
+/**
+ * @brief Worst-case transmit demand of all registered senders.
+ *
+ * Senders register their PGN, frame count and period when they are
+ * constructed. Since all sender timers are started during setup(), they may
+ * all fire in the same event loop pass. While the bus is stalled, for
+ * example by higher-priority traffic, faster senders fire again before the
+ * first burst has drained. The send buffer must hold all of these frames
+ * plus the library's own responses to ISO requests.
+ */
+class N2kTxBudget {
+ public:
+  // How long the send buffer must absorb frames without draining
+  static const uint32_t kStallMs = 100;
+  // Product information (20 frames), configuration information, address
+  // claim, heartbeat and PGN lists sent by the library on request
+  static const size_t kLibraryReserveFrames = 32;
+  // Smallest and largest send buffer to allocate. The library replaces
+  // anything below 10 frames with its own default.
+  static const size_t kMinBufferFrames = 10;
+  static const size_t kMaxBufferFrames = 250;
+
+  void add(const N2kTxDemand& demand) {
+    senders_++;
+    if (demand.period_ms == 0) {
+      return;
+    }
+    burst_frames_ += demand.frames * (1 + kStallMs / demand.period_ms);
+    frames_per_s_ += demand.frames * 1000.0f / demand.period_ms;
+  }
+
+  size_t senders() const { return senders_; }
+
+  /// Frames queued if every sender fires at once and the bus stalls.
+  size_t burst_frames() const { return burst_frames_; }
+
+  /// Average transmitted frames per second.
+  float frames_per_second() const { return frames_per_s_; }
+
+  /// Frames needed in the send buffer, with 50% margin, before clamping.
+  size_t required_buffer_frames() const {
+    return (burst_frames_ + kLibraryReserveFrames) * 3 / 2;
+  }
+
+  /// Send buffer size to allocate.
+  size_t buffer_frames() const {
+    size_t frames = required_buffer_frames();
+    if (frames < kMinBufferFrames) {
+      return kMinBufferFrames;
+    }
+    if (frames > kMaxBufferFrames) {
+      return kMaxBufferFrames;
+    }
+    return frames;
+  }
+
+  /// True if the largest allocatable buffer is smaller than required.
+  bool may_overflow() const {
+    return required_buffer_frames() > kMaxBufferFrames;
+  }
+
+ private:
+  size_t senders_ = 0;
+  size_t burst_frames_ = 0;
+  float frames_per_s_ = 0;
+};
+
+/// Transmit demand of all senders created so far.
+inline N2kTxBudget& N2kTransmitBudget() {
+  static N2kTxBudget budget;
+  return budget;
+}
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_N2K_TX_BUDGET_H_
@@ -0,0 +1,114 @@
+#include "power_manager.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+#include <algorithm>
+
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+// CPU clock while the engine runs and while it is stopped. WiFi needs at
+// least 80 MHz; the APB clock, and with it CAN and LEDC timing, stays at
+// 80 MHz for both settings.
+static const uint32_t kFullSpeedMhz = 240;
+static const uint32_t kLowPowerMhz = 80;
+
+// ReactESP has no public accessor for the due time of its next timer, and
+// the timers registered by SensESP itself cannot be tracked from outside.
+// A member pointer taken in a derived class reads the protected timed_queue
+// of any EventLoop instead. This depends on ReactESP internals: the queue's
+// name and type are checked by the compiler, but not that top() is the
+// earliest timer, so ReactESP is pinned in platformio.ini. Check this when
+// updating it.
+//
+// The read does not take the event loop's locks. That is safe only because
+// it runs in the loop task, which is the only task that adds or removes
+// timers in this firmware: the n2k, n2k_rx and datalog tasks never touch
+// the event loop. Keep it that way, or post such changes to the loop task.
+struct EventLoopTimers : public reactesp::EventLoop {
+  // Microseconds until the earliest timer is due; 0 if it is overdue, and
+  // max_us if there are no timers. Call only from the loop task.
+  static uint64_t next_delay_us(reactesp::EventLoop* event_loop,
+                                uint64_t max_us) {
+    auto& timed_queue = event_loop->*(&EventLoopTimers::timed_queue);
+    if (timed_queue.empty()) {
+      return max_us;
+    }
+    uint64_t due_us = timed_queue.top()->getTriggerTimeMicros();
+    uint64_t now_us = esp_timer_get_time();
+    if (due_us <= now_us) {
+      return 0;
+    }
+    return std::min(due_us - now_us, max_us);
+  }
+};
+
+PowerManager::PowerManager(unsigned int max_idle_ms,
+                           unsigned int stop_delay_ms,
+                           unsigned int report_interval_ms)
+    : engine_frequency_{[this](float frequency) {
+        this->set_engine_running(frequency > 0);
+      }},
+      task_{xTaskGetCurrentTaskHandle()},
+      max_idle_ms_{max_idle_ms},
+      stop_delay_ms_{stop_delay_ms},
+      report_interval_ms_{report_interval_ms},
+      period_start_us_{micros()} {}
+
+void PowerManager::set_engine_running(bool running) {
+  if (running && !engine_running_) {
+    set_low_power(false);
+  } else if (!running && engine_running_) {
+    stopped_since_ = millis();
+  }
+  engine_running_ = running;
+}
+
+void PowerManager::set_low_power(bool low_power) {
+  if (low_power == low_power_) {
+    return;
+  }
+  low_power_ = low_power;
+  setCpuFrequencyMhz(low_power ? kLowPowerMhz : kFullSpeedMhz);
+  debugI("Power mode: %s", low_power ? "low power" : "full speed");
+}
+
+uint32_t PowerManager::next_timer_delay_ms() const {
+  // Tick events are not waited for; they run whenever a timer or a
+  // notification wakes the loop.
+  return EventLoopTimers::next_delay_us(sensesp::event_loop().get(),
+                                        max_idle_ms_ * 1000ULL) /
+         1000;
+}
+
+void PowerManager::tick() {
+  unsigned long start = micros();
+  sensesp::event_loop()->tick();
+  unsigned long end = micros();
+  busy_us_ += end - start;
+
+  if (!engine_running_ && !low_power_ &&
+      millis() - stopped_since_ > stop_delay_ms_) {
+    set_low_power(true);
+  }
+
+  unsigned long elapsed = end - period_start_us_;
+  if (elapsed >= report_interval_ms_ * 1000UL) {
+    duty_cycle_.set(static_cast<float>(busy_us_) / elapsed);
+    busy_us_ = 0;
+    period_start_us_ = end;
+  }
+
+  if (low_power_) {
+    // Block the loop task until the next timer or a notification; the idle
+    // task halts the core in the meantime.
+    uint32_t idle_ms = next_timer_delay_ms();
+    if (idle_ms > 0) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(idle_ms));
+    }
+  }
+}
+
+}  // namespace halmet
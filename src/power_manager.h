@@ -0,0 +1,66 @@
+#ifndef HALMET_SRC_POWER_MANAGER_H_
+#define HALMET_SRC_POWER_MANAGER_H_
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "sensesp/system/lambda_consumer.h"
+#include "sensesp/system/observablevalue.h"
+
+namespace halmet {
+
+/**
+ * @brief Event loop driver that idles the CPU while the engine is stopped.
+ *
+ * Call tick() from loop() instead of event_loop()->tick(). While the engine
+ * runs, the loop spins at full clock speed as before. Once the engine has
+ * been stopped for stop_delay_ms, the CPU clock is lowered to 80 MHz and,
+ * after each pass, the loop task blocks until the next event loop timer is
+ * due, for at most max_idle_ms, so the FreeRTOS idle task can halt the
+ * core. A task notification to the loop task ends the wait early; pass
+ * task() to HalmetNMEA2000::enable_rx_interrupt() to parse received frames
+ * without delay. Interrupt handlers (tacho counter, CAN receive, WiFi) keep
+ * running while the loop task is blocked.
+ *
+ * duty_cycle_ reports the fraction of wall time spent inside the event loop
+ * over each reporting period.
+ */
+class PowerManager {
+ public:
+  PowerManager(unsigned int max_idle_ms = 1000,
+               unsigned int stop_delay_ms = 30000,
+               unsigned int report_interval_ms = 10000);
+
+  void tick();
+
+  bool is_low_power() const { return low_power_; }
+
+  /// The loop task, to be notified of events that need the event loop.
+  TaskHandle_t task() const { return task_; }
+
+  // Engine speed in Hz. Zero means the engine is stopped.
+  sensesp::LambdaConsumer<float> engine_frequency_;
+  // Busy fraction (0-1) of the last reporting period
+  sensesp::ObservableValue<float> duty_cycle_;
+
+ protected:
+  void set_engine_running(bool running);
+  void set_low_power(bool low_power);
+  uint32_t next_timer_delay_ms() const;
+
+  TaskHandle_t task_;
+  unsigned int max_idle_ms_;
+  unsigned int stop_delay_ms_;
+  unsigned int report_interval_ms_;
+
+  bool engine_running_ = true;
+  bool low_power_ = false;
+  unsigned long stopped_since_ = 0;
+
+  unsigned long period_start_us_;
+  unsigned long busy_us_ = 0;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_POWER_MANAGER_H_
@@ -0,0 +1,42 @@
+#ifndef HALMET_SRC_PULSE_ACCUMULATOR_H_
+#define HALMET_SRC_PULSE_ACCUMULATOR_H_
+
+#include <stdint.h>
+
+namespace halmet {
+
+/**
+ * @brief 64-bit pulse total from a wrapping hardware counter.
+ *
+ * The counter counts from 0 up to modulus - 1 and then restarts at 0, like
+ * the ESP32 PCNT with its high limit set to modulus. It must be read at
+ * least once per modulus - 1 pulses; a reading lower than the previous one
+ * is taken as a single wrap.
+ *
+ * Readings are passed in, so the class does not depend on the driver.
+ */
+class PulseAccumulator {
+ public:
+  explicit PulseAccumulator(uint16_t modulus) : modulus_{modulus} {}
+
+  /// Add a counter reading. Returns the pulses since the previous reading.
+  uint32_t update(uint16_t count) {
+    uint32_t delta = count >= last_count_
+                         ? count - last_count_
+                         : static_cast<uint32_t>(modulus_) - last_count_ + count;
+    last_count_ = count;
+    total_ += delta;
+    return delta;
+  }
+
+  uint64_t total() const { return total_; }
+
+ protected:
+  uint16_t modulus_;
+  uint16_t last_count_ = 0;
+  uint64_t total_ = 0;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_PULSE_ACCUMULATOR_H_
@@ -0,0 +1,113 @@
+#include "pulse_counter.h"
+
+#include <Arduino.h>
+
+#include "allocation_scope.h"
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+// The glitch filter counts APB clock cycles, with a 10-bit limit
+static const uint32_t kAPBClockMhz = 80;
+static const uint16_t kMaxFilterCycles = 1023;
+
+// Next free PCNT unit
+static int next_pcnt_unit = PCNT_UNIT_0;
+
+PulseCounter::PulseCounter(const String& config_path, int pin,
+                           float pulses_per_unit, unsigned int read_interval,
+                           unsigned int glitch_filter_ns)
+    : sensesp::FileSystemSaveable{config_path},
+      pulses_per_unit_{pulses_per_unit} {
+  load();
+  if (!begin(pin, glitch_filter_ns)) {
+    return;
+  }
+  last_read_ms_ = millis();
+  sensesp::event_loop()->onRepeat(read_interval, [this]() { this->read(); });
+}
+
+bool PulseCounter::begin(int pin, unsigned int glitch_filter_ns) {
+  if (next_pcnt_unit >= PCNT_UNIT_MAX) {
+    debugE("PulseCounter: No free PCNT unit for pin %d", pin);
+    return false;
+  }
+  pcnt_unit_t unit = static_cast<pcnt_unit_t>(next_pcnt_unit);
+
+  pcnt_config_t config = {};
+  config.pulse_gpio_num = pin;
+  config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+  config.lctrl_mode = PCNT_MODE_KEEP;
+  config.hctrl_mode = PCNT_MODE_KEEP;
+  config.pos_mode = PCNT_COUNT_INC;  // count rising edges
+  config.neg_mode = PCNT_COUNT_DIS;
+  config.counter_h_lim = kCounterLimit;
+  config.counter_l_lim = 0;
+  config.unit = unit;
+  config.channel = PCNT_CHANNEL_0;
+
+  uint32_t filter_cycles = glitch_filter_ns * kAPBClockMhz / 1000;
+  if (filter_cycles > kMaxFilterCycles) {
+    filter_cycles = kMaxFilterCycles;
+  }
+
+  esp_err_t err = pcnt_unit_config(&config);
+  if (err == ESP_OK && filter_cycles > 0) {
+    err = pcnt_set_filter_value(unit, filter_cycles);
+    if (err == ESP_OK) {
+      err = pcnt_filter_enable(unit);
+    }
+  }
+  if (err == ESP_OK) {
+    pcnt_counter_pause(unit);
+    pcnt_counter_clear(unit);
+    err = pcnt_counter_resume(unit);
+  }
+  if (err != ESP_OK) {
+    debugE("PulseCounter: PCNT setup failed for pin %d: %s", pin,
+           esp_err_to_name(err));
+    return false;
+  }
+
+  next_pcnt_unit++;
+  unit_ = unit;
+  debugI("PulseCounter: Pin %d on PCNT unit %d, glitch filter %u ns", pin,
+         unit_, filter_cycles * 1000 / kAPBClockMhz);
+  return true;
+}
+
+void PulseCounter::read() {
+  AllocationScope allocation_scope(AllocationSource::kSample);
+  int16_t count;
+  if (pcnt_get_counter_value(unit_, &count) != ESP_OK) {
+    return;
+  }
+  uint32_t now = millis();
+  uint32_t pulses = accumulator_.update(count);
+  float elapsed = (now - last_read_ms_) / 1000.0f;
+  last_read_ms_ = now;
+
+  if (elapsed > 0) {
+    rate_.set(pulses / elapsed / pulses_per_unit_);
+  }
+  total_.set(accumulator_.total() / static_cast<double>(pulses_per_unit_));
+}
+
+bool PulseCounter::to_json(JsonObject& root) {
+  root["pulses_per_unit"] = pulses_per_unit_;
+  return true;
+}
+
+bool PulseCounter::from_json(const JsonObject& config) {
+  if (!config["pulses_per_unit"].is<float>()) {
+    return false;
+  }
+  float pulses_per_unit = config["pulses_per_unit"];
+  if (pulses_per_unit <= 0) {
+    return false;
+  }
+  pulses_per_unit_ = pulses_per_unit;
+  return true;
+}
+
+}  // namespace halmet
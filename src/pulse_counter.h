@@ -0,0 +1,67 @@
+#ifndef HALMET_SRC_PULSE_COUNTER_H_
+#define HALMET_SRC_PULSE_COUNTER_H_
+
+#include <driver/pcnt.h>
+
+#include "pulse_accumulator.h"
+#include "sensesp/system/observablevalue.h"
+#include "sensesp/system/saveable.h"
+
+namespace halmet {
+
+/**
+ * @brief Fast pulse input, e.g. a fuel flow meter, on an ESP32 PCNT unit.
+ *
+ * Rising edges are counted in hardware, behind the PCNT glitch filter, and
+ * the counter is read every read_interval ms. No interrupt is taken per
+ * edge, so a meter running at several kHz costs one register read per
+ * interval. The 16-bit hardware count is extended to 64 bits by a
+ * PulseAccumulator; at the default 1 s interval, up to 32 kHz is counted
+ * without loss.
+ *
+ * pulses_per_unit is the meter's K-factor, e.g. pulses per liter. rate_ is
+ * in units per second, and total_ in units counted since boot.
+ */
+class PulseCounter : public sensesp::FileSystemSaveable {
+ public:
+  // The PCNT counter restarts at 0 when it reaches this value
+  static const int16_t kCounterLimit = 32767;
+
+  PulseCounter(const String& config_path, int pin,
+               float pulses_per_unit = 1000, unsigned int read_interval = 1000,
+               unsigned int glitch_filter_ns = 1000);
+
+  sensesp::ObservableValue<float> rate_;   // units/s
+  sensesp::ObservableValue<float> total_;  // units
+
+  uint64_t pulses() const { return accumulator_.total(); }
+
+  virtual bool to_json(JsonObject& root) override;
+  virtual bool from_json(const JsonObject& config) override;
+
+ protected:
+  bool begin(int pin, unsigned int glitch_filter_ns);
+  void read();
+
+  float pulses_per_unit_;
+  pcnt_unit_t unit_ = PCNT_UNIT_MAX;  // PCNT_UNIT_MAX if not configured
+  PulseAccumulator accumulator_{kCounterLimit};
+  uint32_t last_read_ms_ = 0;
+};
+
+inline const String ConfigSchema(const PulseCounter& obj) {
+  return R"###({
+    "type": "object",
+    "properties": {
+      "pulses_per_unit": { "title": "Pulses per unit", "type": "number", "description": "Meter K-factor, e.g. pulses per liter" }
+    }
+  })###";
+}
+
+inline const bool ConfigRequiresRestart(const PulseCounter& obj) {
+  return false;
+}
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_PULSE_COUNTER_H_
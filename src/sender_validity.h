@@ -0,0 +1,59 @@
+#ifndef HALMET_SRC_SENDER_VALIDITY_H_
+#define HALMET_SRC_SENDER_VALIDITY_H_
+
+#include <math.h>
+
+namespace halmet {
+
+/// Result of checking a resistive sender reading. The values are the fault
+/// codes published to Signal K.
+enum class SenderFault : int {
+  kValid = 0,
+  kOpen = 1,        // wire break or unplugged sender
+  kShort = 2,       // sender or wire shorted to ground
+  kOutOfRange = 3,  // between the normal range and the open/short limits
+};
+
+/**
+ * @brief Plausible resistance range of a sender, in ohms.
+ *
+ * Readings at or above open_ohms are an open circuit, readings at or below
+ * short_ohms a short. Anything else outside [min_ohms, max_ohms] is out of
+ * range. Set short_ohms to -INFINITY for senders whose normal range starts
+ * at 0 ohms, where a short cannot be told from a valid reading.
+ */
+struct SenderLimits {
+  float short_ohms;
+  float min_ohms;
+  float max_ohms;
+  float open_ohms;
+};
+
+// No checks; every reading is valid
+constexpr SenderLimits kNoSenderLimits = {-INFINITY, -INFINITY, INFINITY,
+                                          INFINITY};
+// 0-190 ohm tank sender. Small negative readings are ADC noise at empty.
+constexpr SenderLimits kTankSenderLimits = {-INFINITY, -5, 220, 1000};
+// NTC coolant sender, about 23 ohms at 120 C and 2 kohm near 0 C
+constexpr SenderLimits kTemperatureSenderLimits = {3, 10, 2500, 3000};
+// 10-184 ohm oil pressure sender (0-5 bar)
+constexpr SenderLimits kOilPressureSenderLimits = {3, 5, 220, 1000};
+
+/// Classify a sender resistance. Valid readings take three comparisons.
+inline SenderFault ClassifySenderResistance(float ohms,
+                                            const SenderLimits& limits) {
+  if (ohms >= limits.min_ohms && ohms <= limits.max_ohms) {
+    return SenderFault::kValid;
+  }
+  if (ohms >= limits.open_ohms) {
+    return SenderFault::kOpen;
+  }
+  if (ohms <= limits.short_ohms) {
+    return SenderFault::kShort;
+  }
+  return SenderFault::kOutOfRange;
+}
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_SENDER_VALIDITY_H_
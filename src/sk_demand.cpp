@@ -0,0 +1,42 @@
+#include "sk_demand.h"
+
+namespace halmet {
+
+static bool signalk_demand = true;
+
+static SKDemandGateBase* first_gate = nullptr;
+
+bool SignalKDemand() { return signalk_demand; }
+
+void SetSignalKDemand(bool demand) {
+  bool returned = demand && !signalk_demand;
+  signalk_demand = demand;
+  if (returned) {
+    SKDemandGateBase::release_all();
+  }
+}
+
+SKDemandGateBase::SKDemandGateBase() : next_{first_gate} {
+  first_gate = this;
+}
+
+SKDemandGateBase::~SKDemandGateBase() {
+  for (SKDemandGateBase** link = &first_gate; *link != nullptr;
+       link = &(*link)->next_) {
+    if (*link == this) {
+      *link = next_;
+      break;
+    }
+  }
+}
+
+void SKDemandGateBase::release_all() {
+  for (SKDemandGateBase* gate = first_gate; gate != nullptr;
+       gate = gate->next_) {
+    if (gate->withheld_) {
+      gate->release();
+    }
+  }
+}
+
+}  // namespace halmet
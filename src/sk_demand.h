@@ -0,0 +1,77 @@
+#ifndef HALMET_SRC_SK_DEMAND_H_
+#define HALMET_SRC_SK_DEMAND_H_
+
+#include "allocation_scope.h"
+#include "sensesp/transforms/transform.h"
+
+namespace halmet {
+
+/// True while Signal K output is consumed, i.e. the server connection is
+/// up. True until SetSignalKDemand() is first called.
+bool SignalKDemand();
+/// When demand returns, every gate that withheld a value emits its latest.
+void SetSignalKDemand(bool demand);
+
+/**
+ * @brief The part of an SKDemandGate that does not depend on the value type.
+ *
+ * All gates are kept in one list, so that SetSignalKDemand() can release
+ * the values they withheld.
+ */
+class SKDemandGateBase {
+ public:
+  static void release_all();
+
+ protected:
+  SKDemandGateBase();
+  ~SKDemandGateBase();
+
+  virtual void release() = 0;
+
+  bool withheld_ = false;
+
+ private:
+  SKDemandGateBase* next_ = nullptr;
+};
+
+/**
+ * @brief Pass values on only while there is Signal K demand.
+ *
+ * Place the gate where a value leaves the part of the graph that N2k and
+ * the display need, in front of the transforms and outputs that only feed
+ * Signal K. While the server is not connected, those transforms do not
+ * run and no delta is queued or serialized. The latest value is held and
+ * emitted when the connection comes back, so values that are only emitted
+ * when they change, such as sender fault codes, are not lost.
+ */
+template <typename T>
+class SKDemandGate : public sensesp::SymmetricTransform<T>,
+                     public SKDemandGateBase {
+ public:
+  SKDemandGate() : sensesp::SymmetricTransform<T>("") {}
+
+  void set(const T& input) override {
+    if (SignalKDemand()) {
+      // Queueing the delta allocates; that is not counted as sample code
+      AllocationScope allocation_scope(AllocationSource::kSignalK);
+      withheld_ = false;
+      this->emit(input);
+    } else {
+      held_ = input;
+      withheld_ = true;
+    }
+  }
+
+ protected:
+  void release() override {
+    AllocationScope allocation_scope(AllocationSource::kSignalK);
+    withheld_ = false;
+    this->emit(held_);
+  }
+
+  T held_{};
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_SK_DEMAND_H_
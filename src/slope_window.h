@@ -0,0 +1,87 @@
+#ifndef HALMET_SRC_SLOPE_WINDOW_H_
+#define HALMET_SRC_SLOPE_WINDOW_H_
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+
+namespace halmet {
+
+/**
+ * @brief Robust slope over the last N samples of a time series.
+ *
+ * Samples are kept in a fixed ring buffer. slope() returns the Theil-Sen
+ * estimate, i.e. the median of the slopes between all sample pairs, which
+ * ignores up to about 29% outliers. With N samples this takes N*(N-1)/2
+ * divisions and one partial sort of as many values, independent of the
+ * sample values. No memory is allocated.
+ *
+ * @tparam N Window size in samples.
+ */
+template <size_t N>
+class SlopeWindow {
+  static_assert(N >= 2, "N must be at least 2");
+
+ public:
+  /// Append a sample, replacing the oldest one if the window is full.
+  /// Times are in ms and may wrap around.
+  void add(uint32_t time_ms, float value) {
+    size_t index = (first_ + size_) % N;
+    if (size_ == N) {
+      first_ = (first_ + 1) % N;
+    } else {
+      size_++;
+    }
+    times_[index] = time_ms;
+    values_[index] = value;
+  }
+
+  void clear() {
+    first_ = 0;
+    size_ = 0;
+  }
+
+  size_t size() const { return size_; }
+  bool full() const { return size_ == N; }
+
+  /// Most recent value, or NAN if the window is empty.
+  float latest() const {
+    return size_ == 0 ? NAN : values_[(first_ + size_ - 1) % N];
+  }
+
+  /// Median pairwise slope in value units per hour, or NAN with fewer than
+  /// two samples.
+  float slope() {
+    size_t count = 0;
+    for (size_t i = 0; i < size_; i++) {
+      size_t a = (first_ + i) % N;
+      for (size_t j = i + 1; j < size_; j++) {
+        size_t b = (first_ + j) % N;
+        uint32_t dt_ms = times_[b] - times_[a];
+        if (dt_ms == 0) {
+          continue;
+        }
+        slopes_[count++] = (values_[b] - values_[a]) * 3600000.0f / dt_ms;
+      }
+    }
+    if (count == 0) {
+      return NAN;
+    }
+    float* median = slopes_ + count / 2;
+    std::nth_element(slopes_, median, slopes_ + count);
+    return *median;
+  }
+
+ protected:
+  uint32_t times_[N];
+  float values_[N];
+  float slopes_[N * (N - 1) / 2];
+  size_t first_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_SLOPE_WINDOW_H_
@@ -0,0 +1,77 @@
+#ifndef HALMET_SRC_SPSC_QUEUE_H_
+#define HALMET_SRC_SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+
+namespace halmet {
+
+/**
+ * @brief Lock-free single-producer single-consumer ring buffer.
+ *
+ * One task may call push() and one other task may call pop(), each without
+ * locking. Storage is fixed at compile time; push() fails instead of
+ * allocating when the queue is full.
+ *
+ * @tparam T Element type. Elements are copied in and out.
+ * @tparam N Capacity. Must be a power of two.
+ */
+template <typename T, size_t N>
+class SpscQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+ public:
+  /// Producer side. Returns false if the queue is full.
+  bool push(const T& item) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t tail = tail_.load(std::memory_order_acquire);
+    if (head - tail == N) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    buffer_[head & (N - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    size_t used = head + 1 - tail;
+    if (used > high_water_mark_.load(std::memory_order_relaxed)) {
+      high_water_mark_.store(used, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  /// Consumer side. Returns false if the queue is empty.
+  bool pop(T& item) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    if (head == tail) {
+      return false;
+    }
+    item = buffer_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const {
+    return head_.load(std::memory_order_acquire) -
+           tail_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+  static constexpr size_t capacity() { return N; }
+
+  /// Largest number of queued elements seen by the producer.
+  size_t high_water_mark() const {
+    return high_water_mark_.load(std::memory_order_relaxed);
+  }
+  /// Number of push() calls rejected because the queue was full.
+  size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  T buffer_[N];
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+  std::atomic<size_t> high_water_mark_{0};
+  std::atomic<size_t> dropped_{0};
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_SPSC_QUEUE_H_
@@ -0,0 +1,58 @@
+#ifndef HALMET_SRC_STATIC_ARENA_H_
+#define HALMET_SRC_STATIC_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace halmet {
+
+/**
+ * @brief Bump allocator over a fixed, caller-provided buffer.
+ *
+ * Allocations are never freed individually. This matches the lifetime of the
+ * sensor graph built in setup(), which is kept alive until the next reboot.
+ * The class has no Arduino dependencies so that arena usage can also be
+ * computed in a host build.
+ */
+class StaticArena {
+ public:
+  StaticArena(uint8_t* buffer, size_t capacity)
+      : buffer_{buffer}, capacity_{capacity} {}
+
+  /// Return a block of the requested size and alignment, or nullptr if the
+  /// arena does not have enough space left.
+  void* allocate(size_t size, size_t alignment) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(buffer_);
+    uintptr_t aligned = (base + used_ + alignment - 1) & ~(alignment - 1);
+    size_t offset = aligned - base;
+    if (offset + size > capacity_) {
+      overflowed_ = true;
+      return nullptr;
+    }
+    used_ = offset + size;
+    allocation_count_++;
+    return buffer_ + offset;
+  }
+
+  bool contains(const void* ptr) const {
+    auto p = static_cast<const uint8_t*>(ptr);
+    return p >= buffer_ && p < buffer_ + capacity_;
+  }
+
+  size_t capacity() const { return capacity_; }
+  size_t used() const { return used_; }
+  size_t remaining() const { return capacity_ - used_; }
+  size_t allocation_count() const { return allocation_count_; }
+  bool overflowed() const { return overflowed_; }
+
+ private:
+  uint8_t* buffer_;
+  size_t capacity_;
+  size_t used_ = 0;
+  size_t allocation_count_ = 0;
+  bool overflowed_ = false;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_STATIC_ARENA_H_
@@ -0,0 +1,120 @@
+#include "system_diagnostics.h"
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+#include "graph_arena.h"
+#include "i2c_bus.h"
+#include "sensesp/signalk/signalk_output.h"
+#include "sensesp/ui/status_page_item.h"
+#include "sensesp_base_app.h"
+#include "throttle.h"
+
+namespace halmet {
+
+SystemDiagnostics::SystemDiagnostics(unsigned int sample_interval) {
+  last_sample_ms_ = millis();
+  sensesp::event_loop()->onTick([this]() { this->ticks_++; });
+  sensesp::event_loop()->onRepeat(sample_interval,
+                                  [this]() { this->sample(); });
+}
+
+sensesp::ObservableValue<int>* SystemDiagnostics::add_task(const char* name) {
+  if (num_tasks_ >= kMaxTasks) {
+    debugE("SystemDiagnostics: Too many tasks, %s is not reported", name);
+    return nullptr;
+  }
+  Task& task = tasks_[num_tasks_++];
+  task.name = name;
+  return &task.stack_free_;
+}
+
+void SystemDiagnostics::sample() {
+  free_heap_.set(esp_get_free_heap_size());
+  largest_free_block_.set(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+  min_free_heap_.set(esp_get_minimum_free_heap_size());
+
+  timed_events_.set(sensesp::event_loop()->getTimedEventQueueSize());
+  untimed_events_.set(sensesp::event_loop()->getUntimedEventQueueSize());
+  graph_nodes_.set(GraphNodeCount());
+  graph_bytes_.set(GraphNodeBytes());
+  ads1115_errors_.set(ADS1115Guard().errors());
+  display_errors_.set(DisplayGuard().errors());
+  throttle_dropped_.set(ThrottleBase::total_dropped());
+  throttle_coalesced_.set(ThrottleBase::total_coalesced());
+
+  uint32_t now = millis();
+  if (now != last_sample_ms_) {
+    loop_rate_.set(1000.0f * ticks_ / (now - last_sample_ms_));
+  }
+  ticks_ = 0;
+  last_sample_ms_ = now;
+
+  for (size_t i = 0; i < num_tasks_; i++) {
+    TaskHandle_t handle = xTaskGetHandle(tasks_[i].name);
+    if (handle != nullptr) {
+      // On the ESP32, the high-water mark is in bytes
+      tasks_[i].stack_free_.set(uxTaskGetStackHighWaterMark(handle));
+    }
+  }
+}
+
+template <typename T>
+static void ConnectDiagnostic(sensesp::ObservableValue<T>* value,
+                              const String& name, const String& sk_id,
+                              const char* units, int sort_order,
+                              bool enable_signalk_output) {
+  value->connect_to(GraphNew<sensesp::StatusPageItem<T>>(
+      name, T(), "Diagnostics", sort_order));
+  if (enable_signalk_output) {
+    value->connect_to(GraphNew<sensesp::SKOutput<T>>(
+        "sensors.halmet.diagnostics." + sk_id, "",
+        GraphNew<sensesp::SKMetadata>(units, name)));
+  }
+}
+
+SystemDiagnostics* ConnectSystemDiagnostics(bool enable_signalk_output) {
+  auto diagnostics = GraphNew<SystemDiagnostics>();
+  diagnostics->add_task("loopTask");
+  diagnostics->add_task("n2k");
+  // The receive wake-up task of HalmetNMEA2000::enable_rx_interrupt()
+  diagnostics->add_task("n2k_rx");
+  diagnostics->add_task("datalog");
+  diagnostics->add_task("httpd");
+
+  ConnectDiagnostic(&diagnostics->free_heap_, "Free heap", "freeHeap", "B",
+                    2000, enable_signalk_output);
+  ConnectDiagnostic(&diagnostics->largest_free_block_, "Largest free block",
+                    "largestFreeBlock", "B", 2001, enable_signalk_output);
+  ConnectDiagnostic(&diagnostics->min_free_heap_, "Minimum free heap",
+                    "minFreeHeap", "B", 2002, enable_signalk_output);
+  ConnectDiagnostic(&diagnostics->loop_rate_, "Loop rate", "loopRate", "Hz",
+                    2003, enable_signalk_output);
+  ConnectDiagnostic(&diagnostics->timed_events_, "Timed events",
+                    "timedEvents", "", 2004, enable_signalk_output);
+  ConnectDiagnostic(&diagnostics->untimed_events_, "Untimed events",
+                    "untimedEvents", "", 2005, enable_signalk_output);
+  ConnectDiagnostic(&diagnostics->graph_nodes_, "Graph nodes", "graphNodes",
+                    "", 2006, enable_signalk_output);
+  ConnectDiagnostic(&diagnostics->graph_bytes_, "Graph node bytes",
+                    "graphBytes", "B", 2007, enable_signalk_output);
+  ConnectDiagnostic(&diagnostics->ads1115_errors_, "ADS1115 I2C errors",
+                    "i2cErrors.ads1115", "", 2008, enable_signalk_output);
+  ConnectDiagnostic(&diagnostics->display_errors_, "Display I2C errors",
+                    "i2cErrors.display", "", 2009, enable_signalk_output);
+  ConnectDiagnostic(&diagnostics->throttle_dropped_, "Throttle dropped",
+                    "throttle.dropped", "", 2016, enable_signalk_output);
+  ConnectDiagnostic(&diagnostics->throttle_coalesced_, "Throttle coalesced",
+                    "throttle.coalesced", "", 2017, enable_signalk_output);
+  for (size_t i = 0; i < diagnostics->num_tasks_; i++) {
+    auto& task = diagnostics->tasks_[i];
+    ConnectDiagnostic(&task.stack_free_,
+                      String("Stack free, ") + task.name,
+                      String("stackFree.") + task.name, "B", 2010 + i,
+                      enable_signalk_output);
+  }
+
+  return diagnostics;
+}
+
+}  // namespace halmet
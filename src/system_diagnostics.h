@@ -0,0 +1,65 @@
+#ifndef HALMET_SRC_SYSTEM_DIAGNOSTICS_H_
+#define HALMET_SRC_SYSTEM_DIAGNOSTICS_H_
+
+#include "sensesp/system/observablevalue.h"
+
+namespace halmet {
+
+/**
+ * @brief Heap, stack and event loop statistics.
+ *
+ * All values are sampled every sample_interval ms from counters that
+ * FreeRTOS, the heap allocator and the event loop keep anyway; only the
+ * loop rate needs a counter of its own. Stack values are the smallest
+ * number of bytes that have been left free on the stack of each task
+ * since it started. Tasks that do not exist are skipped.
+ */
+class SystemDiagnostics {
+ public:
+  static const size_t kMaxTasks = 6;
+
+  explicit SystemDiagnostics(unsigned int sample_interval = 10000);
+
+  /// Report the stack high-water mark of the FreeRTOS task of this name.
+  /// name must stay valid.
+  sensesp::ObservableValue<int>* add_task(const char* name);
+
+  sensesp::ObservableValue<int> free_heap_;           // bytes
+  sensesp::ObservableValue<int> largest_free_block_;  // bytes
+  sensesp::ObservableValue<int> min_free_heap_;       // bytes since boot
+  sensesp::ObservableValue<int> timed_events_;    // onRepeat/onDelay events
+  sensesp::ObservableValue<int> untimed_events_;  // onTick and others
+  sensesp::ObservableValue<int> graph_nodes_;     // created with GraphNew()
+  sensesp::ObservableValue<int> graph_bytes_;
+  sensesp::ObservableValue<float> loop_rate_;  // Hz
+  sensesp::ObservableValue<int> ads1115_errors_;  // failed I2C transactions
+  sensesp::ObservableValue<int> display_errors_;
+  sensesp::ObservableValue<int> throttle_dropped_;    // over all Throttles
+  sensesp::ObservableValue<int> throttle_coalesced_;
+
+  struct Task {
+    const char* name;
+    sensesp::ObservableValue<int> stack_free_;  // bytes
+  };
+  Task tasks_[kMaxTasks];
+  size_t num_tasks_ = 0;
+
+ protected:
+  void sample();
+
+  uint32_t ticks_ = 0;
+  uint32_t last_sample_ms_ = 0;
+};
+
+/**
+ * @brief Create the diagnostics and connect them to the outputs.
+ *
+ * The values are shown in a Diagnostics group on the web UI status page
+ * and, if enable_signalk_output is set, published under
+ * sensors.halmet.diagnostics.
+ */
+SystemDiagnostics* ConnectSystemDiagnostics(bool enable_signalk_output = true);
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_SYSTEM_DIAGNOSTICS_H_
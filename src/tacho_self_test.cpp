@@ -0,0 +1,170 @@
+#include "tacho_self_test.h"
+
+#include <Arduino.h>
+
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+static bool self_test_running = false;
+
+bool TachoSelfTestRunning() { return self_test_running; }
+
+TachoSelfTest::TachoSelfTest(sensesp::Frequency* tacho,
+                             N2kEngineParameterRapidSender* rapid_sender,
+                             int ledc_channel, float idle_hz, float min_rpm,
+                             float max_rpm, size_t steps)
+    : engine_speed_{[this](double hz) {
+        this->sweep_.observe(millis(), hz);
+        this->tick();
+      }},
+      tacho_{tacho},
+      rapid_sender_{rapid_sender},
+      ledc_channel_{ledc_channel},
+      idle_hz_{idle_hz},
+      min_rpm_{min_rpm},
+      max_rpm_{max_rpm},
+      steps_{steps} {
+  rapid_sender_->engine_speed_.connect_to(&engine_speed_);
+  sensesp::event_loop()->onRepeat(100, [this]() {
+    if (this->start_requested_) {
+      this->start_requested_ = false;
+      this->start();
+    }
+    this->sweep_.tick(millis());
+    this->tick();
+  });
+}
+
+bool TachoSelfTest::start() {
+  if (active_) {
+    return false;
+  }
+  // The expected values follow the multiplier set in the web UI
+  JsonDocument doc;
+  JsonObject config = doc.to<JsonObject>();
+  tacho_->to_json(config);
+  float multiplier = config["multiplier"] | 1.0f;
+
+  sweep_ = TachoSweep(multiplier);
+  sweep_.add_rpm_range(min_rpm_, max_rpm_, steps_);
+  logged_ = 0;
+  debugI("Tacho self-test: %u steps from %.0f to %.0f rpm", steps_, min_rpm_,
+         max_rpm_);
+  sweep_.start(millis());
+  set_output(sweep_.output_hz());
+  active_ = true;
+  self_test_running = true;
+  rapid_sender_->set_suppressed(true);
+  return true;
+}
+
+void TachoSelfTest::finish() {
+  set_output(idle_hz_);
+  active_ = false;
+  self_test_running = false;
+  rapid_sender_->set_suppressed(false);
+  debugI("Tacho self-test finished; results at /tacho_test");
+}
+
+void TachoSelfTest::tick() {
+  // Log the steps completed since the last call, then follow the sweep
+  while (logged_ < sweep_.num_results() &&
+         (logged_ + 1 < sweep_.num_results() || !sweep_.running())) {
+    log_result(logged_++);
+  }
+  if (!active_) {
+    return;
+  }
+  if (!sweep_.running()) {
+    finish();
+  } else if (sweep_.output_hz() != output_hz_) {
+    set_output(sweep_.output_hz());
+  }
+}
+
+void TachoSelfTest::set_output(float hz) {
+  ledcChangeFrequency(ledc_channel_, hz, kLEDCResolution);
+  output_hz_ = hz;
+}
+
+void TachoSelfTest::log_result(size_t i) {
+  const TachoSweepResult& result = sweep_.result(i);
+  if (!result.settled) {
+    debugW("Tacho self-test: %.1f Hz did not settle within %u ms",
+           result.output_hz, result.settle_ms);
+    return;
+  }
+  debugI("Tacho self-test: %.1f Hz, expected %.3f, measured %.3f (%+.2f%%), "
+         "settled in %u ms",
+         result.output_hz, result.expected_hz, result.measured_hz,
+         100 * result.error, result.settle_ms);
+}
+
+esp_err_t TachoSelfTest::handle_start(httpd_req_t* req) {
+  if (active_ || start_requested_) {
+    httpd_resp_set_status(req, "409 Conflict");
+    return httpd_resp_sendstr(req, "A tacho self-test is already running\n");
+  }
+  // The HTTP server runs on its own task; the sweep is started by the next
+  // timer tick on the event loop.
+  start_requested_ = true;
+  // Back to the results page, which follows the sweep
+  httpd_resp_set_status(req, "303 See Other");
+  httpd_resp_set_hdr(req, "Location", "/tacho_test");
+  return httpd_resp_send(req, nullptr, 0);
+}
+
+esp_err_t TachoSelfTest::handle_results(httpd_req_t* req) {
+  httpd_resp_set_type(req, "text/html");
+  httpd_resp_sendstr_chunk(
+      req,
+      "<!DOCTYPE html><html><head><title>Tacho self-test</title>");
+  bool running = active_ || start_requested_;
+  if (running) {
+    httpd_resp_sendstr_chunk(req,
+                             "<meta http-equiv=\"refresh\" content=\"2\">");
+  }
+  httpd_resp_sendstr_chunk(
+      req,
+      "</head><body><h1>Tacho self-test</h1>"
+      "<p>Wire the test output to the tacho input before starting. Engine "
+      "hours and the rapid engine PGN are paused during the sweep.</p>"
+      "<form method=\"post\" action=\"/tacho_test/start\">"
+      "<button type=\"submit\"");
+  httpd_resp_sendstr_chunk(req, running ? " disabled>Running" : ">Start sweep");
+  httpd_resp_sendstr_chunk(
+      req,
+      "</button></form><table border=\"1\"><tr>"
+      "<th>Output (Hz)</th><th>rpm</th><th>Expected (Hz)</th>"
+      "<th>Measured (Hz)</th><th>Error (%)</th><th>Settling (ms)</th></tr>");
+  char row[200];
+  for (size_t i = 0; i < sweep_.num_results(); i++) {
+    const TachoSweepResult& result = sweep_.result(i);
+    if (sweep_.running() && i + 1 == sweep_.num_results()) {
+      snprintf(row, sizeof(row),
+               "<tr><td>%.1f</td><td>%.0f</td><td>%.3f</td>"
+               "<td colspan=\"3\">running</td></tr>",
+               result.output_hz, 60 * result.expected_hz,
+               result.expected_hz);
+    } else if (!result.settled) {
+      snprintf(row, sizeof(row),
+               "<tr><td>%.1f</td><td>%.0f</td><td>%.3f</td>"
+               "<td colspan=\"2\">not settled</td><td>&gt;%u</td></tr>",
+               result.output_hz, 60 * result.expected_hz,
+               result.expected_hz, result.settle_ms);
+    } else {
+      snprintf(row, sizeof(row),
+               "<tr><td>%.1f</td><td>%.0f</td><td>%.3f</td><td>%.3f</td>"
+               "<td>%+.2f</td><td>%u</td></tr>",
+               result.output_hz, 60 * result.expected_hz,
+               result.expected_hz, result.measured_hz, 100 * result.error,
+               result.settle_ms);
+    }
+    httpd_resp_sendstr_chunk(req, row);
+  }
+  httpd_resp_sendstr_chunk(req, "</table></body></html>");
+  return httpd_resp_sendstr_chunk(req, nullptr);
+}
+
+}  // namespace halmet
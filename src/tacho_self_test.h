@@ -0,0 +1,77 @@
+#ifndef HALMET_SRC_TACHO_SELF_TEST_H_
+#define HALMET_SRC_TACHO_SELF_TEST_H_
+
+#include <esp_http_server.h>
+
+#include <atomic>
+
+#include "n2k_senders.h"
+#include "sensesp/system/lambda_consumer.h"
+#include "sensesp/transforms/frequency.h"
+#include "tacho_sweep.h"
+
+namespace halmet {
+
+/// True while a TachoSelfTest drives the tacho input with the test signal.
+/// Inputs that must not count the test signal, such as the engine hours,
+/// check this.
+bool TachoSelfTestRunning();
+
+/**
+ * @brief Closed-loop test of the tacho input using the LEDC test output.
+ *
+ * With the test output pin wired to the tacho input, start() sweeps the
+ * LEDC frequency over an rpm range and records, for each step, how long
+ * the value at the rapid sender's engine_speed_ takes to settle and how far
+ * it is off. The expected value uses the tacho's configured multiplier.
+ * Afterwards the test output returns to idle_hz. The rapid sender's PGN is
+ * suppressed while the sweep runs, so the test signal is not broadcast as
+ * the engine speed.
+ *
+ * The sweep only runs on request: handle_start() starts it from an HTTP
+ * POST, and handle_results() serves the table and a start button as an
+ * HTML page. Each step is also logged as it completes.
+ */
+class TachoSelfTest {
+ public:
+  TachoSelfTest(sensesp::Frequency* tacho,
+                N2kEngineParameterRapidSender* rapid_sender, int ledc_channel,
+                float idle_hz, float min_rpm = 600, float max_rpm = 3600,
+                size_t steps = 6);
+
+  /// Start a sweep. Returns false if one is already running.
+  bool start();
+
+  esp_err_t handle_results(httpd_req_t* req);
+  esp_err_t handle_start(httpd_req_t* req);
+
+ protected:
+  static const uint32_t kLEDCResolution = 13;
+
+  void tick();
+  void finish();
+  void set_output(float hz);
+  void log_result(size_t i);
+
+  // Connected to the rapid sender's engine_speed_ (Hz)
+  sensesp::LambdaConsumer<double> engine_speed_;
+
+  sensesp::Frequency* tacho_;
+  N2kEngineParameterRapidSender* rapid_sender_;
+  int ledc_channel_;
+  float idle_hz_;
+  float min_rpm_;
+  float max_rpm_;
+  size_t steps_;
+
+  TachoSweep sweep_{1};
+  // Set by the HTTP server task, cleared by the event loop
+  std::atomic<bool> start_requested_{false};
+  bool active_ = false;
+  float output_hz_ = 0;
+  size_t logged_ = 0;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_TACHO_SELF_TEST_H_
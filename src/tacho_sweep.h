@@ -0,0 +1,144 @@
+#ifndef HALMET_SRC_TACHO_SWEEP_H_
+#define HALMET_SRC_TACHO_SWEEP_H_
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace halmet {
+
+/// Outcome of one frequency step of a TachoSweep
+struct TachoSweepResult {
+  float output_hz;    // test signal frequency
+  float expected_hz;  // output_hz times the tacho multiplier
+  float measured_hz;  // mean of the samples after settling
+  float error;        // (measured - expected) / expected
+  uint32_t settle_ms;  // from the frequency change to the first good sample
+  bool settled;        // false if the step timed out
+};
+
+/**
+ * @brief Step a test frequency through a range and time the tacho response.
+ *
+ * For each step, the caller sets the test output to output_hz() and feeds
+ * every tacho value to observe(). A step settles at the first sample within
+ * tolerance of the expected value; that delay is its latency. The next
+ * hold_samples samples are averaged for the accuracy figure. A step that
+ * has not settled after timeout_ms, checked in tick(), is recorded as not
+ * settled.
+ *
+ * Times are passed in, so the class does not depend on the Arduino core.
+ */
+class TachoSweep {
+ public:
+  static const size_t kMaxSteps = 16;
+
+  TachoSweep(float multiplier, float tolerance = 0.02,
+             uint32_t timeout_ms = 10000, size_t hold_samples = 4)
+      : multiplier_{multiplier},
+        tolerance_{tolerance},
+        timeout_ms_{timeout_ms},
+        hold_samples_{hold_samples} {}
+
+  bool add_step(float output_hz) {
+    if (num_steps_ >= kMaxSteps) {
+      return false;
+    }
+    steps_[num_steps_++] = output_hz;
+    return true;
+  }
+
+  /// Add steps evenly spaced in engine rpm, both ends included.
+  void add_rpm_range(float min_rpm, float max_rpm, size_t steps) {
+    for (size_t i = 0; i < steps; i++) {
+      float rpm = steps > 1 ? min_rpm + (max_rpm - min_rpm) * i / (steps - 1)
+                            : min_rpm;
+      add_step(rpm / 60 / multiplier_);
+    }
+  }
+
+  void start(uint32_t now_ms) {
+    num_results_ = 0;
+    current_ = 0;
+    begin_step(now_ms);
+  }
+
+  bool running() const { return current_ < num_steps_; }
+
+  /// Test output frequency for the current step, 0 when done.
+  float output_hz() const { return running() ? steps_[current_] : 0; }
+
+  void observe(uint32_t now_ms, float measured_hz) {
+    if (!running()) {
+      return;
+    }
+    TachoSweepResult& result = results_[current_];
+    if (!result.settled) {
+      if (fabsf(measured_hz - result.expected_hz) >
+          tolerance_ * result.expected_hz) {
+        tick(now_ms);
+        return;
+      }
+      result.settled = true;
+      result.settle_ms = now_ms - step_start_ms_;
+      return;
+    }
+    hold_sum_ += measured_hz;
+    if (++hold_count_ >= hold_samples_) {
+      result.measured_hz = hold_sum_ / hold_count_;
+      result.error =
+          (result.measured_hz - result.expected_hz) / result.expected_hz;
+      next_step(now_ms);
+    }
+  }
+
+  /// Check the settling timeout of the current step.
+  void tick(uint32_t now_ms) {
+    if (!running() || results_[current_].settled ||
+        now_ms - step_start_ms_ < timeout_ms_) {
+      return;
+    }
+    results_[current_].settle_ms = now_ms - step_start_ms_;
+    next_step(now_ms);
+  }
+
+  size_t num_results() const { return num_results_; }
+  const TachoSweepResult& result(size_t i) const { return results_[i]; }
+
+ protected:
+  void begin_step(uint32_t now_ms) {
+    if (!running()) {
+      return;
+    }
+    step_start_ms_ = now_ms;
+    hold_sum_ = 0;
+    hold_count_ = 0;
+    float expected = steps_[current_] * multiplier_;
+    results_[current_] = {steps_[current_], expected, NAN, NAN, 0, false};
+    num_results_ = current_ + 1;
+  }
+
+  void next_step(uint32_t now_ms) {
+    current_++;
+    begin_step(now_ms);
+  }
+
+  float multiplier_;
+  float tolerance_;
+  uint32_t timeout_ms_;
+  size_t hold_samples_;
+
+  float steps_[kMaxSteps];
+  size_t num_steps_ = 0;
+  TachoSweepResult results_[kMaxSteps];
+  size_t num_results_ = 0;
+  size_t current_ = kMaxSteps;  // not started
+
+  uint32_t step_start_ms_ = 0;
+  float hold_sum_ = 0;
+  size_t hold_count_ = 0;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_TACHO_SWEEP_H_
@@ -0,0 +1,73 @@
+#include "throttle.h"
+
+#include "allocation_scope.h"
+
+namespace halmet {
+
+// Poll interval of a throttle, as a fraction of its interval
+static const unsigned int kPollDivisor = 4;
+static const unsigned int kMinPollInterval = 10;  // ms
+
+static ThrottleBase* first_throttle = nullptr;
+static reactesp::RepeatEvent* poll_event = nullptr;
+static unsigned int poll_interval = 0;
+
+ThrottleBase::ThrottleBase(unsigned int interval_ms, unsigned int max_wait_ms)
+    : timing_{interval_ms, max_wait_ms} {
+  next_ = first_throttle;
+  first_throttle = this;
+
+  unsigned int interval = interval_ms / kPollDivisor;
+  if (interval < kMinPollInterval) {
+    interval = kMinPollInterval;
+  }
+  if (poll_event != nullptr && interval >= poll_interval) {
+    return;
+  }
+  if (poll_event != nullptr) {
+    poll_event->remove(sensesp::event_loop());
+  }
+  poll_interval = interval;
+  poll_event = sensesp::event_loop()->onRepeat(poll_interval, poll_all);
+}
+
+ThrottleBase::~ThrottleBase() {
+  for (ThrottleBase** link = &first_throttle; *link != nullptr;
+       link = &(*link)->next_) {
+    if (*link == this) {
+      *link = next_;
+      break;
+    }
+  }
+}
+
+void ThrottleBase::poll_all() {
+  AllocationScope allocation_scope(AllocationSource::kSample);
+  uint32_t now = millis();
+  for (ThrottleBase* throttle = first_throttle; throttle != nullptr;
+       throttle = throttle->next_) {
+    if (throttle->timing_.poll(now)) {
+      throttle->emit_held();
+    }
+  }
+}
+
+uint32_t ThrottleBase::total_dropped() {
+  uint32_t total = 0;
+  for (ThrottleBase* throttle = first_throttle; throttle != nullptr;
+       throttle = throttle->next_) {
+    total += throttle->dropped();
+  }
+  return total;
+}
+
+uint32_t ThrottleBase::total_coalesced() {
+  uint32_t total = 0;
+  for (ThrottleBase* throttle = first_throttle; throttle != nullptr;
+       throttle = throttle->next_) {
+    total += throttle->coalesced();
+  }
+  return total;
+}
+
+}  // namespace halmet
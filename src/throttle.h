@@ -0,0 +1,78 @@
+#ifndef HALMET_SRC_THROTTLE_H_
+#define HALMET_SRC_THROTTLE_H_
+
+#include <Arduino.h>
+
+#include "sensesp/transforms/transform.h"
+#include "sensesp_base_app.h"
+#include "throttle_timing.h"
+
+namespace halmet {
+
+/**
+ * @brief The part of a Throttle that does not depend on the value type.
+ *
+ * All throttles are kept in one list, and their trailing edges are checked
+ * by a single repeating event every quarter of the shortest interval. The
+ * dropped and coalesced totals over all throttles are reported by
+ * SystemDiagnostics.
+ */
+class ThrottleBase {
+ public:
+  /// Inputs replaced by a newer one before they were emitted
+  uint32_t dropped() const { return timing_.dropped(); }
+  /// Held inputs emitted on a trailing edge or after the maximum wait
+  uint32_t coalesced() const { return timing_.coalesced(); }
+
+  static uint32_t total_dropped();
+  static uint32_t total_coalesced();
+
+ protected:
+  ThrottleBase(unsigned int interval_ms, unsigned int max_wait_ms);
+  ~ThrottleBase();
+
+  virtual void emit_held() = 0;
+
+  ThrottleTiming timing_;
+
+ private:
+  static void poll_all();
+
+  ThrottleBase* next_ = nullptr;
+};
+
+/**
+ * @brief Limit the rate of a value without losing the last one of a burst.
+ *
+ * The first input is passed on at once, later inputs within the quiet
+ * period are coalesced and the latest is emitted on the trailing edge; see
+ * ThrottleTiming. Unlike a drop-only rate limiter, the output never stays
+ * at a stale value once the input has moved on.
+ *
+ * The output lags the end of a burst by at most a quarter of the shortest
+ * throttle interval more than the quiet period. No memory is allocated per
+ * input.
+ */
+template <typename T>
+class Throttle : public sensesp::SymmetricTransform<T>, public ThrottleBase {
+ public:
+  Throttle(unsigned int interval_ms, unsigned int max_wait_ms = 0)
+      : sensesp::SymmetricTransform<T>(""),
+        ThrottleBase(interval_ms, max_wait_ms) {}
+
+  void set(const T& input) override {
+    held_ = input;
+    if (timing_.input(millis())) {
+      this->emit(held_);
+    }
+  }
+
+ protected:
+  void emit_held() override { this->emit(held_); }
+
+  T held_{};
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_THROTTLE_H_
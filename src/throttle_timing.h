@@ -0,0 +1,89 @@
+#ifndef HALMET_SRC_THROTTLE_TIMING_H_
+#define HALMET_SRC_THROTTLE_TIMING_H_
+
+#include <stdint.h>
+
+namespace halmet {
+
+/**
+ * @brief Timing of a throttle with leading and trailing edges.
+ *
+ * An input that arrives while the throttle is idle is emitted at once (the
+ * leading edge) and starts a quiet period of interval ms. Inputs during the
+ * quiet period are held, keeping only the latest, and each one extends the
+ * quiet period. The held input is emitted when the quiet period ends (the
+ * trailing edge), or when max_wait ms have passed since the last emission,
+ * whichever comes first. Each emission starts a new quiet period.
+ *
+ * max_wait defaults to interval, which gives at most one emission per
+ * interval and never holds a value for longer. A larger max_wait waits for
+ * the input to settle, but still guarantees an update every max_wait ms.
+ *
+ * dropped() counts inputs that were replaced by a newer one before they
+ * could be emitted, coalesced() the trailing and max-wait emissions.
+ *
+ * Times are passed in, so the class does not depend on the Arduino core.
+ */
+class ThrottleTiming {
+ public:
+  ThrottleTiming(uint32_t interval_ms, uint32_t max_wait_ms = 0)
+      : interval_{interval_ms},
+        max_wait_{max_wait_ms > interval_ms ? max_wait_ms : interval_ms} {}
+
+  /// Register an input at now_ms. Returns true if it is to be emitted now.
+  bool input(uint32_t now_ms) {
+    if (!active_) {
+      active_ = true;
+      start_quiet_period(now_ms);
+      return true;
+    }
+    if (pending_) {
+      dropped_++;
+    }
+    pending_ = true;
+    quiet_until_ = now_ms + interval_;
+    return poll(now_ms);
+  }
+
+  /// Returns true if the held input is to be emitted now. Call regularly.
+  bool poll(uint32_t now_ms) {
+    if (!active_) {
+      return false;
+    }
+    bool quiet = static_cast<int32_t>(now_ms - quiet_until_) >= 0;
+    if (pending_) {
+      if (quiet || now_ms - last_emit_ >= max_wait_) {
+        pending_ = false;
+        coalesced_++;
+        start_quiet_period(now_ms);
+        return true;
+      }
+    } else if (quiet) {
+      active_ = false;
+    }
+    return false;
+  }
+
+  bool pending() const { return pending_; }
+  uint32_t dropped() const { return dropped_; }
+  uint32_t coalesced() const { return coalesced_; }
+
+ protected:
+  void start_quiet_period(uint32_t now_ms) {
+    last_emit_ = now_ms;
+    quiet_until_ = now_ms + interval_;
+  }
+
+  uint32_t interval_;
+  uint32_t max_wait_;
+  bool active_ = false;
+  bool pending_ = false;
+  uint32_t last_emit_ = 0;
+  uint32_t quiet_until_ = 0;
+  uint32_t dropped_ = 0;
+  uint32_t coalesced_ = 0;
+};
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_THROTTLE_TIMING_H_
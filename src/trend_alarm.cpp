@@ -0,0 +1,95 @@
+#include "trend_alarm.h"
+
+#include <Arduino.h>
+
+#include "sensesp_base_app.h"
+
+namespace halmet {
+
+// A warning clears only when the projection is this much beyond the horizon
+static const float kWarningClearFactor = 1.25;
+
+TrendAlarm::TrendAlarm(const String& config_path, Direction direction,
+                       float threshold, float horizon_s,
+                       bool require_engine_running, unsigned int start_delay)
+    : sensesp::FileSystemSaveable{config_path},
+      input_{[this](float value) { this->update(value); }},
+      engine_frequency_{[this](float frequency) {
+        bool running = frequency > 0;
+        if (running && !this->engine_running_) {
+          this->running_since_ = millis();
+        } else if (!running && this->engine_running_ &&
+                   this->require_engine_running_) {
+          this->trend_.reset();
+          this->set_outputs(false, false);
+        }
+        this->engine_running_ = running;
+      }},
+      direction_{direction},
+      threshold_{threshold},
+      horizon_{horizon_s},
+      require_engine_running_{require_engine_running},
+      start_delay_{start_delay} {
+  load();
+}
+
+bool TrendAlarm::active() const {
+  if (!enabled_) {
+    return false;
+  }
+  if (!require_engine_running_) {
+    return true;
+  }
+  return engine_running_ && millis() - running_since_ >= start_delay_;
+}
+
+void TrendAlarm::update(float value) {
+  if (isnan(value)) {
+    // Invalid sender; its fault is reported separately
+    return;
+  }
+  if (!active()) {
+    trend_.reset();
+    set_outputs(false, false);
+    return;
+  }
+
+  trend_.add(millis(), value);
+  float level = trend_.level();
+  bool alarm =
+      direction_ == kRising ? level >= threshold_ : level <= threshold_;
+  float time_to = trend_.ready() ? trend_.time_to(threshold_) : INFINITY;
+  bool warning = alarm || time_to < horizon_ ||
+                 (warning_.get() && time_to < kWarningClearFactor * horizon_);
+  set_outputs(warning, alarm);
+}
+
+void TrendAlarm::set_outputs(bool warning, bool alarm) {
+  if (warning != warning_.get() || alarm != alarm_.get()) {
+    debugW("%s: warning %d, alarm %d, level %.2f, trend %.4f/s",
+           get_config_path().c_str(), warning, alarm, trend_.level(),
+           trend_.trend());
+  }
+  warning_.set(warning);
+  alarm_.set(alarm);
+}
+
+bool TrendAlarm::to_json(JsonObject& root) {
+  root["enabled"] = enabled_;
+  root["threshold"] = threshold_;
+  root["horizon"] = horizon_;
+  return true;
+}
+
+bool TrendAlarm::from_json(const JsonObject& config) {
+  if (!config["enabled"].is<bool>() || !config["threshold"].is<float>() ||
+      !config["horizon"].is<float>()) {
+    return false;
+  }
+  enabled_ = config["enabled"];
+  threshold_ = config["threshold"];
+  horizon_ = config["horizon"];
+  return true;
+}
+
+}  // namespace halmet
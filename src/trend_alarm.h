@@ -0,0 +1,77 @@
+#ifndef HALMET_SRC_TREND_ALARM_H_
+#define HALMET_SRC_TREND_ALARM_H_
+
+#include "holt_trend.h"
+#include "sensesp/system/lambda_consumer.h"
+#include "sensesp/system/observablevalue.h"
+#include "sensesp/system/saveable.h"
+
+namespace halmet {
+
+/**
+ * @brief Early warning for a value drifting towards a limit.
+ *
+ * The input is smoothed with HoltTrend. warning_ is set when the smoothed
+ * value is projected to reach the threshold within the horizon, or has
+ * reached it; alarm_ is set once it has reached it. Both are emitted for
+ * every input sample, so they can feed expiring N2k sender inputs
+ * directly. A warning clears when the projection is beyond 1.25 times the
+ * horizon again.
+ *
+ * With require_engine_running, samples are ignored and both outputs are
+ * false while the engine is stopped and for start_delay ms after it has
+ * started, e.g. while the oil pressure builds up.
+ */
+class TrendAlarm : public sensesp::FileSystemSaveable {
+ public:
+  enum Direction { kRising, kFalling };
+
+  TrendAlarm(const String& config_path, Direction direction, float threshold,
+             float horizon_s, bool require_engine_running = false,
+             unsigned int start_delay = 30000);
+
+  sensesp::LambdaConsumer<float> input_;
+  // Engine speed in Hz; only used with require_engine_running
+  sensesp::LambdaConsumer<float> engine_frequency_;
+
+  sensesp::ObservableValue<bool> warning_;
+  sensesp::ObservableValue<bool> alarm_;
+
+  virtual bool to_json(JsonObject& root) override;
+  virtual bool from_json(const JsonObject& config) override;
+
+ protected:
+  void update(float value);
+  void set_outputs(bool warning, bool alarm);
+  bool active() const;
+
+  Direction direction_;
+  float threshold_;
+  float horizon_;  // s
+  bool enabled_ = true;
+  bool require_engine_running_;
+  unsigned int start_delay_;
+
+  HoltTrend trend_;
+  bool engine_running_ = false;
+  uint32_t running_since_ = 0;
+};
+
+inline const String ConfigSchema(const TrendAlarm& obj) {
+  return R"###({
+    "type": "object",
+    "properties": {
+      "enabled": { "title": "Enabled", "type": "boolean" },
+      "threshold": { "title": "Threshold", "type": "number", "description": "Limit in the units of the input (K, bar)" },
+      "horizon": { "title": "Warning horizon", "type": "number", "description": "Warn when the limit is projected to be reached within this time (s)" }
+    }
+  })###";
+}
+
+inline const bool ConfigRequiresRestart(const TrendAlarm& obj) {
+  return false;
+}
+
+}  // namespace halmet
+
+#endif  // HALMET_SRC_TREND_ALARM_H_
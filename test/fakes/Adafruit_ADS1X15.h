@@ -0,0 +1,157 @@
+#ifndef HALMET_TEST_FAKES_ADAFRUIT_ADS1X15_H_
+#define HALMET_TEST_FAKES_ADAFRUIT_ADS1X15_H_
+
+// Host stand-in for the Adafruit ADS1X15 library with a simulated ADS1115
+// behind it. The register constants and the protected m_i2c_dev member are
+// those of the library, so ADS1115Transfers works unchanged. The I2C device
+// answers the transfers from the input voltages a test sets.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <stddef.h>
+
+#define ADS1X15_REG_POINTER_CONVERT (0x00)
+#define ADS1X15_REG_POINTER_CONFIG (0x01)
+#define ADS1X15_REG_POINTER_LOWTHRESH (0x02)
+#define ADS1X15_REG_POINTER_HITHRESH (0x03)
+
+#define ADS1X15_REG_CONFIG_OS_MASK (0x8000)
+#define ADS1X15_REG_CONFIG_OS_SINGLE (0x8000)
+#define ADS1X15_REG_CONFIG_MUX_MASK (0x7000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_0 (0x4000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_1 (0x5000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_2 (0x6000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_3 (0x7000)
+#define ADS1X15_REG_CONFIG_PGA_MASK (0x0E00)
+#define ADS1X15_REG_CONFIG_MODE_SINGLE (0x0100)
+#define ADS1X15_REG_CONFIG_CMODE_TRAD (0x0000)
+#define ADS1X15_REG_CONFIG_CPOL_ACTVLOW (0x0000)
+#define ADS1X15_REG_CONFIG_CLAT_NONLAT (0x0000)
+#define ADS1X15_REG_CONFIG_CQUE_1CONV (0x0000)
+
+#define RATE_ADS1115_128SPS (0x0080)
+
+constexpr uint16_t MUX_BY_CHANNEL[] = {
+    ADS1X15_REG_CONFIG_MUX_SINGLE_0, ADS1X15_REG_CONFIG_MUX_SINGLE_1,
+    ADS1X15_REG_CONFIG_MUX_SINGLE_2, ADS1X15_REG_CONFIG_MUX_SINGLE_3};
+
+typedef enum {
+  GAIN_TWOTHIRDS = 0x0000,
+  GAIN_ONE = 0x0200,
+  GAIN_TWO = 0x0400,
+  GAIN_FOUR = 0x0600,
+  GAIN_EIGHT = 0x0800,
+  GAIN_SIXTEEN = 0x0A00
+} adsGain_t;
+
+// Full-scale range of a PGA setting, in volts
+inline float ADS1115FullScaleVolts(uint16_t gain) {
+  static const float kFullScale[] = {6.144, 4.096, 2.048,
+                                     1.024, 0.512, 0.256};
+  return kFullScale[(gain & ADS1X15_REG_CONFIG_PGA_MASK) >> 9];
+}
+
+/**
+ * @brief A simulated ADS1115 on the I2C bus.
+ *
+ * A single-shot conversion of the input voltage at the configured gain is
+ * ready conversion_ms after it was started, clipped to the full-scale
+ * range. Each transfer takes 1 ms of the clock behind millis(), so a
+ * conversion that never completes runs into the caller's timeout. While
+ * not responding, every transfer fails.
+ */
+class Adafruit_I2CDevice {
+ public:
+  bool write(const uint8_t* buffer, size_t len) {
+    if (!transfer() || len < 1) {
+      return false;
+    }
+    pointer_ = buffer[0];
+    if (len == 3) {
+      uint16_t value = (buffer[1] << 8) | buffer[2];
+      if (pointer_ == ADS1X15_REG_POINTER_CONFIG &&
+          (value & ADS1X15_REG_CONFIG_OS_SINGLE) != 0) {
+        start_conversion(value);
+      }
+    }
+    return true;
+  }
+
+  bool read(uint8_t* buffer, size_t len) {
+    if (!transfer() || len != 2) {
+      return false;
+    }
+    uint16_t value = 0;
+    if (pointer_ == ADS1X15_REG_POINTER_CONFIG) {
+      value = config_ & ~ADS1X15_REG_CONFIG_OS_MASK;
+      if (millis() - start_ms_ >= conversion_ms_) {
+        value |= ADS1X15_REG_CONFIG_OS_MASK;
+      }
+    } else if (pointer_ == ADS1X15_REG_POINTER_CONVERT) {
+      value = static_cast<uint16_t>(result_);
+    }
+    buffer[0] = value >> 8;
+    buffer[1] = value & 0xff;
+    return true;
+  }
+
+  float input_volts[4] = {};
+  bool responding = true;
+  uint32_t conversion_ms = 8;
+  // Conversions started, and the gain of the last one
+  unsigned int conversions = 0;
+  uint16_t last_gain = GAIN_TWOTHIRDS;
+
+ protected:
+  bool transfer() {
+    halmet::test::ArduinoClock().advance(1);
+    return responding;
+  }
+
+  void start_conversion(uint16_t config) {
+    config_ = config;
+    start_ms_ = millis();
+    conversion_ms_ = conversion_ms;
+    conversions++;
+    last_gain = config & ADS1X15_REG_CONFIG_PGA_MASK;
+    int channel = ((config & ADS1X15_REG_CONFIG_MUX_MASK) >> 12) - 4;
+    float counts = input_volts[channel] / ADS1115FullScaleVolts(config) * 32768;
+    if (counts > 32767) {
+      counts = 32767;
+    } else if (counts < -32768) {
+      counts = -32768;
+    }
+    result_ = static_cast<int16_t>(lroundf(counts));
+  }
+
+  uint8_t pointer_ = 0;
+  uint16_t config_ = 0;
+  uint32_t start_ms_ = 0;
+  uint32_t conversion_ms_ = 0;
+  int16_t result_ = 0;
+};
+
+class Adafruit_ADS1X15 {
+ public:
+  float computeVolts(int16_t counts) {
+    return counts * ADS1115FullScaleVolts(m_gain) / 32768;
+  }
+  void setGain(adsGain_t gain) { m_gain = gain; }
+  adsGain_t getGain() { return m_gain; }
+  uint16_t getDataRate() { return m_dataRate; }
+
+ protected:
+  Adafruit_I2CDevice* m_i2c_dev = nullptr;
+  adsGain_t m_gain = GAIN_TWOTHIRDS;
+  uint16_t m_dataRate = RATE_ADS1115_128SPS;
+};
+
+class Adafruit_ADS1115 : public Adafruit_ADS1X15 {
+ public:
+  Adafruit_ADS1115() { m_i2c_dev = &device; }
+
+  /// The simulated chip, for the test to drive.
+  Adafruit_I2CDevice device;
+};
+
+#endif  // HALMET_TEST_FAKES_ADAFRUIT_ADS1X15_H_
@@ -0,0 +1,46 @@
+#ifndef HALMET_TEST_FAKES_ARDUINO_H_
+#define HALMET_TEST_FAKES_ARDUINO_H_
+
+// Host stand-in for the parts of the Arduino core that the sensor classes
+// in src/ use: millis() on a virtual clock, String and the FreeRTOS
+// spinlock type.
+
+#include <math.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "virtual_clock.h"
+
+namespace halmet {
+namespace test {
+
+/// The clock behind millis(). Tests set and advance it directly, or through
+/// the fake event loop.
+inline VirtualClock& ArduinoClock() {
+  static VirtualClock clock;
+  return clock;
+}
+
+}  // namespace test
+}  // namespace halmet
+
+inline uint32_t millis() { return halmet::test::ArduinoClock().now(); }
+
+class String {
+ public:
+  String(const char* str = "") : str_{str} {}
+  const char* c_str() const { return str_.c_str(); }
+  bool operator==(const String& other) const { return str_ == other.str_; }
+
+ protected:
+  std::string str_;
+};
+
+// Nothing runs concurrently on the host
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(lock) (void)(lock)
+#define portEXIT_CRITICAL(lock) (void)(lock)
+
+#endif  // HALMET_TEST_FAKES_ARDUINO_H_
@@ -0,0 +1,53 @@
+#ifndef HALMET_TEST_FAKES_ARDUINOJSON_H_
+#define HALMET_TEST_FAKES_ARDUINOJSON_H_
+
+// Just enough of ArduinoJson 7 for the to_json() and from_json() of the
+// sensor classes: a flat object of numbers.
+
+#include <map>
+#include <string>
+
+class JsonVariant {
+ public:
+  JsonVariant(std::map<std::string, double>* members, const char* key)
+      : members_{members}, key_{key} {}
+
+  template <typename T>
+  JsonVariant& operator=(T value) {
+    (*members_)[key_] = value;
+    return *this;
+  }
+
+  template <typename T>
+  bool is() const {
+    auto member = members_->find(key_);
+    if (member == members_->end()) {
+      return false;
+    }
+    // An unsigned type only takes non-negative whole numbers
+    T converted = static_cast<T>(member->second);
+    return converted == member->second;
+  }
+
+  template <typename T>
+  operator T() const {
+    auto member = members_->find(key_);
+    return member == members_->end() ? T() : static_cast<T>(member->second);
+  }
+
+ protected:
+  std::map<std::string, double>* members_;
+  std::string key_;
+};
+
+class JsonObject {
+ public:
+  JsonVariant operator[](const char* key) const {
+    return JsonVariant(&members_, key);
+  }
+
+ protected:
+  mutable std::map<std::string, double> members_;
+};
+
+#endif  // HALMET_TEST_FAKES_ARDUINOJSON_H_
@@ -0,0 +1,9 @@
+#ifndef HALMET_TEST_FAKES_WIRE_H_
+#define HALMET_TEST_FAKES_WIRE_H_
+
+#include <Arduino.h>
+
+// The fake ADS1115 answers its transfers itself, without a bus.
+class TwoWire {};
+
+#endif  // HALMET_TEST_FAKES_WIRE_H_
@@ -0,0 +1,20 @@
+#ifndef HALMET_TEST_FAKES_SENSESP_SENSORS_SENSOR_H_
+#define HALMET_TEST_FAKES_SENSESP_SENSORS_SENSOR_H_
+
+#include "sensesp/system/saveable.h"
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+template <typename T>
+class SensorT : public FileSystemSaveable, public ValueProducer<T> {
+ public:
+  explicit SensorT(const String& config_path)
+      : FileSystemSaveable(config_path) {}
+};
+
+typedef SensorT<float> FloatSensor;
+
+}  // namespace sensesp
+
+#endif  // HALMET_TEST_FAKES_SENSESP_SENSORS_SENSOR_H_
@@ -0,0 +1,27 @@
+#ifndef HALMET_TEST_FAKES_SENSESP_SYSTEM_OBSERVABLE_H_
+#define HALMET_TEST_FAKES_SENSESP_SYSTEM_OBSERVABLE_H_
+
+#include <functional>
+#include <vector>
+
+namespace sensesp {
+
+class Observable {
+ public:
+  void attach(std::function<void()> observer) {
+    observers_.push_back(observer);
+  }
+
+  void notify() {
+    for (auto& observer : observers_) {
+      observer();
+    }
+  }
+
+ protected:
+  std::vector<std::function<void()>> observers_;
+};
+
+}  // namespace sensesp
+
+#endif  // HALMET_TEST_FAKES_SENSESP_SYSTEM_OBSERVABLE_H_
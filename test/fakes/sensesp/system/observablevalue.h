@@ -0,0 +1,19 @@
+#ifndef HALMET_TEST_FAKES_SENSESP_SYSTEM_OBSERVABLEVALUE_H_
+#define HALMET_TEST_FAKES_SENSESP_SYSTEM_OBSERVABLEVALUE_H_
+
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+template <typename T>
+class ObservableValue : public ValueProducer<T> {
+ public:
+  ObservableValue() = default;
+  ObservableValue(const T& value) : ValueProducer<T>(value) {}
+
+  void set(const T& value) { this->emit(value); }
+};
+
+}  // namespace sensesp
+
+#endif  // HALMET_TEST_FAKES_SENSESP_SYSTEM_OBSERVABLEVALUE_H_
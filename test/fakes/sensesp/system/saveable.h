@@ -0,0 +1,27 @@
+#ifndef HALMET_TEST_FAKES_SENSESP_SYSTEM_SAVEABLE_H_
+#define HALMET_TEST_FAKES_SENSESP_SYSTEM_SAVEABLE_H_
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+namespace sensesp {
+
+/// Nothing is stored on the host; load() keeps the constructor defaults.
+class FileSystemSaveable {
+ public:
+  explicit FileSystemSaveable(const String& config_path)
+      : config_path_{config_path} {}
+  virtual ~FileSystemSaveable() = default;
+
+  virtual bool load() { return true; }
+  virtual bool save() { return true; }
+  virtual bool to_json(JsonObject&) { return false; }
+  virtual bool from_json(const JsonObject&) { return false; }
+
+ protected:
+  String config_path_;
+};
+
+}  // namespace sensesp
+
+#endif  // HALMET_TEST_FAKES_SENSESP_SYSTEM_SAVEABLE_H_
@@ -0,0 +1,15 @@
+#ifndef HALMET_TEST_FAKES_SENSESP_SYSTEM_VALUECONSUMER_H_
+#define HALMET_TEST_FAKES_SENSESP_SYSTEM_VALUECONSUMER_H_
+
+namespace sensesp {
+
+template <typename T>
+class ValueConsumer {
+ public:
+  virtual ~ValueConsumer() = default;
+  virtual void set(const T&) {}
+};
+
+}  // namespace sensesp
+
+#endif  // HALMET_TEST_FAKES_SENSESP_SYSTEM_VALUECONSUMER_H_
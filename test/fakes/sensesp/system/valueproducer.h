@@ -0,0 +1,38 @@
+#ifndef HALMET_TEST_FAKES_SENSESP_SYSTEM_VALUEPRODUCER_H_
+#define HALMET_TEST_FAKES_SENSESP_SYSTEM_VALUEPRODUCER_H_
+
+#include "sensesp/system/observable.h"
+#include "sensesp/system/valueconsumer.h"
+
+namespace sensesp {
+
+/// Tests observe the emitted values with attach() and get().
+template <typename T>
+class ValueProducer : virtual public Observable {
+ public:
+  ValueProducer() = default;
+  explicit ValueProducer(const T& initial_value) : output_{initial_value} {}
+  virtual ~ValueProducer() = default;
+
+  virtual const T& get() const { return output_; }
+
+  void connect_to(ValueConsumer<T>* consumer) {
+    this->attach([this, consumer]() { consumer->set(this->output_); });
+  }
+
+  void emit(const T& value) {
+    output_ = value;
+    this->notify();
+  }
+
+ protected:
+  T output_{};
+};
+
+typedef ValueProducer<float> FloatProducer;
+typedef ValueProducer<int> IntProducer;
+typedef ValueProducer<bool> BoolProducer;
+
+}  // namespace sensesp
+
+#endif  // HALMET_TEST_FAKES_SENSESP_SYSTEM_VALUEPRODUCER_H_
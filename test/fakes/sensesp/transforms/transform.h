@@ -0,0 +1,21 @@
+#ifndef HALMET_TEST_FAKES_SENSESP_TRANSFORMS_TRANSFORM_H_
+#define HALMET_TEST_FAKES_SENSESP_TRANSFORMS_TRANSFORM_H_
+
+#include "sensesp/system/saveable.h"
+#include "sensesp/system/valueconsumer.h"
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+template <typename T>
+class SymmetricTransform : public FileSystemSaveable,
+                           public ValueConsumer<T>,
+                           public ValueProducer<T> {
+ public:
+  explicit SymmetricTransform(const String& config_path)
+      : FileSystemSaveable(config_path) {}
+};
+
+}  // namespace sensesp
+
+#endif  // HALMET_TEST_FAKES_SENSESP_TRANSFORMS_TRANSFORM_H_
@@ -0,0 +1,102 @@
+#ifndef HALMET_TEST_FAKES_SENSESP_BASE_APP_H_
+#define HALMET_TEST_FAKES_SENSESP_BASE_APP_H_
+
+// Host stand-in for the SensESP event loop and log macros. The repeat
+// events run on the clock behind millis(), like VirtualEventLoop, and can
+// be removed as in ReactESP.
+
+#include <Arduino.h>
+#include <stdio.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#define debugD(...)
+#define debugI(...)
+#define debugW(...)
+#define debugE(...)
+
+namespace reactesp {
+
+class EventLoop;
+
+class RepeatEvent {
+ public:
+  RepeatEvent(uint32_t interval_ms, std::function<void()> callback)
+      : interval_ms_{interval_ms},
+        due_ms_{millis() + interval_ms},
+        callback_{callback} {}
+
+  void remove(EventLoop*) { removed_ = true; }
+
+  uint32_t interval_ms() const { return interval_ms_; }
+  bool removed() const { return removed_; }
+
+ protected:
+  friend class EventLoop;
+
+  uint32_t interval_ms_;
+  uint32_t due_ms_;
+  std::function<void()> callback_;
+  bool removed_ = false;
+};
+
+class EventLoop {
+ public:
+  RepeatEvent* onRepeat(uint32_t interval_ms, std::function<void()> callback) {
+    events_.emplace_back(new RepeatEvent(interval_ms, callback));
+    return events_.back().get();
+  }
+
+  /// Run the repeat events due up to and including end_ms, in deadline
+  /// order, and leave the clock at end_ms.
+  void run_until(uint32_t end_ms) {
+    halmet::test::VirtualClock& clock = halmet::test::ArduinoClock();
+    while (true) {
+      RepeatEvent* next = nullptr;
+      for (auto& event : events_) {
+        if (event->removed_ ||
+            static_cast<int32_t>(event->due_ms_ - end_ms) > 0) {
+          continue;
+        }
+        if (next == nullptr ||
+            static_cast<int32_t>(event->due_ms_ - next->due_ms_) < 0) {
+          next = event.get();
+        }
+      }
+      if (next == nullptr) {
+        break;
+      }
+      // A callback may read the clock further, as an I2C poll does
+      if (static_cast<int32_t>(next->due_ms_ - clock.now()) > 0) {
+        clock.set(next->due_ms_);
+      }
+      next->due_ms_ += next->interval_ms_;
+      next->callback_();
+    }
+    if (static_cast<int32_t>(end_ms - clock.now()) > 0) {
+      clock.set(end_ms);
+    }
+  }
+
+  void run_for(uint32_t ms) { run_until(millis() + ms); }
+
+  void clear() { events_.clear(); }
+
+ protected:
+  std::vector<std::unique_ptr<RepeatEvent>> events_;
+};
+
+}  // namespace reactesp
+
+namespace sensesp {
+
+inline reactesp::EventLoop* event_loop() {
+  static reactesp::EventLoop loop;
+  return &loop;
+}
+
+}  // namespace sensesp
+
+#endif  // HALMET_TEST_FAKES_SENSESP_BASE_APP_H_
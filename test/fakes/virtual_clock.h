@@ -0,0 +1,88 @@
+#ifndef HALMET_TEST_FAKES_VIRTUAL_CLOCK_H_
+#define HALMET_TEST_FAKES_VIRTUAL_CLOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+namespace halmet {
+namespace test {
+
+/**
+ * @brief Millisecond clock that only moves when a test advances it.
+ *
+ * Stands in for millis() in host tests of the classes that take times as
+ * arguments. The clock wraps around like millis().
+ */
+class VirtualClock {
+ public:
+  explicit VirtualClock(uint32_t start_ms = 0) : now_ms_{start_ms} {}
+
+  uint32_t now() const { return now_ms_; }
+  void set(uint32_t now_ms) { now_ms_ = now_ms; }
+  void advance(uint32_t ms) { now_ms_ += ms; }
+
+ protected:
+  uint32_t now_ms_;
+};
+
+/**
+ * @brief Repeating timers on a VirtualClock.
+ *
+ * A host stand-in for the onRepeat() timers of the ReactESP event loop:
+ * run_until() advances the clock from one timer deadline to the next and
+ * calls the callbacks in deadline order. Like the event loop, a timer's
+ * next deadline is counted from the time it was due, so timers do not
+ * drift.
+ */
+class VirtualEventLoop {
+ public:
+  explicit VirtualEventLoop(VirtualClock* clock) : clock_{clock} {}
+
+  /// Call callback every interval_ms, first at now + interval_ms.
+  void onRepeat(uint32_t interval_ms, std::function<void()> callback) {
+    timers_.push_back({interval_ms, clock_->now() + interval_ms, callback});
+  }
+
+  /// Run all timers due up to and including end_ms.
+  void run_until(uint32_t end_ms) {
+    while (true) {
+      Timer* next = nullptr;
+      for (auto& timer : timers_) {
+        if (static_cast<int32_t>(timer.due_ms - end_ms) > 0) {
+          continue;
+        }
+        if (next == nullptr ||
+            static_cast<int32_t>(timer.due_ms - next->due_ms) < 0) {
+          next = &timer;
+        }
+      }
+      if (next == nullptr) {
+        break;
+      }
+      clock_->set(next->due_ms);
+      next->due_ms += next->interval_ms;
+      next->callback();
+    }
+    clock_->set(end_ms);
+  }
+
+  void run_for(uint32_t ms) { run_until(clock_->now() + ms); }
+
+ protected:
+  struct Timer {
+    uint32_t interval_ms;
+    uint32_t due_ms;
+    std::function<void()> callback;
+  };
+
+  VirtualClock* clock_;
+  std::vector<Timer> timers_;
+};
+
+}  // namespace test
+}  // namespace halmet
+
+#endif  // HALMET_TEST_FAKES_VIRTUAL_CLOCK_H_
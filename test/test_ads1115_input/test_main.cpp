@@ -0,0 +1,188 @@
+#include <math.h>
+#include <unity.h>
+
+#include <vector>
+
+#include "halmet_analog.h"
+
+using halmet::ADS1115ResistanceInput;
+using halmet::SenderFault;
+
+// src/*.cpp is not built for the host: the parts of latency_probe.cpp and
+// i2c_bus.cpp that update() uses, without the bus recovery.
+namespace halmet {
+
+LatencySampleScope::LatencySampleScope(uint32_t) {}
+LatencySampleScope::~LatencySampleScope() {}
+
+I2CDeviceGuard& ADS1115Guard() {
+  static I2CDeviceGuard guard("ADS1115");
+  return guard;
+}
+
+void I2CFailure(I2CDeviceGuard& guard) { guard.record_failure(millis()); }
+
+}  // namespace halmet
+
+static const int kChannel = 2;
+
+// ADS1115 input voltage for a sender of ohms, the inverse of
+// SenderResistance()
+static float Volts(float ohms) {
+  return ohms * halmet::kMeasurementCurrent / halmet::kVoltageDividerScale;
+}
+
+static Adafruit_ADS1115* ads1115;
+static ADS1115ResistanceInput* input;
+static std::vector<float> values;  // emitted resistances
+static std::vector<int> faults;    // emitted fault codes
+
+void setUp() {
+  halmet::test::ArduinoClock().set(10000);
+  halmet::ADS1115Guard().record_success();
+  ads1115 = new Adafruit_ADS1115();
+  input = new ADS1115ResistanceInput(ads1115, kChannel, "", 500,
+                                     halmet::kOilPressureSenderLimits);
+  values.clear();
+  faults.clear();
+  input->attach([]() { values.push_back(input->get()); });
+  input->fault_.attach([]() { faults.push_back(input->fault_.get()); });
+}
+
+void tearDown() {
+  sensesp::event_loop()->clear();
+  delete input;
+  delete ads1115;
+}
+
+void test_valid_sender_reading() {
+  ads1115->device.input_volts[kChannel] = Volts(100);
+  input->update();
+  TEST_ASSERT_EQUAL(1, values.size());
+  TEST_ASSERT_FLOAT_WITHIN(1, 100, values[0]);
+  TEST_ASSERT_EQUAL(1, faults.size());
+  TEST_ASSERT_EQUAL(static_cast<int>(SenderFault::kValid), faults[0]);
+}
+
+void test_faults_emit_nan_with_the_fault_code() {
+  struct {
+    float ohms;
+    SenderFault fault;
+  } cases[] = {{1500, SenderFault::kOpen},
+               {1, SenderFault::kShort},
+               {500, SenderFault::kOutOfRange},
+               {100, SenderFault::kValid}};
+  for (auto& c : cases) {
+    ads1115->device.input_volts[kChannel] = Volts(c.ohms);
+    input->update();
+    TEST_ASSERT_EQUAL(static_cast<int>(c.fault), faults.back());
+    TEST_ASSERT_EQUAL(c.fault != SenderFault::kValid, isnan(values.back()));
+  }
+  TEST_ASSERT_EQUAL(4, values.size());
+  TEST_ASSERT_EQUAL(4, faults.size());
+}
+
+void test_fault_code_is_emitted_only_when_it_changes() {
+  ads1115->device.input_volts[kChannel] = Volts(1500);
+  for (int i = 0; i < 5; i++) {
+    input->update();
+  }
+  TEST_ASSERT_EQUAL(5, values.size());
+  TEST_ASSERT_EQUAL(1, faults.size());
+  TEST_ASSERT_EQUAL(static_cast<int>(SenderFault::kOpen), faults[0]);
+}
+
+void test_gain_follows_the_input() {
+  // The first reading is at the 4.096 V range; 0.1 V then fits the highest
+  // gain
+  ads1115->device.input_volts[kChannel] = Volts(100);
+  input->update();
+  TEST_ASSERT_EQUAL(GAIN_ONE, ads1115->device.last_gain);
+  TEST_ASSERT_EQUAL(1, ads1115->device.conversions);
+  input->update();
+  TEST_ASSERT_EQUAL(GAIN_SIXTEEN, ads1115->device.last_gain);
+  TEST_ASSERT_EQUAL(2, ads1115->device.conversions);
+  // Higher resolution at the higher gain
+  TEST_ASSERT_FLOAT_WITHIN(0.1, 100, values.back());
+}
+
+void test_clipped_reading_is_retried_in_the_wider_range() {
+  // Without sender limits, so that the retried reading is emitted
+  ADS1115ResistanceInput unchecked(ads1115, kChannel, "");
+  std::vector<float> readings;
+  unchecked.attach([&]() { readings.push_back(unchecked.get()); });
+  ads1115->device.input_volts[kChannel] = Volts(100);
+  unchecked.update();
+  unchecked.update();
+  TEST_ASSERT_EQUAL(GAIN_SIXTEEN, ads1115->device.last_gain);
+
+  // 400 ohms is about 0.4 V, which clips at the 0.256 V range. The same
+  // update reads again at the widest normal range.
+  ads1115->device.input_volts[kChannel] = Volts(400);
+  unsigned int conversions = ads1115->device.conversions;
+  unchecked.update();
+  TEST_ASSERT_EQUAL(conversions + 2, ads1115->device.conversions);
+  TEST_ASSERT_EQUAL(GAIN_ONE, ads1115->device.last_gain);
+  TEST_ASSERT_EQUAL(3, readings.size());
+  TEST_ASSERT_FLOAT_WITHIN(1, 400, readings.back());
+}
+
+void test_nothing_is_emitted_while_the_ads1115_is_faulted() {
+  ads1115->device.input_volts[kChannel] = Volts(100);
+  input->update();
+  TEST_ASSERT_EQUAL(1, values.size());
+
+  ads1115->device.responding = false;
+  input->update();
+  TEST_ASSERT_EQUAL(1, values.size());
+  TEST_ASSERT_TRUE(halmet::ADS1115Guard().faulted());
+
+  // During the back-off, the bus is left alone
+  ads1115->device.responding = true;
+  uint32_t start = millis();
+  input->update();
+  TEST_ASSERT_EQUAL_UINT32(start, millis());
+  TEST_ASSERT_EQUAL(1, values.size());
+
+  halmet::test::ArduinoClock().advance(
+      halmet::I2CDeviceGuard::kMinBackoffMs);
+  input->update();
+  TEST_ASSERT_EQUAL(2, values.size());
+  TEST_ASSERT_FALSE(halmet::ADS1115Guard().faulted());
+  // A faulted ADS1115 is not a sender fault
+  TEST_ASSERT_EQUAL(1, faults.size());
+}
+
+void test_conversion_timeout_is_an_ads1115_fault() {
+  ads1115->device.input_volts[kChannel] = Volts(100);
+  ads1115->device.conversion_ms = 1000;
+  uint32_t start = millis();
+  input->update();
+  TEST_ASSERT_EQUAL(0, values.size());
+  TEST_ASSERT_TRUE(halmet::ADS1115Guard().faulted());
+  // Given up after the conversion timeout, not the conversion time
+  TEST_ASSERT_TRUE(millis() - start <=
+                   halmet::ADS1115AutoRange::kConversionTimeoutMs + 5);
+}
+
+void test_event_loop_reads_at_the_read_interval() {
+  ads1115->device.input_volts[kChannel] = Volts(100);
+  sensesp::event_loop()->run_for(5000);
+  TEST_ASSERT_EQUAL(10, values.size());
+  for (float value : values) {
+    TEST_ASSERT_FLOAT_WITHIN(1, 100, value);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_valid_sender_reading);
+  RUN_TEST(test_faults_emit_nan_with_the_fault_code);
+  RUN_TEST(test_fault_code_is_emitted_only_when_it_changes);
+  RUN_TEST(test_gain_follows_the_input);
+  RUN_TEST(test_clipped_reading_is_retried_in_the_wider_range);
+  RUN_TEST(test_nothing_is_emitted_while_the_ads1115_is_faulted);
+  RUN_TEST(test_conversion_timeout_is_an_ads1115_fault);
+  RUN_TEST(test_event_loop_reads_at_the_read_interval);
+  return UNITY_END();
+}
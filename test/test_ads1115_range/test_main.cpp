@@ -0,0 +1,87 @@
+#include <unity.h>
+
+#include "ads1115_range.h"
+
+using halmet::kADS1115FullScale;
+using halmet::kADS1115Ranges;
+using halmet::SelectADS1115Range;
+
+void setUp() {}
+void tearDown() {}
+
+void test_small_reading_selects_the_highest_gain_at_once() {
+  TEST_ASSERT_EQUAL(5, SelectADS1115Range(1, 0.1));
+  TEST_ASSERT_EQUAL(5, SelectADS1115Range(1, 0.0));
+}
+
+void test_reading_selects_the_highest_gain_it_fits_in() {
+  // 0.8 * 2.048 V = 1.638 V and 0.8 * 1.024 V = 0.819 V
+  TEST_ASSERT_EQUAL(2, SelectADS1115Range(1, 1.5));
+  TEST_ASSERT_EQUAL(3, SelectADS1115Range(1, 0.78));
+  TEST_ASSERT_EQUAL(1, SelectADS1115Range(1, 3.0));
+}
+
+void test_gain_is_not_lowered_while_the_reading_fits() {
+  // Between the upshift and clip fractions the current range is kept
+  TEST_ASSERT_EQUAL(2, SelectADS1115Range(2, 1.9));
+  TEST_ASSERT_EQUAL(3, SelectADS1115Range(3, 0.95));
+}
+
+void test_clipped_reading_restarts_from_the_widest_range() {
+  // 0.95 * 0.512 V = 0.486 V
+  TEST_ASSERT_EQUAL(1, SelectADS1115Range(4, 0.5));
+  TEST_ASSERT_EQUAL(1, SelectADS1115Range(5, 3.3));
+  TEST_ASSERT_EQUAL(0, SelectADS1115Range(4, 0.5, 0));
+}
+
+void test_clipped_reading_at_the_widest_range_steps_wider() {
+  // 0.95 * 4.096 V = 3.891 V
+  TEST_ASSERT_EQUAL(0, SelectADS1115Range(1, 4.0));
+  TEST_ASSERT_EQUAL(0, SelectADS1115Range(0, 6.2));
+}
+
+void test_negative_readings_use_the_magnitude() {
+  TEST_ASSERT_EQUAL(5, SelectADS1115Range(1, -0.1));
+  TEST_ASSERT_EQUAL(1, SelectADS1115Range(5, -0.25));
+}
+
+void test_noisy_input_does_not_toggle_the_range() {
+  // Noise around the 1.024 V range's upshift threshold
+  const float kTrace[] = {0.78, 0.9, 0.8, 0.93, 0.79, 0.85, 0.81, 0.92};
+  int range = SelectADS1115Range(1, kTrace[0]);
+  TEST_ASSERT_EQUAL(3, range);
+  for (float volts : kTrace) {
+    range = SelectADS1115Range(range, volts);
+    TEST_ASSERT_EQUAL(3, range);
+  }
+}
+
+void test_ramp_never_selects_a_range_the_next_reading_clips() {
+  // A slow ramp from 0 to 5 V and back, read at the selected range
+  int range = 1;
+  for (int step = 0; step <= 1000; step++) {
+    float volts = 5.0f * (step <= 500 ? step : 1000 - step) / 500;
+    float read = volts;
+    if (read > kADS1115FullScale[range]) {
+      read = kADS1115FullScale[range];
+    }
+    range = SelectADS1115Range(range, read);
+    TEST_ASSERT_TRUE(range >= 0 && range < kADS1115Ranges);
+    float next_volts = 5.0f * (step + 1 <= 500 ? step + 1 : 999 - step) / 500;
+    TEST_ASSERT_TRUE(next_volts < kADS1115FullScale[range]);
+  }
+  TEST_ASSERT_EQUAL(5, range);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_small_reading_selects_the_highest_gain_at_once);
+  RUN_TEST(test_reading_selects_the_highest_gain_it_fits_in);
+  RUN_TEST(test_gain_is_not_lowered_while_the_reading_fits);
+  RUN_TEST(test_clipped_reading_restarts_from_the_widest_range);
+  RUN_TEST(test_clipped_reading_at_the_widest_range_steps_wider);
+  RUN_TEST(test_negative_readings_use_the_magnitude);
+  RUN_TEST(test_noisy_input_does_not_toggle_the_range);
+  RUN_TEST(test_ramp_never_selects_a_range_the_next_reading_clips);
+  return UNITY_END();
+}
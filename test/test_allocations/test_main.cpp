@@ -0,0 +1,144 @@
+#include <stdlib.h>
+#include <unity.h>
+
+#include <new>
+#include <vector>
+
+#include "ads1115_range.h"
+#include "fuel_rate_model.h"
+#include "holt_trend.h"
+#include "latency_stats.h"
+#include "pulse_accumulator.h"
+#include "sender_validity.h"
+#include "slope_window.h"
+#include "throttle_timing.h"
+
+// Host counterpart of the AllocationMonitor: the per-sample code must not
+// allocate once it has warmed up. Every operator new in this program is
+// counted; the classes under test do not call malloc directly.
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  void* ptr = malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+
+// Samples run before counting starts, and while counting
+static const int kWarmUpTicks = 100;
+static const int kTicks = 10000;
+
+// Run tick(i) for the warm-up and then kTicks times, and return the
+// allocations made after the warm-up.
+template <typename F>
+static size_t AllocationsAfterWarmUp(F tick) {
+  int i = 0;
+  for (; i < kWarmUpTicks; i++) {
+    tick(i);
+  }
+  size_t start = allocations;
+  for (; i < kWarmUpTicks + kTicks; i++) {
+    tick(i);
+  }
+  return allocations - start;
+}
+
+// Results are written here so that the compiler cannot drop the calls
+static volatile float sink;
+
+void setUp() {}
+void tearDown() {}
+
+void test_the_hook_counts_allocations() {
+  size_t count = AllocationsAfterWarmUp([](int i) {
+    std::vector<int> values(i % 8 + 1);
+    sink = values.size();
+  });
+  TEST_ASSERT_EQUAL(kTicks, count);
+}
+
+void test_sender_classification_and_range_selection() {
+  int range = 1;
+  size_t count = AllocationsAfterWarmUp([&range](int i) {
+    float ohms = (i % 400) * 2.5f;
+    sink = static_cast<float>(
+        halmet::ClassifySenderResistance(ohms, halmet::kTankSenderLimits));
+    range = halmet::SelectADS1115Range(range, (i % 500) * 0.01f);
+    sink = range;
+  });
+  TEST_ASSERT_EQUAL(0, count);
+}
+
+void test_throttle_timing() {
+  halmet::ThrottleTiming throttle(1000, 5000);
+  size_t count = AllocationsAfterWarmUp([&throttle](int i) {
+    uint32_t now_ms = i * 40;
+    sink = throttle.input(now_ms);
+    if (i % 6 == 0) {
+      sink = throttle.poll(now_ms);
+    }
+  });
+  TEST_ASSERT_EQUAL(0, count);
+}
+
+void test_latency_statistics() {
+  halmet::LatencyStats stats;
+  size_t count = AllocationsAfterWarmUp([&stats](int i) {
+    uint32_t now_ms = i * 100;
+    stats.sample(i * 0.5f, now_ms);
+    stats.sent(now_ms + 5);
+    sink = stats.max_ms();
+    if (i % 600 == 0) {
+      stats.reset();
+    }
+  });
+  TEST_ASSERT_EQUAL(0, count);
+}
+
+void test_trend_and_slope() {
+  halmet::HoltTrend trend(5, 60);
+  halmet::SlopeWindow<16> window;
+  size_t count = AllocationsAfterWarmUp([&trend, &window](int i) {
+    uint32_t now_ms = i * 500;
+    trend.add(now_ms, 300 + i * 0.01f);
+    sink = trend.time_to(400);
+    window.add(now_ms, 50 - i * 0.001f);
+    sink = window.slope();
+  });
+  TEST_ASSERT_EQUAL(0, count);
+}
+
+void test_fuel_rate_and_pulse_count() {
+  halmet::FuelRateModel model;
+  model.set_engine_running(true);
+  halmet::PulseAccumulator pulses(32000);
+  size_t count = AllocationsAfterWarmUp([&model, &pulses](int i) {
+    model.add_level(0.8f - i * 0.00001f);
+    if (i % 120 == 0) {
+      sink = model.sample(i * 500, 70);
+    }
+    sink = pulses.update(static_cast<uint16_t>(i * 97 % 32000));
+  });
+  TEST_ASSERT_EQUAL(0, count);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_the_hook_counts_allocations);
+  RUN_TEST(test_sender_classification_and_range_selection);
+  RUN_TEST(test_throttle_timing);
+  RUN_TEST(test_latency_statistics);
+  RUN_TEST(test_trend_and_slope);
+  RUN_TEST(test_fuel_rate_and_pulse_count);
+  return UNITY_END();
+}
@@ -0,0 +1,164 @@
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "halmet_channels.h"
+
+using namespace halmet;
+
+void setUp() {}
+void tearDown() {}
+
+// Compare each string of a compiled-in channel with the runtime expansion
+// of the same pattern, as the channel manifest does it.
+#define CHECK_CHANNEL_STRING(FIELD, PATTERN)                            \
+  ExpandChannelString(PATTERN, name, sk_id, buffer, sizeof(buffer));    \
+  TEST_ASSERT_EQUAL_STRING(compiled.FIELD, buffer);                     \
+  count++;
+
+void test_tank_strings_match_compiled_table() {
+  constexpr TankChannel compiled =
+      HALMET_TANK_CHANNEL(0, "Fuel", "fuel.main", 3000);
+  const char* name = "Fuel";
+  const char* sk_id = "fuel.main";
+  char buffer[128];
+  int count = 0;
+  HALMET_TANK_CHANNEL_STRINGS(CHECK_CHANNEL_STRING, HALMET_CHANNEL_NAME,
+                              HALMET_CHANNEL_SK_ID)
+  TEST_ASSERT_EQUAL_INT(28, count);
+  TEST_ASSERT_EQUAL_STRING("/Tanks/Fuel/Level Curve",
+                           compiled.curve_config_path);
+  TEST_ASSERT_EQUAL_STRING("tanks.fuel.main.senderFault",
+                           compiled.fault_sk_path);
+}
+
+void test_temperature_strings_match_compiled_table() {
+  constexpr TemperatureChannel compiled = HALMET_TEMPERATURE_CHANNEL(
+      2, "Coolant", "propulsion.main.coolantTemperature", 3000);
+  const char* name = "Coolant";
+  const char* sk_id = "propulsion.main.coolantTemperature";
+  char buffer[128];
+  int count = 0;
+  HALMET_TEMPERATURE_CHANNEL_STRINGS(CHECK_CHANNEL_STRING, HALMET_CHANNEL_NAME,
+                                     HALMET_CHANNEL_SK_ID)
+  TEST_ASSERT_EQUAL_INT(19, count);
+  TEST_ASSERT_EQUAL_STRING("propulsion.main.coolantTemperature",
+                           compiled.temperature_sk_path);
+}
+
+void test_oil_pressure_and_tacho_strings_match_compiled_table() {
+  char buffer[128];
+  int count = 0;
+  {
+    constexpr OilPressureChannel compiled =
+        HALMET_OIL_PRESSURE_CHANNEL(3, "Oil", "main", 3000);
+    const char* name = "Oil";
+    const char* sk_id = "main";
+    HALMET_OIL_PRESSURE_CHANNEL_STRINGS(
+        CHECK_CHANNEL_STRING, HALMET_CHANNEL_NAME, HALMET_CHANNEL_SK_ID)
+    // The paths the oil pressure sender had before it took a name
+    TEST_ASSERT_EQUAL_STRING("/Propulsion/OilPressureSensor/Curve",
+                             compiled.curve_config_path);
+    TEST_ASSERT_EQUAL_STRING("/Propulsion/OilPressureSensor/Sender",
+                             compiled.sender_config_path);
+    TEST_ASSERT_EQUAL_STRING("Oil Pressure Sensor Curve", compiled.curve_title);
+  }
+  {
+    constexpr TachoChannel compiled = HALMET_TACHO_CHANNEL(23, "main");
+    const char* name = "main";
+    const char* sk_id = "";
+    HALMET_TACHO_CHANNEL_STRINGS(CHECK_CHANNEL_STRING, HALMET_CHANNEL_NAME,
+                                 HALMET_CHANNEL_SK_ID)
+    TEST_ASSERT_EQUAL_INT(23, compiled.pin);
+  }
+  TEST_ASSERT_EQUAL_INT(26, count);
+}
+
+void test_expansion_is_truncated_to_the_buffer() {
+  char buffer[8];
+  size_t length = ExpandChannelString("/Tanks/" HALMET_CHANNEL_NAME "/Level",
+                                      "Fuel", "", buffer, sizeof(buffer));
+
+  TEST_ASSERT_EQUAL_size_t(17, length);
+  TEST_ASSERT_EQUAL_STRING("/Tanks/", buffer);
+}
+
+// Arena bytes of the strings of one channel: the expanded strings plus
+// their terminating NULs, as the channel manifest copies them.
+#define ADD_STRING_BYTES(FIELD, PATTERN) \
+  bytes += ExpandChannelString(PATTERN, name, sk_id, nullptr, 0) + 1;
+
+struct StringBytes {
+  int fixed;
+  int per_name;
+  int per_sk_id;
+};
+
+#define CHANNEL_STRING_BYTES(STRINGS)                                  \
+  [](const char* name, const char* sk_id) {                            \
+    int bytes = 0;                                                     \
+    STRINGS(ADD_STRING_BYTES, HALMET_CHANNEL_NAME, HALMET_CHANNEL_SK_ID) \
+    return bytes;                                                      \
+  }
+
+template <typename F>
+static StringBytes MeasureStringBytes(F bytes) {
+  int fixed = bytes("", "");
+  return {fixed, bytes("x", "") - fixed, bytes("", "x") - fixed};
+}
+
+// The entry for kind in CHANNEL_STRING_BYTES in tools/manifest_check.py
+static StringBytes ManifestCheckStringBytes(const char* kind) {
+  // The project directory, from the path of this file
+  const char* test_path = "test/test_channel_strings/test_main.cpp";
+  char path[512];
+  snprintf(path, sizeof(path), "%.*stools/manifest_check.py",
+           static_cast<int>(strlen(__FILE__) - strlen(test_path)), __FILE__);
+  FILE* file = fopen(path, "r");
+  TEST_ASSERT_NOT_NULL_MESSAGE(file, path);
+
+  char key[32];
+  snprintf(key, sizeof(key), "\"%s\": (", kind);
+  StringBytes entry = {-1, -1, -1};
+  char line[256];
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    const char* found = strstr(line, key);
+    if (found != nullptr) {
+      sscanf(found + strlen(key), "%d, %d, %d", &entry.fixed,
+             &entry.per_name, &entry.per_sk_id);
+      break;
+    }
+  }
+  fclose(file);
+  TEST_ASSERT_TRUE_MESSAGE(entry.fixed >= 0, kind);
+  return entry;
+}
+
+static void CheckStringBytes(const char* kind, StringBytes measured) {
+  StringBytes table = ManifestCheckStringBytes(kind);
+  TEST_ASSERT_EQUAL_INT_MESSAGE(measured.fixed, table.fixed, kind);
+  TEST_ASSERT_EQUAL_INT_MESSAGE(measured.per_name, table.per_name, kind);
+  TEST_ASSERT_EQUAL_INT_MESSAGE(measured.per_sk_id, table.per_sk_id, kind);
+}
+
+void test_manifest_check_string_bytes_match() {
+  CheckStringBytes("tank", MeasureStringBytes(CHANNEL_STRING_BYTES(
+                               HALMET_TANK_CHANNEL_STRINGS)));
+  CheckStringBytes("temperature", MeasureStringBytes(CHANNEL_STRING_BYTES(
+                                      HALMET_TEMPERATURE_CHANNEL_STRINGS)));
+  CheckStringBytes("oil_pressure", MeasureStringBytes(CHANNEL_STRING_BYTES(
+                                       HALMET_OIL_PRESSURE_CHANNEL_STRINGS)));
+  CheckStringBytes("tacho", MeasureStringBytes(CHANNEL_STRING_BYTES(
+                                HALMET_TACHO_CHANNEL_STRINGS)));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_tank_strings_match_compiled_table);
+  RUN_TEST(test_temperature_strings_match_compiled_table);
+  RUN_TEST(test_oil_pressure_and_tacho_strings_match_compiled_table);
+  RUN_TEST(test_expansion_is_truncated_to_the_buffer);
+  RUN_TEST(test_manifest_check_string_bytes_match);
+  return UNITY_END();
+}
@@ -0,0 +1,163 @@
+#include <math.h>
+#include <unity.h>
+
+#include "fuel_rate_model.h"
+
+using halmet::FuelRateModel;
+
+// A 70 l tank, read every 500 ms and sampled once a minute
+static const float kCapacity = 70;
+static const uint32_t kSampleMs = 60000;
+static const int kReadingsPerSample = 120;
+
+static FuelRateModel* model;
+static uint32_t now_ms;
+static float volume;  // l
+
+void setUp() {
+  model = new FuelRateModel();
+  now_ms = 0;
+  volume = 50;
+}
+
+void tearDown() { delete model; }
+
+// One sample interval of readings while burning rate l/h, then close it.
+// Returns the result of FuelRateModel::sample().
+static bool Period(float rate, bool sender_ok = true) {
+  for (int i = 0; i < kReadingsPerSample; i++) {
+    volume -= rate * kSampleMs / kReadingsPerSample / 3600000;
+    model->add_level(sender_ok ? volume / kCapacity : NAN);
+  }
+  now_ms += kSampleMs;
+  return model->sample(now_ms, kCapacity);
+}
+
+// Start the engine and run until the first rate is reported
+static void WarmUp(float rate) {
+  model->set_engine_running(true);
+  // The period in which the engine started is not used
+  TEST_ASSERT_TRUE(Period(rate));
+  for (size_t i = 1; i < FuelRateModel::kMinSamples; i++) {
+    TEST_ASSERT_FALSE(Period(rate));
+  }
+  TEST_ASSERT_TRUE(Period(rate));
+}
+
+void test_nothing_is_reported_before_the_first_sample() {
+  TEST_ASSERT_FALSE(model->current(now_ms, 2 * kSampleMs));
+  TEST_ASSERT_TRUE(isnan(model->fuel_rate()));
+}
+
+void test_warm_up_needs_the_minimum_samples() {
+  model->set_engine_running(true);
+  TEST_ASSERT_TRUE(Period(3));
+  TEST_ASSERT_EQUAL_FLOAT(0, model->fuel_rate());
+  TEST_ASSERT_TRUE(isnan(model->hours_remaining()));
+  for (size_t i = 1; i < FuelRateModel::kMinSamples; i++) {
+    TEST_ASSERT_FALSE(Period(3));
+    TEST_ASSERT_EQUAL(i, model->window_size());
+  }
+  TEST_ASSERT_TRUE(Period(3));
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 3, model->fuel_rate());
+  TEST_ASSERT_FLOAT_WITHIN(0.1, volume / 3, model->hours_remaining());
+}
+
+void test_steady_burn_fills_the_window() {
+  WarmUp(3);
+  for (int i = 0; i < 20; i++) {
+    TEST_ASSERT_TRUE(Period(3));
+  }
+  TEST_ASSERT_EQUAL(FuelRateModel::kWindowSize, model->window_size());
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 3, model->fuel_rate());
+  TEST_ASSERT_TRUE(model->current(now_ms, 0));
+}
+
+void test_engine_stop_reports_zero_and_restarts_the_warm_up() {
+  WarmUp(3);
+  model->set_engine_running(false);
+  TEST_ASSERT_TRUE(Period(0));
+  TEST_ASSERT_EQUAL_FLOAT(0, model->fuel_rate());
+  TEST_ASSERT_TRUE(isnan(model->hours_remaining()));
+  TEST_ASSERT_EQUAL(0, model->window_size());
+  // Still stopped: zero again
+  TEST_ASSERT_TRUE(Period(0));
+  TEST_ASSERT_EQUAL_FLOAT(0, model->fuel_rate());
+
+  WarmUp(5);
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 5, model->fuel_rate());
+}
+
+void test_brief_stop_within_a_period_discards_it() {
+  WarmUp(3);
+  model->set_engine_running(false);
+  model->set_engine_running(true);
+  TEST_ASSERT_TRUE(Period(3));
+  TEST_ASSERT_EQUAL_FLOAT(0, model->fuel_rate());
+  TEST_ASSERT_EQUAL(0, model->window_size());
+}
+
+void test_refuel_keeps_the_estimate_until_the_window_refills() {
+  WarmUp(3);
+  uint32_t estimate_ms = now_ms;
+  volume += 30;
+  for (size_t i = 1; i < FuelRateModel::kMinSamples; i++) {
+    TEST_ASSERT_FALSE(Period(3));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 3, model->fuel_rate());
+  }
+  // Not refreshed for three sample intervals
+  TEST_ASSERT_TRUE(model->current(now_ms, now_ms - estimate_ms));
+  TEST_ASSERT_FALSE(model->current(now_ms, 2 * kSampleMs));
+  // Four samples of a fuller tank: float rounding of the level average is
+  // a larger part of the slope
+  TEST_ASSERT_TRUE(Period(3));
+  TEST_ASSERT_FLOAT_WITHIN(0.05, 3, model->fuel_rate());
+  TEST_ASSERT_FLOAT_WITHIN(1, volume / 3, model->hours_remaining());
+}
+
+void test_slow_refill_is_not_mistaken_for_refuelling() {
+  // A rise below 5 % of the capacity per sample, e.g. sloshing, is kept
+  WarmUp(3);
+  volume += 0.04 * kCapacity;
+  TEST_ASSERT_TRUE(Period(3));
+  TEST_ASSERT_EQUAL(FuelRateModel::kMinSamples + 1, model->window_size());
+}
+
+void test_sender_loss_makes_the_estimate_unknown() {
+  WarmUp(3);
+  TEST_ASSERT_TRUE(Period(3, false));
+  TEST_ASSERT_TRUE(isnan(model->fuel_rate()));
+  TEST_ASSERT_TRUE(isnan(model->hours_remaining()));
+  TEST_ASSERT_FALSE(model->current(now_ms, 2 * kSampleMs));
+  // Reported once, not again while the sender stays faulted
+  TEST_ASSERT_FALSE(Period(3, false));
+  TEST_ASSERT_FALSE(Period(3, false));
+
+  // The sender recovers: a new warm-up, without a stop in between
+  for (size_t i = 1; i < FuelRateModel::kMinSamples; i++) {
+    TEST_ASSERT_FALSE(Period(3));
+    TEST_ASSERT_TRUE(isnan(model->fuel_rate()));
+  }
+  TEST_ASSERT_TRUE(Period(3));
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 3, model->fuel_rate());
+}
+
+void test_low_rate_is_reported_as_zero() {
+  WarmUp(0.01);
+  TEST_ASSERT_EQUAL_FLOAT(0, model->fuel_rate());
+  TEST_ASSERT_TRUE(isnan(model->hours_remaining()));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_nothing_is_reported_before_the_first_sample);
+  RUN_TEST(test_warm_up_needs_the_minimum_samples);
+  RUN_TEST(test_steady_burn_fills_the_window);
+  RUN_TEST(test_engine_stop_reports_zero_and_restarts_the_warm_up);
+  RUN_TEST(test_brief_stop_within_a_period_discards_it);
+  RUN_TEST(test_refuel_keeps_the_estimate_until_the_window_refills);
+  RUN_TEST(test_slow_refill_is_not_mistaken_for_refuelling);
+  RUN_TEST(test_sender_loss_makes_the_estimate_unknown);
+  RUN_TEST(test_low_rate_is_reported_as_zero);
+  return UNITY_END();
+}
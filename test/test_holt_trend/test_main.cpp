@@ -0,0 +1,134 @@
+#include <math.h>
+#include <unity.h>
+
+#include "holt_trend.h"
+
+using halmet::HoltTrend;
+
+// Coolant temperature read every 500 ms, as by the analog inputs
+static const uint32_t kSampleMs = 500;
+
+// Deterministic noise in [-amplitude, amplitude]
+static float Noise(uint32_t* state, float amplitude) {
+  *state = *state * 1664525 + 1013904223;
+  return amplitude * ((*state >> 8) / 8388608.0f - 1);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_first_sample_sets_the_level() {
+  HoltTrend trend;
+  TEST_ASSERT_FALSE(trend.ready());
+  trend.add(1000, 350);
+  TEST_ASSERT_EQUAL_FLOAT(350, trend.level());
+  TEST_ASSERT_EQUAL_FLOAT(0, trend.trend());
+  TEST_ASSERT_TRUE(isinf(trend.time_to(368)));
+}
+
+void test_ready_after_one_trend_time_constant() {
+  HoltTrend trend(5, 60);
+  uint32_t time_ms = 0;
+  for (; time_ms < 60000; time_ms += kSampleMs) {
+    trend.add(time_ms, 350);
+    TEST_ASSERT_FALSE(trend.ready());
+  }
+  trend.add(time_ms, 350);
+  TEST_ASSERT_TRUE(trend.ready());
+}
+
+void test_replay_of_a_noisy_steady_trace() {
+  HoltTrend trend;
+  uint32_t state = 1;
+  for (uint32_t time_ms = 0; time_ms <= 600000; time_ms += kSampleMs) {
+    trend.add(time_ms, 353.15 + Noise(&state, 0.5));
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.3, 353.15, trend.level());
+  TEST_ASSERT_FLOAT_WITHIN(0.005, 0, trend.trend());
+  // A trend this small is hours away from the alarm threshold
+  TEST_ASSERT_TRUE(trend.time_to(368.15) > 3600);
+}
+
+void test_replay_of_a_rising_trace() {
+  // Warming up at 3 K per minute after 2 minutes at a steady 80 C, with
+  // noise
+  HoltTrend trend;
+  uint32_t state = 7;
+  float temperature = 353.15;
+  uint32_t time_ms = 0;
+  for (; time_ms <= 120000; time_ms += kSampleMs) {
+    trend.add(time_ms, temperature + Noise(&state, 0.5));
+  }
+  for (; time_ms <= 420000; time_ms += kSampleMs) {
+    temperature += 0.05 * kSampleMs / 1000;
+    trend.add(time_ms, temperature + Noise(&state, 0.5));
+  }
+  TEST_ASSERT_TRUE(trend.ready());
+  TEST_ASSERT_FLOAT_WITHIN(0.005, 0.05, trend.trend());
+  TEST_ASSERT_FLOAT_WITHIN(0.5, temperature, trend.level());
+  float expected_s = (383.15 - temperature) / 0.05;
+  TEST_ASSERT_FLOAT_WITHIN(0.15 * expected_s, expected_s,
+                           trend.time_to(383.15));
+}
+
+void test_trend_away_from_the_threshold_never_reaches_it() {
+  HoltTrend trend;
+  for (uint32_t time_ms = 0; time_ms <= 120000; time_ms += kSampleMs) {
+    trend.add(time_ms, 5.0 - time_ms / 100000.0f);
+  }
+  TEST_ASSERT_TRUE(trend.trend() < 0);
+  TEST_ASSERT_TRUE(isinf(trend.time_to(6.0)));
+  TEST_ASSERT_FALSE(isinf(trend.time_to(0.5)));
+}
+
+void test_repeated_and_older_times_are_ignored() {
+  HoltTrend trend;
+  trend.add(1000, 350);
+  trend.add(2000, 351);
+  float level = trend.level();
+  float rate = trend.trend();
+  trend.add(2000, 400);
+  trend.add(1500, 400);
+  TEST_ASSERT_EQUAL_FLOAT(level, trend.level());
+  TEST_ASSERT_EQUAL_FLOAT(rate, trend.trend());
+}
+
+void test_reset_restarts_from_the_next_sample() {
+  HoltTrend trend;
+  for (uint32_t time_ms = 0; time_ms <= 90000; time_ms += kSampleMs) {
+    trend.add(time_ms, 350 + time_ms / 10000.0f);
+  }
+  TEST_ASSERT_TRUE(trend.ready());
+  trend.reset();
+  TEST_ASSERT_FALSE(trend.ready());
+  trend.add(100000, 300);
+  TEST_ASSERT_EQUAL_FLOAT(300, trend.level());
+  TEST_ASSERT_EQUAL_FLOAT(0, trend.trend());
+}
+
+void test_trend_across_millis_wraparound() {
+  HoltTrend wrapping;
+  HoltTrend reference;
+  uint32_t start = UINT32_MAX - 30000;
+  for (uint32_t i = 0; i <= 240; i++) {
+    float value = 350 + i * 0.025f;
+    wrapping.add(start + i * kSampleMs, value);
+    reference.add(i * kSampleMs, value);
+  }
+  TEST_ASSERT_EQUAL_FLOAT(reference.level(), wrapping.level());
+  TEST_ASSERT_EQUAL_FLOAT(reference.trend(), wrapping.trend());
+  TEST_ASSERT_TRUE(wrapping.ready());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_sample_sets_the_level);
+  RUN_TEST(test_ready_after_one_trend_time_constant);
+  RUN_TEST(test_replay_of_a_noisy_steady_trace);
+  RUN_TEST(test_replay_of_a_rising_trace);
+  RUN_TEST(test_trend_away_from_the_threshold_never_reaches_it);
+  RUN_TEST(test_repeated_and_older_times_are_ignored);
+  RUN_TEST(test_reset_restarts_from_the_next_sample);
+  RUN_TEST(test_trend_across_millis_wraparound);
+  return UNITY_END();
+}
@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <unity.h>
+
+#include <chrono>
+
+#include "ads1115_range.h"
+#include "holt_trend.h"
+#include "latency_stats.h"
+#include "sender_validity.h"
+#include "slope_window.h"
+#include "throttle_timing.h"
+
+// Host counterpart of HotPathBenchmark: times the per-sample code that does
+// not depend on the Arduino core and prints the results in the same
+// "HOT_PATH_BENCHMARK " format, in ns per call. tools/hot_path_check.py
+// --native runs this test and compares the results with
+// tools/hot_path_baseline_native.json.
+
+static const unsigned int kIterations = 20000;
+static const int kBatches = 15;
+static const size_t kMaxResults = 12;
+
+struct Result {
+  const char* name;
+  double ns;
+};
+
+static Result results[kMaxResults];
+static size_t num_results;
+static double overhead_ns;
+
+// Results are written here so that the compiler cannot drop the calls
+static volatile float sink;
+
+// Store the fastest batch's mean time per call of fn() under name, less the
+// loop overhead. Other processes only ever add time.
+template <typename F>
+static void measure(const char* name, F fn) {
+  using Clock = std::chrono::steady_clock;
+  double best = 1e300;
+  for (int batch = 0; batch < kBatches; batch++) {
+    auto start = Clock::now();
+    for (unsigned int i = 0; i < kIterations; i++) {
+      fn();
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    if (elapsed.count() < best) {
+      best = elapsed.count();
+    }
+  }
+  double per_call = best / kIterations - overhead_ns;
+  if (num_results < kMaxResults) {
+    results[num_results++] = {name, per_call > 0 ? per_call : 0};
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_measure_hot_paths() {
+  num_results = 0;
+  overhead_ns = 0;
+  measure("loop", []() {});
+  overhead_ns = results[0].ns;
+  num_results = 0;
+
+  // Vary the input so that nothing is computed at compile time
+  volatile float input = 0;
+
+  measure("classify_sender", [&input]() {
+    input = input + 0.5f;
+    if (input > 300) {
+      input = 0;
+    }
+    sink = static_cast<float>(
+        halmet::ClassifySenderResistance(input, halmet::kTankSenderLimits));
+  });
+
+  int range = 1;
+  measure("ads1115_range", [&input, &range]() {
+    input = input + 0.01f;
+    if (input > 5) {
+      input = 0;
+    }
+    range = halmet::SelectADS1115Range(range, input);
+    sink = range;
+  });
+
+  // The window of FuelRateEstimator, one sample and estimate per call
+  halmet::SlopeWindow<16> window;
+  uint32_t time_ms = 0;
+  measure("slope_window", [&input, &window, &time_ms]() {
+    input = input + 0.5f;
+    time_ms += 1000;
+    window.add(time_ms, input);
+    sink = window.slope();
+  });
+
+  halmet::HoltTrend trend(5, 60);
+  measure("holt_trend", [&input, &trend, &time_ms]() {
+    input = input + 0.5f;
+    time_ms += 500;
+    trend.add(time_ms, input);
+    sink = trend.time_to(400);
+  });
+
+  halmet::ThrottleTiming throttle(200);
+  measure("throttle_input", [&throttle, &time_ms]() {
+    time_ms += 50;
+    sink = throttle.input(time_ms);
+  });
+
+  halmet::LatencyStats stats;
+  measure("latency_sample", [&input, &stats, &time_ms]() {
+    input = input + 0.5f;
+    time_ms += 100;
+    stats.sample(input, time_ms);
+    stats.sent(time_ms + 5);
+    sink = stats.max_ms();
+  });
+
+  printf("HOT_PATH_BENCHMARK {\"target\":\"native\",\"iterations\":%u,"
+         "\"ns\":{",
+         kIterations);
+  for (size_t i = 0; i < num_results; i++) {
+    printf("%s\"%s\":%.2f", i == 0 ? "" : ",", results[i].name,
+           results[i].ns);
+  }
+  printf("}}\n");
+
+  TEST_ASSERT_EQUAL(6, num_results);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_measure_hot_paths);
+  return UNITY_END();
+}
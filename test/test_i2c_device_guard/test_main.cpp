@@ -0,0 +1,147 @@
+#include <unity.h>
+
+#include <vector>
+
+#include "i2c_device_guard.h"
+#include "virtual_clock.h"
+
+using halmet::I2CDeviceGuard;
+using halmet::test::VirtualClock;
+using halmet::test::VirtualEventLoop;
+
+/// A device on an I2C bus that can be unplugged. Records the times of the
+/// transactions addressed to it.
+class FakeBus {
+ public:
+  explicit FakeBus(VirtualClock* clock) : clock_{clock} {}
+
+  bool transaction() {
+    transaction_times_.push_back(clock_->now());
+    return connected_;
+  }
+
+  void set_connected(bool connected) { connected_ = connected; }
+  const std::vector<uint32_t>& transaction_times() const {
+    return transaction_times_;
+  }
+
+ protected:
+  VirtualClock* clock_;
+  bool connected_ = true;
+  std::vector<uint32_t> transaction_times_;
+};
+
+// How the inputs use the guard: skip the bus while backing off, and record
+// the result of each transaction
+static bool GuardedRead(I2CDeviceGuard* guard, FakeBus* bus, uint32_t now) {
+  if (!guard->available(now)) {
+    return false;
+  }
+  if (bus->transaction()) {
+    guard->record_success();
+    return true;
+  }
+  guard->record_failure(now);
+  return false;
+}
+
+static VirtualClock* clock_;
+static VirtualEventLoop* loop;
+static FakeBus* bus;
+static I2CDeviceGuard* guard;
+
+void setUp() {
+  clock_ = new VirtualClock();
+  loop = new VirtualEventLoop(clock_);
+  bus = new FakeBus(clock_);
+  guard = new I2CDeviceGuard("test");
+  // An input read every 100 ms
+  loop->onRepeat(100, []() { GuardedRead(guard, bus, clock_->now()); });
+}
+
+void tearDown() {
+  delete guard;
+  delete bus;
+  delete loop;
+  delete clock_;
+}
+
+void test_connected_device_is_read_every_time() {
+  loop->run_for(1000);
+  TEST_ASSERT_EQUAL(10, bus->transaction_times().size());
+  TEST_ASSERT_FALSE(guard->faulted());
+  TEST_ASSERT_EQUAL_UINT32(0, guard->errors());
+}
+
+void test_backoff_doubles_up_to_the_maximum() {
+  bus->set_connected(false);
+  loop->run_for(120000);
+
+  // Failed at 100 ms, then retried after 500, 1000, 2000, ... ms, capped
+  // at 30 s
+  const uint32_t kExpected[] = {100,   600,   1600,  3600,  7600,
+                                15600, 31600, 61600, 91600};
+  const auto& times = bus->transaction_times();
+  TEST_ASSERT_EQUAL(sizeof(kExpected) / sizeof(kExpected[0]), times.size());
+  for (size_t i = 0; i < times.size(); i++) {
+    TEST_ASSERT_EQUAL_UINT32(kExpected[i], times[i]);
+  }
+  TEST_ASSERT_EQUAL_UINT32(I2CDeviceGuard::kMaxBackoffMs,
+                           guard->backoff_ms());
+  TEST_ASSERT_EQUAL_UINT32(times.size(), guard->errors());
+  TEST_ASSERT_TRUE(guard->faulted());
+}
+
+void test_reconnected_device_clears_the_fault() {
+  bus->set_connected(false);
+  loop->run_for(10000);
+  uint32_t errors = guard->errors();
+  bus->set_connected(true);
+
+  // The next retry is at 15.6 s
+  loop->run_until(15500);
+  TEST_ASSERT_TRUE(guard->faulted());
+  loop->run_until(15600);
+  TEST_ASSERT_FALSE(guard->faulted());
+  TEST_ASSERT_EQUAL_UINT32(0, guard->backoff_ms());
+  TEST_ASSERT_EQUAL_UINT32(errors, guard->errors());
+
+  // Back to a read every 100 ms
+  size_t count = bus->transaction_times().size();
+  loop->run_for(1000);
+  TEST_ASSERT_EQUAL(count + 10, bus->transaction_times().size());
+}
+
+void test_new_failure_restarts_at_the_minimum_backoff() {
+  bus->set_connected(false);
+  loop->run_for(10000);
+  bus->set_connected(true);
+  loop->run_until(16000);
+  TEST_ASSERT_FALSE(guard->faulted());
+
+  bus->set_connected(false);
+  loop->run_for(100);
+  TEST_ASSERT_EQUAL_UINT32(I2CDeviceGuard::kMinBackoffMs,
+                           guard->backoff_ms());
+}
+
+void test_backoff_across_millis_wraparound() {
+  clock_->set(UINT32_MAX - 250);
+  I2CDeviceGuard wrapping("wrap");
+  wrapping.record_failure(clock_->now());
+  TEST_ASSERT_FALSE(wrapping.available(clock_->now()));
+  clock_->advance(400);
+  TEST_ASSERT_FALSE(wrapping.available(clock_->now()));
+  clock_->advance(100);
+  TEST_ASSERT_TRUE(wrapping.available(clock_->now()));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_connected_device_is_read_every_time);
+  RUN_TEST(test_backoff_doubles_up_to_the_maximum);
+  RUN_TEST(test_reconnected_device_clears_the_fault);
+  RUN_TEST(test_new_failure_restarts_at_the_minimum_backoff);
+  RUN_TEST(test_backoff_across_millis_wraparound);
+  return UNITY_END();
+}
@@ -0,0 +1,88 @@
+#include <unity.h>
+
+#include "latency_stats.h"
+#include "virtual_clock.h"
+
+using halmet::LatencyStats;
+using halmet::test::VirtualClock;
+using halmet::test::VirtualEventLoop;
+
+// Sender periods of n2k_senders.h
+static const uint32_t kRapidPeriod = 100;
+static const uint32_t kDynamicPeriod = 500;
+static const uint32_t kSlowPeriod = 2500;
+
+void setUp() {}
+void tearDown() {}
+
+// An engine speed that steps up every 1.3 s, so that the steps fall at
+// varying phases of the input and sender timers.
+static float EngineSpeed(uint32_t now_ms) { return 10 + now_ms / 1300; }
+
+// Replay an input read every read_ms and a sender every period_ms, starting
+// offset_ms after the input, for one simulated minute.
+static LatencyStats Replay(uint32_t read_ms, uint32_t window_ms,
+                           uint32_t period_ms, uint32_t offset_ms) {
+  VirtualClock clock;
+  VirtualEventLoop loop(&clock);
+  LatencyStats stats(0.01);
+  loop.onRepeat(read_ms, [&]() {
+    stats.sample(EngineSpeed(clock.now()), clock.now() - window_ms);
+  });
+  loop.run_for(offset_ms);
+  loop.onRepeat(period_ms, [&]() { stats.sent(clock.now()); });
+  loop.run_for(60000);
+  return stats;
+}
+
+void test_rapid_sender_latency_from_the_counting_window() {
+  // Tacho counted over 500 ms windows and sent in the 100 ms rapid PGN
+  for (uint32_t offset = 0; offset < kRapidPeriod; offset += 10) {
+    LatencyStats stats = Replay(500, 500, kRapidPeriod, offset);
+    TEST_ASSERT_TRUE(stats.count() > 30);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(500 + kRapidPeriod, stats.max_ms());
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(500, stats.max_ms());
+  }
+}
+
+void test_dynamic_sender_latency_from_the_adc_read() {
+  // Coolant temperature read every 500 ms, sent every 500 ms
+  for (uint32_t offset = 0; offset < kDynamicPeriod; offset += 50) {
+    LatencyStats stats = Replay(500, 0, kDynamicPeriod, offset);
+    TEST_ASSERT_TRUE(stats.count() > 30);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(kDynamicPeriod, stats.max_ms());
+  }
+}
+
+void test_slow_sender_skips_changes_while_pending() {
+  // Fluid level sent every 2.5 s: only the first change of each period is
+  // timed, so every measurement covers a full sender period
+  LatencyStats stats = Replay(500, 0, kSlowPeriod, 0);
+  TEST_ASSERT_EQUAL_UINT32(60000 / kSlowPeriod, stats.count());
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kSlowPeriod, stats.max_ms());
+}
+
+void test_unchanged_values_are_not_timed() {
+  LatencyStats stats(0.05);
+  stats.sample(100, 0);
+  stats.sent(100);
+  stats.sample(104, 200);  // within 5%
+  TEST_ASSERT_FALSE(stats.pending());
+  stats.sent(300);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.count());
+  TEST_ASSERT_EQUAL_UINT32(100, stats.max_ms());
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 100, stats.mean_ms());
+
+  stats.reset();
+  TEST_ASSERT_EQUAL_UINT32(0, stats.count());
+  TEST_ASSERT_FLOAT_IS_NAN(stats.mean_ms());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_rapid_sender_latency_from_the_counting_window);
+  RUN_TEST(test_dynamic_sender_latency_from_the_adc_read);
+  RUN_TEST(test_slow_sender_skips_changes_while_pending);
+  RUN_TEST(test_unchanged_values_are_not_timed);
+  return UNITY_END();
+}
@@ -0,0 +1,141 @@
+#include <N2kMessages.h>
+#include <unity.h>
+
+#include "n2k_pgn_cache.h"
+
+using halmet::kN2kAnySource;
+using halmet::N2kField;
+using halmet::N2kPgnCache;
+
+static N2kPgnCache* cache;
+
+void setUp() { cache = new N2kPgnCache(); }
+void tearDown() { delete cache; }
+
+static tN2kMsg EngineRapid(uint8_t source, uint8_t instance, double rpm) {
+  tN2kMsg msg;
+  SetN2kEngineParamRapid(msg, instance, rpm);
+  msg.Source = source;
+  return msg;
+}
+
+static tN2kMsg FuelLevel(uint8_t source, uint8_t instance, double level) {
+  tN2kMsg msg;
+  SetN2kFluidLevel(msg, instance, N2kft_Fuel, level, 200);
+  msg.Source = source;
+  return msg;
+}
+
+void test_replay_of_engine_and_speed_messages() {
+  // A short capture: engine 0 rapid and dynamic parameters and the boat
+  // speed from a paddle wheel, as received at the given times.
+  tN2kMsg dynamic;
+  SetN2kEngineDynamicParam(dynamic, 0, 350000, N2kDoubleNA, 353.15, 14.2,
+                           12.3, 3600);
+  dynamic.Source = 10;
+  tN2kMsg speed;
+  SetN2kBoatSpeed(speed, 1, 3.2, 3.5, N2kSWRT_Paddle_wheel);
+  speed.Source = 35;
+
+  TEST_ASSERT_TRUE(cache->decode(EngineRapid(10, 0, 1800), 1000));
+  TEST_ASSERT_TRUE(cache->decode(dynamic, 1050));
+  TEST_ASSERT_TRUE(cache->decode(speed, 1100));
+  TEST_ASSERT_TRUE(cache->decode(EngineRapid(10, 0, 1850), 1100));
+
+  auto rpm = cache->read(N2kField::kEngineSpeed, 0, kN2kAnySource, 1200);
+  TEST_ASSERT_TRUE(rpm.found);
+  TEST_ASSERT_FLOAT_WITHIN(0.25, 1850, rpm.value);
+  TEST_ASSERT_EQUAL_UINT32(100, rpm.age_ms);
+
+  TEST_ASSERT_FLOAT_WITHIN(
+      0.1, 12.3,
+      cache->read(N2kField::kFuelRate, 0, kN2kAnySource, 1200).value);
+  TEST_ASSERT_FLOAT_WITHIN(
+      1, 3600,
+      cache->read(N2kField::kEngineHours, 0, kN2kAnySource, 1200).value);
+  TEST_ASSERT_FLOAT_WITHIN(
+      0.01, 353.15,
+      cache->read(N2kField::kCoolantTemperature, 0, kN2kAnySource, 1200)
+          .value);
+  TEST_ASSERT_FLOAT_WITHIN(
+      100, 350000,
+      cache->read(N2kField::kOilPressure, 0, kN2kAnySource, 1200).value);
+
+  // 128259 has no instance; it is stored under instance 0
+  TEST_ASSERT_FLOAT_WITHIN(
+      0.01, 3.2,
+      cache->read(N2kField::kSpeedThroughWater, 0, 35, 1200).value);
+  TEST_ASSERT_FLOAT_WITHIN(
+      0.01, 3.5, cache->read(N2kField::kSpeedOverGround, 0, 35, 1200).value);
+}
+
+void test_sequence_changes_on_update() {
+  cache->decode(EngineRapid(10, 0, 1800), 1000);
+  auto first = cache->read(N2kField::kEngineSpeed, 0, 10, 1000);
+  auto again = cache->read(N2kField::kEngineSpeed, 0, 10, 1050);
+  TEST_ASSERT_EQUAL_UINT32(first.sequence, again.sequence);
+
+  cache->decode(EngineRapid(10, 0, 1800), 1100);
+  auto updated = cache->read(N2kField::kEngineSpeed, 0, 10, 1100);
+  TEST_ASSERT_TRUE(updated.sequence != first.sequence);
+  TEST_ASSERT_EQUAL_UINT32(0, updated.age_ms);
+}
+
+void test_instance_and_source_select_the_entry() {
+  cache->decode(FuelLevel(20, 0, 75), 1000);
+  cache->decode(FuelLevel(20, 1, 40), 1000);
+  cache->decode(FuelLevel(21, 0, 50), 2000);
+
+  TEST_ASSERT_FLOAT_WITHIN(
+      0.01, 75, cache->read(N2kField::kTankLevel, 0, 20, 2000).value);
+  TEST_ASSERT_FLOAT_WITHIN(
+      0.01, 40, cache->read(N2kField::kTankLevel, 1, 20, 2000).value);
+  TEST_ASSERT_FLOAT_WITHIN(
+      0.1, 200, cache->read(N2kField::kTankCapacity, 1, 20, 2000).value);
+  // Any source: the most recently updated entry wins
+  TEST_ASSERT_FLOAT_WITHIN(
+      0.01, 50,
+      cache->read(N2kField::kTankLevel, 0, kN2kAnySource, 2000).value);
+
+  TEST_ASSERT_FALSE(cache->read(N2kField::kTankLevel, 2, 20, 2000).found);
+  TEST_ASSERT_FALSE(cache->read(N2kField::kTankLevel, 0, 22, 2000).found);
+  TEST_ASSERT_FALSE(
+      cache->read(N2kField::kEngineSpeed, 0, kN2kAnySource, 2000).found);
+}
+
+void test_not_available_values_read_as_nan() {
+  cache->decode(EngineRapid(10, 0, N2kDoubleNA), 1000);
+  auto rpm = cache->read(N2kField::kEngineSpeed, 0, 10, 1000);
+  TEST_ASSERT_TRUE(rpm.found);
+  TEST_ASSERT_FLOAT_IS_NAN(rpm.value);
+}
+
+void test_other_pgns_are_ignored() {
+  tN2kMsg msg;
+  SetN2kEngineTripParameters(msg, 0, 100, 10, 12, 5);
+  TEST_ASSERT_FALSE(cache->decode(msg, 1000));
+}
+
+void test_oldest_entry_is_replaced_when_full() {
+  for (uint8_t i = 0; i < N2kPgnCache::kMaxEntries; i++) {
+    cache->decode(FuelLevel(20, i, i), 1000 + i);
+  }
+  // Instance 0 has the oldest entry
+  cache->decode(FuelLevel(20, 100, 99), 2000);
+
+  TEST_ASSERT_FALSE(cache->read(N2kField::kTankLevel, 0, 20, 2000).found);
+  TEST_ASSERT_TRUE(cache->read(N2kField::kTankLevel, 1, 20, 2000).found);
+  TEST_ASSERT_FLOAT_WITHIN(
+      0.01, 99, cache->read(N2kField::kTankLevel, 100, 20, 2000).value);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_replay_of_engine_and_speed_messages);
+  RUN_TEST(test_sequence_changes_on_update);
+  RUN_TEST(test_instance_and_source_select_the_entry);
+  RUN_TEST(test_not_available_values_read_as_nan);
+  RUN_TEST(test_other_pgns_are_ignored);
+  RUN_TEST(test_oldest_entry_is_replaced_when_full);
+  return UNITY_END();
+}
@@ -0,0 +1,108 @@
+#include <unity.h>
+
+#include "pulse_accumulator.h"
+
+using halmet::PulseAccumulator;
+
+// PulseCounter sets the PCNT high limit to this, so the counter runs from 0
+// to kCounterLimit - 1
+static const uint16_t kCounterLimit = 32767;
+
+/// The PCNT unit: counts pulses and restarts at 0 when it reaches the limit.
+class FakePcnt {
+ public:
+  void pulses(uint32_t count) {
+    count_ = (count_ + count) % kCounterLimit;
+  }
+  uint16_t count() const { return count_; }
+
+ protected:
+  uint16_t count_ = 0;
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_counts_without_a_wrap() {
+  PulseAccumulator accumulator(kCounterLimit);
+  FakePcnt pcnt;
+  pcnt.pulses(100);
+  TEST_ASSERT_EQUAL_UINT32(100, accumulator.update(pcnt.count()));
+  TEST_ASSERT_EQUAL_UINT32(0, accumulator.update(pcnt.count()));
+  pcnt.pulses(250);
+  TEST_ASSERT_EQUAL_UINT32(250, accumulator.update(pcnt.count()));
+  TEST_ASSERT_EQUAL_UINT64(350, accumulator.total());
+}
+
+void test_counts_across_a_wrap() {
+  PulseAccumulator accumulator(kCounterLimit);
+  FakePcnt pcnt;
+  pcnt.pulses(32000);
+  accumulator.update(pcnt.count());
+  pcnt.pulses(1000);
+  TEST_ASSERT_EQUAL_UINT16(233, pcnt.count());
+  TEST_ASSERT_EQUAL_UINT32(1000, accumulator.update(pcnt.count()));
+  TEST_ASSERT_EQUAL_UINT64(33000, accumulator.total());
+}
+
+void test_wrap_to_exactly_zero() {
+  PulseAccumulator accumulator(kCounterLimit);
+  FakePcnt pcnt;
+  pcnt.pulses(kCounterLimit - 1);
+  TEST_ASSERT_EQUAL_UINT32(kCounterLimit - 1,
+                           accumulator.update(pcnt.count()));
+  pcnt.pulses(1);
+  TEST_ASSERT_EQUAL_UINT16(0, pcnt.count());
+  TEST_ASSERT_EQUAL_UINT32(1, accumulator.update(pcnt.count()));
+}
+
+void test_largest_count_between_readings() {
+  // Up to kCounterLimit - 1 pulses between readings are counted
+  PulseAccumulator accumulator(kCounterLimit);
+  FakePcnt pcnt;
+  pcnt.pulses(12345);
+  accumulator.update(pcnt.count());
+  pcnt.pulses(kCounterLimit - 1);
+  TEST_ASSERT_EQUAL_UINT32(kCounterLimit - 1,
+                           accumulator.update(pcnt.count()));
+}
+
+void test_replay_of_a_fuel_flow_meter() {
+  // A flow meter at up to 30 kHz, read once a second for a day. The rate
+  // varies so that the readings fall on different counter values.
+  PulseAccumulator accumulator(kCounterLimit);
+  FakePcnt pcnt;
+  uint64_t expected = 0;
+  for (uint32_t second = 0; second < 86400; second++) {
+    uint32_t rate = 30000 - (second * 7919) % 29000;
+    pcnt.pulses(rate);
+    expected += rate;
+    TEST_ASSERT_EQUAL_UINT32(rate, accumulator.update(pcnt.count()));
+  }
+  TEST_ASSERT_EQUAL_UINT64(expected, accumulator.total());
+}
+
+void test_total_exceeds_32_bits() {
+  PulseAccumulator accumulator(kCounterLimit);
+  FakePcnt pcnt;
+  const uint32_t kStep = kCounterLimit - 1;
+  const uint32_t kReadings = 140000;  // about 4.6e9 pulses
+  for (uint32_t i = 0; i < kReadings; i++) {
+    pcnt.pulses(kStep);
+    accumulator.update(pcnt.count());
+  }
+  TEST_ASSERT_EQUAL_UINT64(static_cast<uint64_t>(kStep) * kReadings,
+                           accumulator.total());
+  TEST_ASSERT_TRUE(accumulator.total() > UINT32_MAX);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_counts_without_a_wrap);
+  RUN_TEST(test_counts_across_a_wrap);
+  RUN_TEST(test_wrap_to_exactly_zero);
+  RUN_TEST(test_largest_count_between_readings);
+  RUN_TEST(test_replay_of_a_fuel_flow_meter);
+  RUN_TEST(test_total_exceeds_32_bits);
+  return UNITY_END();
+}
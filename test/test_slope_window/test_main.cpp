@@ -0,0 +1,79 @@
+#include <unity.h>
+
+#include "slope_window.h"
+
+using halmet::SlopeWindow;
+
+static const uint32_t kMinute = 60000;
+
+void setUp() {}
+void tearDown() {}
+
+void test_fewer_than_two_samples_have_no_slope() {
+  SlopeWindow<16> window;
+  TEST_ASSERT_FLOAT_IS_NAN(window.slope());
+  TEST_ASSERT_FLOAT_IS_NAN(window.latest());
+  window.add(0, 50);
+  TEST_ASSERT_FLOAT_IS_NAN(window.slope());
+  TEST_ASSERT_EQUAL_FLOAT(50, window.latest());
+}
+
+void test_replay_of_a_tank_level_trace() {
+  // One sample a minute from a 70 l tank while the engine burns 3 l/h,
+  // with sloshing noise and two readings from the boat heeling over.
+  const float kNoise[] = {0.2, -0.1, 0.0, 0.3, -0.2, 0.1, -0.3, 0.0,
+                          0.1, -0.1, 0.2, 0.0, -0.2, 0.1, 0.0, -0.1};
+  SlopeWindow<16> window;
+  for (int i = 0; i < 16; i++) {
+    float volume = 50 - 3.0f * i / 60 + kNoise[i];
+    if (i == 5 || i == 11) {
+      volume -= 8;
+    }
+    window.add(i * kMinute, volume);
+  }
+  TEST_ASSERT_TRUE(window.full());
+  TEST_ASSERT_FLOAT_WITHIN(0.5, -3, window.slope());
+}
+
+void test_oldest_samples_are_replaced() {
+  SlopeWindow<4> window;
+  // A falling level, followed by a steady one that fills the window
+  for (int i = 0; i < 4; i++) {
+    window.add(i * kMinute, 40 - i);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.01, -60, window.slope());
+  for (int i = 4; i < 8; i++) {
+    window.add(i * kMinute, 30);
+  }
+  TEST_ASSERT_EQUAL_size_t(4, window.size());
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 0, window.slope());
+  TEST_ASSERT_EQUAL_FLOAT(30, window.latest());
+}
+
+void test_times_may_wrap_around() {
+  SlopeWindow<8> window;
+  uint32_t start = 0xffffffffUL - 3 * kMinute;
+  for (int i = 0; i < 8; i++) {
+    window.add(start + i * kMinute, 20 - 0.1f * i);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.01, -6, window.slope());
+}
+
+void test_clear_empties_the_window() {
+  SlopeWindow<4> window;
+  window.add(0, 1);
+  window.add(kMinute, 2);
+  window.clear();
+  TEST_ASSERT_EQUAL_size_t(0, window.size());
+  TEST_ASSERT_FLOAT_IS_NAN(window.slope());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fewer_than_two_samples_have_no_slope);
+  RUN_TEST(test_replay_of_a_tank_level_trace);
+  RUN_TEST(test_oldest_samples_are_replaced);
+  RUN_TEST(test_times_may_wrap_around);
+  RUN_TEST(test_clear_empties_the_window);
+  return UNITY_END();
+}
@@ -0,0 +1,94 @@
+#include <unity.h>
+
+#include <thread>
+
+#include "spsc_queue.h"
+
+using halmet::SpscQueue;
+
+void setUp() {}
+void tearDown() {}
+
+void test_pop_returns_items_in_order() {
+  SpscQueue<int, 4> queue;
+  TEST_ASSERT_TRUE(queue.empty());
+  TEST_ASSERT_TRUE(queue.push(1));
+  TEST_ASSERT_TRUE(queue.push(2));
+  TEST_ASSERT_EQUAL_size_t(2, queue.size());
+
+  int item = 0;
+  TEST_ASSERT_TRUE(queue.pop(item));
+  TEST_ASSERT_EQUAL_INT(1, item);
+  TEST_ASSERT_TRUE(queue.pop(item));
+  TEST_ASSERT_EQUAL_INT(2, item);
+  TEST_ASSERT_FALSE(queue.pop(item));
+}
+
+void test_push_fails_when_full() {
+  SpscQueue<int, 4> queue;
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_TRUE(queue.push(i));
+  }
+  TEST_ASSERT_FALSE(queue.push(4));
+  TEST_ASSERT_FALSE(queue.push(5));
+  TEST_ASSERT_EQUAL_size_t(2, queue.dropped());
+  TEST_ASSERT_EQUAL_size_t(4, queue.high_water_mark());
+
+  // The rejected items did not overwrite the queued ones
+  int item = -1;
+  TEST_ASSERT_TRUE(queue.pop(item));
+  TEST_ASSERT_EQUAL_INT(0, item);
+  TEST_ASSERT_TRUE(queue.push(6));
+}
+
+void test_indices_wrap_around_the_buffer() {
+  SpscQueue<int, 4> queue;
+  int item = 0;
+  for (int i = 0; i < 100; i++) {
+    TEST_ASSERT_TRUE(queue.push(i));
+    TEST_ASSERT_TRUE(queue.push(i + 1000));
+    TEST_ASSERT_TRUE(queue.pop(item));
+    TEST_ASSERT_EQUAL_INT(i, item);
+    TEST_ASSERT_TRUE(queue.pop(item));
+    TEST_ASSERT_EQUAL_INT(i + 1000, item);
+  }
+  TEST_ASSERT_EQUAL_size_t(2, queue.high_water_mark());
+  TEST_ASSERT_EQUAL_size_t(0, queue.dropped());
+}
+
+void test_producer_and_consumer_threads() {
+  static SpscQueue<uint32_t, 16> queue;
+  const uint32_t kItems = 200000;
+
+  std::thread producer([]() {
+    for (uint32_t i = 0; i < kItems; i++) {
+      while (!queue.push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t expected = 0;
+  uint32_t item;
+  while (expected < kItems) {
+    if (queue.pop(item)) {
+      // Every item arrives exactly once and in order
+      TEST_ASSERT_EQUAL_UINT32(expected, item);
+      expected++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  TEST_ASSERT_TRUE(queue.empty());
+  TEST_ASSERT_LESS_OR_EQUAL_size_t(16, queue.high_water_mark());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_pop_returns_items_in_order);
+  RUN_TEST(test_push_fails_when_full);
+  RUN_TEST(test_indices_wrap_around_the_buffer);
+  RUN_TEST(test_producer_and_consumer_threads);
+  return UNITY_END();
+}
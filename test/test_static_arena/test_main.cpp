@@ -0,0 +1,51 @@
+#include <unity.h>
+
+#include "static_arena.h"
+
+using halmet::StaticArena;
+
+alignas(8) static uint8_t buffer[64];
+
+void setUp() {}
+void tearDown() {}
+
+void test_allocations_are_aligned_and_counted() {
+  StaticArena arena(buffer, sizeof(buffer));
+
+  void* a = arena.allocate(3, 1);
+  void* b = arena.allocate(8, 8);
+
+  TEST_ASSERT_EQUAL_PTR(buffer, a);
+  TEST_ASSERT_EQUAL_PTR(buffer + 8, b);
+  TEST_ASSERT_EQUAL_size_t(16, arena.used());
+  TEST_ASSERT_EQUAL_size_t(48, arena.remaining());
+  TEST_ASSERT_EQUAL_size_t(2, arena.allocation_count());
+  TEST_ASSERT_TRUE(arena.contains(b));
+  TEST_ASSERT_FALSE(arena.overflowed());
+}
+
+void test_overflow_returns_null_and_keeps_usage() {
+  StaticArena arena(buffer, sizeof(buffer));
+  arena.allocate(60, 4);
+
+  TEST_ASSERT_NULL(arena.allocate(8, 4));
+  TEST_ASSERT_TRUE(arena.overflowed());
+  TEST_ASSERT_EQUAL_size_t(60, arena.used());
+  TEST_ASSERT_NOT_NULL(arena.allocate(4, 4));
+  TEST_ASSERT_EQUAL_size_t(0, arena.remaining());
+}
+
+void test_empty_arena_rejects_everything() {
+  StaticArena arena(nullptr, 0);
+
+  TEST_ASSERT_NULL(arena.allocate(1, 1));
+  TEST_ASSERT_TRUE(arena.overflowed());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_allocations_are_aligned_and_counted);
+  RUN_TEST(test_overflow_returns_null_and_keeps_usage);
+  RUN_TEST(test_empty_arena_rejects_everything);
+  return UNITY_END();
+}
@@ -0,0 +1,189 @@
+#include <math.h>
+#include <unity.h>
+
+#include "tacho_sweep.h"
+#include "virtual_clock.h"
+
+using halmet::TachoSweep;
+using halmet::TachoSweepResult;
+using halmet::test::VirtualClock;
+using halmet::test::VirtualEventLoop;
+
+// Tacho pulses per engine revolution times 60, as set in the web UI
+static const float kMultiplier = 0.5;
+
+/**
+ * The test output wired to a tacho input. The reading follows the output
+ * frequency with a first-order lag and is reported every 100 ms, like the
+ * rapid sender's engine speed.
+ */
+class FakeTacho {
+ public:
+  FakeTacho(float lag_ms, float gain_error = 0)
+      : lag_ms_{lag_ms}, gain_error_{gain_error} {}
+
+  float sample(float output_hz, float dt_ms) {
+    float target = output_hz * kMultiplier * (1 + gain_error_);
+    if (!connected_) {
+      target = 0;
+    }
+    reading_ += (target - reading_) * (1 - expf(-dt_ms / lag_ms_));
+    return reading_;
+  }
+
+  void set_connected(bool connected) { connected_ = connected; }
+
+ protected:
+  float lag_ms_;
+  float gain_error_;
+  bool connected_ = true;
+  float reading_ = 0;
+};
+
+static VirtualClock* clock_;
+static VirtualEventLoop* loop;
+
+void setUp() {
+  clock_ = new VirtualClock(5000);
+  loop = new VirtualEventLoop(clock_);
+}
+
+void tearDown() {
+  delete loop;
+  delete clock_;
+}
+
+// Run the sweep as TachoSelfTest does: the tacho value is observed and the
+// timeout checked every 100 ms, until the sweep ends or max_ms pass.
+static void RunSweep(TachoSweep* sweep, FakeTacho* tacho, uint32_t max_ms) {
+  loop->onRepeat(100, [sweep, tacho]() {
+    sweep->observe(clock_->now(), tacho->sample(sweep->output_hz(), 100));
+    sweep->tick(clock_->now());
+  });
+  uint32_t start = clock_->now();
+  while (sweep->running() && clock_->now() - start < max_ms) {
+    loop->run_for(100);
+  }
+}
+
+void test_idle_sweep_does_nothing() {
+  TachoSweep sweep(kMultiplier);
+  sweep.add_rpm_range(600, 3600, 6);
+  TEST_ASSERT_FALSE(sweep.running());
+  TEST_ASSERT_EQUAL_FLOAT(0, sweep.output_hz());
+  sweep.observe(clock_->now(), 10);
+  sweep.tick(clock_->now() + 60000);
+  TEST_ASSERT_EQUAL(0, sweep.num_results());
+}
+
+void test_rpm_range_steps() {
+  TachoSweep sweep(kMultiplier);
+  sweep.add_rpm_range(600, 3600, 6);
+  sweep.start(clock_->now());
+  // 600 rpm is 10 Hz at the tacho, 20 Hz at the test output
+  TEST_ASSERT_EQUAL_FLOAT(20, sweep.output_hz());
+  TEST_ASSERT_EQUAL_FLOAT(10, sweep.result(0).expected_hz);
+}
+
+void test_sweep_measures_settling_time() {
+  TachoSweep sweep(kMultiplier);
+  sweep.add_rpm_range(600, 3600, 6);
+  FakeTacho tacho(300);
+  sweep.start(clock_->now());
+  RunSweep(&sweep, &tacho, 60000);
+
+  TEST_ASSERT_FALSE(sweep.running());
+  TEST_ASSERT_EQUAL_FLOAT(0, sweep.output_hz());
+  TEST_ASSERT_EQUAL(6, sweep.num_results());
+  // Within 2 % of 10 Hz from 0 after ln(50) lag time constants, 1.17 s,
+  // first seen at the 1.2 s sample
+  TEST_ASSERT_EQUAL_UINT32(1200, sweep.result(0).settle_ms);
+  for (size_t i = 1; i < sweep.num_results(); i++) {
+    // The later steps start 10 Hz below their target instead of from 0,
+    // so they settle sooner
+    const TachoSweepResult& result = sweep.result(i);
+    TEST_ASSERT_TRUE(result.settled);
+    TEST_ASSERT_TRUE(result.settle_ms >= 100);
+    TEST_ASSERT_TRUE(result.settle_ms < sweep.result(0).settle_ms);
+    TEST_ASSERT_EQUAL_UINT32(0, result.settle_ms % 100);
+    TEST_ASSERT_FLOAT_WITHIN(0.02, 0, result.error);
+  }
+}
+
+void test_sweep_measures_the_gain_error() {
+  // A tacho that follows within one sample reads 0.5 % high at every step
+  TachoSweep sweep(kMultiplier);
+  sweep.add_rpm_range(600, 3600, 6);
+  FakeTacho tacho(10, 0.005);
+  sweep.start(clock_->now());
+  RunSweep(&sweep, &tacho, 60000);
+
+  TEST_ASSERT_EQUAL(6, sweep.num_results());
+  for (size_t i = 0; i < sweep.num_results(); i++) {
+    const TachoSweepResult& result = sweep.result(i);
+    TEST_ASSERT_TRUE(result.settled);
+    TEST_ASSERT_EQUAL_UINT32(100, result.settle_ms);
+    TEST_ASSERT_FLOAT_WITHIN(0.0002, 0.005, result.error);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, result.expected_hz * 1.005,
+                             result.measured_hz);
+  }
+}
+
+void test_disconnected_tacho_times_out_each_step() {
+  TachoSweep sweep(kMultiplier, 0.02, 10000);
+  sweep.add_rpm_range(600, 1800, 3);
+  FakeTacho tacho(300);
+  tacho.set_connected(false);
+  uint32_t start = clock_->now();
+  sweep.start(start);
+  RunSweep(&sweep, &tacho, 60000);
+
+  TEST_ASSERT_FALSE(sweep.running());
+  TEST_ASSERT_EQUAL(3, sweep.num_results());
+  for (size_t i = 0; i < 3; i++) {
+    TEST_ASSERT_FALSE(sweep.result(i).settled);
+    TEST_ASSERT_EQUAL_UINT32(10000, sweep.result(i).settle_ms);
+    TEST_ASSERT_TRUE(isnan(sweep.result(i).measured_hz));
+  }
+  TEST_ASSERT_EQUAL_UINT32(30000, clock_->now() - start);
+}
+
+void test_restart_clears_the_results() {
+  TachoSweep sweep(kMultiplier);
+  sweep.add_rpm_range(600, 1200, 2);
+  FakeTacho tacho(100);
+  sweep.start(clock_->now());
+  RunSweep(&sweep, &tacho, 60000);
+  TEST_ASSERT_EQUAL(2, sweep.num_results());
+
+  sweep.start(clock_->now());
+  TEST_ASSERT_TRUE(sweep.running());
+  TEST_ASSERT_EQUAL(1, sweep.num_results());
+  TEST_ASSERT_FALSE(sweep.result(0).settled);
+}
+
+void test_sweep_across_millis_wraparound() {
+  clock_->set(UINT32_MAX - 2000);
+  TachoSweep sweep(kMultiplier);
+  sweep.add_rpm_range(600, 3600, 6);
+  FakeTacho tacho(300);
+  sweep.start(clock_->now());
+  RunSweep(&sweep, &tacho, 60000);
+  TEST_ASSERT_EQUAL(6, sweep.num_results());
+  for (size_t i = 0; i < sweep.num_results(); i++) {
+    TEST_ASSERT_TRUE(sweep.result(i).settled);
+    TEST_ASSERT_TRUE(sweep.result(i).settle_ms <= 1200);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_idle_sweep_does_nothing);
+  RUN_TEST(test_rpm_range_steps);
+  RUN_TEST(test_sweep_measures_settling_time);
+  RUN_TEST(test_sweep_measures_the_gain_error);
+  RUN_TEST(test_disconnected_tacho_times_out_each_step);
+  RUN_TEST(test_restart_clears_the_results);
+  RUN_TEST(test_sweep_across_millis_wraparound);
+  return UNITY_END();
+}
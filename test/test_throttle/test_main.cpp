@@ -0,0 +1,202 @@
+#include <unity.h>
+
+#include <memory>
+#include <vector>
+
+#include "throttle_timing.h"
+#include "virtual_clock.h"
+
+using halmet::ThrottleTiming;
+using halmet::test::VirtualClock;
+using halmet::test::VirtualEventLoop;
+
+// Poll interval of the shared throttle timer for a 1 s display throttle
+static const uint32_t kPollMs = 250;
+
+/// A Throttle<int> on the virtual clock: records what it emits and when.
+class FakeThrottle {
+ public:
+  FakeThrottle(VirtualClock* clock, uint32_t interval_ms,
+               uint32_t max_wait_ms = 0)
+      : clock_{clock}, timing_{interval_ms, max_wait_ms} {}
+
+  void set(int input) {
+    inputs_++;
+    held_ = input;
+    if (timing_.input(clock_->now())) {
+      emit();
+    }
+  }
+
+  void poll() {
+    if (timing_.poll(clock_->now())) {
+      emit();
+    }
+  }
+
+  struct Emission {
+    uint32_t time_ms;
+    int value;
+  };
+
+  const std::vector<Emission>& emissions() const { return emissions_; }
+  uint32_t inputs() const { return inputs_; }
+  const ThrottleTiming& timing() const { return timing_; }
+
+ protected:
+  void emit() { emissions_.push_back({clock_->now(), held_}); }
+
+  VirtualClock* clock_;
+  ThrottleTiming timing_;
+  int held_ = 0;
+  uint32_t inputs_ = 0;
+  std::vector<Emission> emissions_;
+};
+
+static VirtualClock* clock_;
+static VirtualEventLoop* loop;
+
+void setUp() {
+  clock_ = new VirtualClock();
+  loop = new VirtualEventLoop(clock_);
+}
+
+void tearDown() {
+  delete loop;
+  delete clock_;
+}
+
+// Feed count inputs, 1, 2, ..., every period_ms
+static void Burst(FakeThrottle* throttle, uint32_t period_ms, int count) {
+  auto next = std::make_shared<int>(1);
+  loop->onRepeat(period_ms, [throttle, next, count]() {
+    if (*next <= count) {
+      throttle->set((*next)++);
+    }
+  });
+}
+
+void test_single_input_is_emitted_at_once() {
+  FakeThrottle throttle(clock_, 1000);
+  loop->onRepeat(kPollMs, [&throttle]() { throttle.poll(); });
+  clock_->set(100);
+  throttle.set(7);
+  loop->run_for(5000);
+  TEST_ASSERT_EQUAL(1, throttle.emissions().size());
+  TEST_ASSERT_EQUAL_UINT32(100, throttle.emissions()[0].time_ms);
+  TEST_ASSERT_EQUAL(7, throttle.emissions()[0].value);
+  TEST_ASSERT_EQUAL_UINT32(0, throttle.timing().dropped());
+  TEST_ASSERT_EQUAL_UINT32(0, throttle.timing().coalesced());
+}
+
+void test_burst_emits_leading_max_wait_and_trailing_edges() {
+  // 40 inputs at 40 ms intervals, from 40 to 1600 ms
+  FakeThrottle throttle(clock_, 1000);
+  Burst(&throttle, 40, 40);
+  loop->onRepeat(kPollMs, [&throttle]() { throttle.poll(); });
+  loop->run_for(5000);
+
+  const auto& emissions = throttle.emissions();
+  TEST_ASSERT_EQUAL(3, emissions.size());
+  // Leading edge
+  TEST_ASSERT_EQUAL_UINT32(40, emissions[0].time_ms);
+  TEST_ASSERT_EQUAL(1, emissions[0].value);
+  // The input that arrives when the maximum wait has passed
+  TEST_ASSERT_EQUAL_UINT32(1040, emissions[1].time_ms);
+  TEST_ASSERT_EQUAL(26, emissions[1].value);
+  // The last input is not lost: emitted at the first poll after the
+  // maximum wait from 1040 ms
+  TEST_ASSERT_EQUAL_UINT32(2250, emissions[2].time_ms);
+  TEST_ASSERT_EQUAL(40, emissions[2].value);
+
+  TEST_ASSERT_EQUAL_UINT32(2, throttle.timing().coalesced());
+  TEST_ASSERT_EQUAL_UINT32(throttle.inputs() - emissions.size(),
+                           throttle.timing().dropped());
+  TEST_ASSERT_FALSE(throttle.timing().pending());
+}
+
+void test_trailing_edge_follows_the_end_of_a_short_burst() {
+  // 5 inputs from 100 to 500 ms, well inside the maximum wait
+  FakeThrottle throttle(clock_, 1000, 5000);
+  Burst(&throttle, 100, 5);
+  loop->onRepeat(kPollMs, [&throttle]() { throttle.poll(); });
+  loop->run_for(5000);
+
+  const auto& emissions = throttle.emissions();
+  TEST_ASSERT_EQUAL(2, emissions.size());
+  TEST_ASSERT_EQUAL(1, emissions[0].value);
+  TEST_ASSERT_EQUAL(5, emissions[1].value);
+  // The quiet period ends 1000 ms after the last input at 500 ms
+  TEST_ASSERT_TRUE(emissions[1].time_ms >= 1500);
+  TEST_ASSERT_TRUE(emissions[1].time_ms <= 1500 + kPollMs);
+  TEST_ASSERT_EQUAL_UINT32(3, throttle.timing().dropped());
+}
+
+void test_steady_stream_is_emitted_every_max_wait() {
+  FakeThrottle throttle(clock_, 500, 2000);
+  Burst(&throttle, 100, 1000);
+  loop->onRepeat(kPollMs, [&throttle]() { throttle.poll(); });
+  loop->run_for(20000);
+
+  const auto& emissions = throttle.emissions();
+  TEST_ASSERT_EQUAL(10, emissions.size());
+  for (size_t i = 1; i < emissions.size(); i++) {
+    TEST_ASSERT_EQUAL_UINT32(2000,
+                             emissions[i].time_ms - emissions[i - 1].time_ms);
+    // Always the latest input, never a stale one
+    TEST_ASSERT_EQUAL(static_cast<int>(emissions[i].time_ms / 100),
+                      emissions[i].value);
+  }
+}
+
+void test_throttles_sharing_one_poll_timer() {
+  // A display row and a Signal K output, checked by one timer at a quarter
+  // of the shorter interval
+  FakeThrottle display(clock_, 1000);
+  FakeThrottle output(clock_, 5000);
+  Burst(&display, 30, 50);
+  Burst(&output, 70, 50);
+  loop->onRepeat(kPollMs, [&display, &output]() {
+    display.poll();
+    output.poll();
+  });
+  loop->run_for(30000);
+
+  // Each ends on its last input, within a poll interval of its trailing
+  // or max-wait deadline
+  TEST_ASSERT_EQUAL(50, display.emissions().back().value);
+  TEST_ASSERT_EQUAL(50, output.emissions().back().value);
+  TEST_ASSERT_TRUE(display.emissions().back().time_ms <= 1500 + 1000);
+  TEST_ASSERT_TRUE(output.emissions().back().time_ms <= 5000 + kPollMs);
+  TEST_ASSERT_EQUAL_UINT32(
+      display.inputs() + output.inputs(),
+      display.emissions().size() + output.emissions().size() +
+          display.timing().dropped() + output.timing().dropped());
+}
+
+void test_throttle_across_millis_wraparound() {
+  clock_->set(UINT32_MAX - 500);
+  FakeThrottle throttle(clock_, 1000, 5000);
+  Burst(&throttle, 100, 5);
+  loop->onRepeat(kPollMs, [&throttle]() { throttle.poll(); });
+  loop->run_for(5000);
+
+  const auto& emissions = throttle.emissions();
+  TEST_ASSERT_EQUAL(2, emissions.size());
+  TEST_ASSERT_EQUAL(5, emissions[1].value);
+  // As in test_trailing_edge_follows_the_end_of_a_short_burst
+  uint32_t trailing_ms = emissions[1].time_ms - (UINT32_MAX - 500);
+  TEST_ASSERT_TRUE(trailing_ms >= 1500);
+  TEST_ASSERT_TRUE(trailing_ms <= 1500 + kPollMs);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_input_is_emitted_at_once);
+  RUN_TEST(test_burst_emits_leading_max_wait_and_trailing_edges);
+  RUN_TEST(test_trailing_edge_follows_the_end_of_a_short_burst);
+  RUN_TEST(test_steady_stream_is_emitted_every_max_wait);
+  RUN_TEST(test_throttles_sharing_one_poll_timer);
+  RUN_TEST(test_throttle_across_millis_wraparound);
+  return UNITY_END();
+}
@@ -0,0 +1,68 @@
+#include <unity.h>
+
+#include "n2k_tx_budget.h"
+
+using halmet::N2kFrameCount;
+using halmet::N2kTxBudget;
+
+void setUp() {}
+void tearDown() {}
+
+void test_frame_count() {
+  TEST_ASSERT_EQUAL_UINT8(1, N2kFrameCount(0));
+  TEST_ASSERT_EQUAL_UINT8(1, N2kFrameCount(8));
+  // Fast packet: 6 bytes in the first frame, 7 in each following one
+  TEST_ASSERT_EQUAL_UINT8(2, N2kFrameCount(9));
+  TEST_ASSERT_EQUAL_UINT8(2, N2kFrameCount(13));
+  TEST_ASSERT_EQUAL_UINT8(3, N2kFrameCount(14));
+  TEST_ASSERT_EQUAL_UINT8(4, N2kFrameCount(26));
+  TEST_ASSERT_EQUAL_UINT8(32, N2kFrameCount(223));
+}
+
+void test_fast_senders_count_once_per_stall_period() {
+  N2kTxBudget budget;
+  budget.add({127488, 1, 100});  // fires twice within the stall
+  budget.add({127489, 4, 500});
+  budget.add({127505, 1, 2500});
+
+  TEST_ASSERT_EQUAL_size_t(3, budget.senders());
+  TEST_ASSERT_EQUAL_size_t(2 + 4 + 1, budget.burst_frames());
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 10 + 8 + 0.4, budget.frames_per_second());
+  TEST_ASSERT_EQUAL_size_t((7 + N2kTxBudget::kLibraryReserveFrames) * 3 / 2,
+                           budget.required_buffer_frames());
+  TEST_ASSERT_EQUAL_size_t(budget.required_buffer_frames(),
+                           budget.buffer_frames());
+  TEST_ASSERT_FALSE(budget.may_overflow());
+}
+
+void test_zero_period_counts_the_sender_only() {
+  N2kTxBudget budget;
+  budget.add({127488, 1, 0});
+  TEST_ASSERT_EQUAL_size_t(1, budget.senders());
+  TEST_ASSERT_EQUAL_size_t(0, budget.burst_frames());
+}
+
+void test_buffer_is_clamped() {
+  N2kTxBudget empty;
+  TEST_ASSERT_EQUAL_size_t(N2kTxBudget::kLibraryReserveFrames * 3 / 2,
+                           empty.buffer_frames());
+
+  N2kTxBudget busy;
+  for (int i = 0; i < 20; i++) {
+    busy.add({130000u + i, 10, 10});
+  }
+  TEST_ASSERT_TRUE(busy.required_buffer_frames() >
+                   N2kTxBudget::kMaxBufferFrames);
+  TEST_ASSERT_EQUAL_size_t(N2kTxBudget::kMaxBufferFrames,
+                           busy.buffer_frames());
+  TEST_ASSERT_TRUE(busy.may_overflow());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_frame_count);
+  RUN_TEST(test_fast_senders_count_once_per_stall_period);
+  RUN_TEST(test_zero_period_counts_the_sender_only);
+  RUN_TEST(test_buffer_is_clamped);
+  return UNITY_END();
+}
@@ -0,0 +1,47 @@
+#include <unity.h>
+
+#include <vector>
+
+#include "virtual_clock.h"
+
+using halmet::test::VirtualClock;
+using halmet::test::VirtualEventLoop;
+
+void setUp() {}
+void tearDown() {}
+
+void test_timers_fire_in_deadline_order() {
+  VirtualClock clock;
+  VirtualEventLoop loop(&clock);
+  std::vector<uint32_t> fast, slow;
+  loop.onRepeat(100, [&]() { fast.push_back(clock.now()); });
+  loop.onRepeat(250, [&]() { slow.push_back(clock.now()); });
+
+  loop.run_until(1000);
+
+  TEST_ASSERT_EQUAL_size_t(10, fast.size());
+  TEST_ASSERT_EQUAL_size_t(4, slow.size());
+  TEST_ASSERT_EQUAL_UINT32(100, fast.front());
+  TEST_ASSERT_EQUAL_UINT32(1000, fast.back());
+  TEST_ASSERT_EQUAL_UINT32(250, slow.front());
+  TEST_ASSERT_EQUAL_UINT32(1000, clock.now());
+}
+
+void test_timers_run_across_wrap() {
+  VirtualClock clock(0xffffff00);
+  VirtualEventLoop loop(&clock);
+  int calls = 0;
+  loop.onRepeat(100, [&]() { calls++; });
+
+  loop.run_for(1000);
+
+  TEST_ASSERT_EQUAL_INT(10, calls);
+  TEST_ASSERT_EQUAL_UINT32(0xffffff00 + 1000, clock.now());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_timers_fire_in_deadline_order);
+  RUN_TEST(test_timers_run_across_wrap);
+  return UNITY_END();
+}
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""Convert a HALMET data log download to CSV.
+
+Usage: tools/datalog_decode.py <datalog.bin> [output.csv]
+
+Download the log from http://<halmet>/datalog. The format is described in
+src/data_logger.h: a sequence of sectors, each a 64 byte header followed
+by one signed byte per channel and record.
+"""
+
+import csv
+import struct
+import sys
+
+MAGIC = 0x31474C48
+HEADER = struct.Struct("<IIIIHHBBH4h4f16x")
+MISSING = -128
+NO_KEYFRAME = -32768
+
+# Channel order as connected in src/main.cpp
+CHANNEL_NAMES = ("rpm", "coolant_temperature_K", "oil_pressure_bar",
+                 "exhaust_temperature_K")
+# The tacho channel logs the frequency in Hz; convert to rpm.
+CHANNEL_FACTORS = (60.0, 1.0, 1.0, 1.0)
+
+
+def decode(data):
+    pos = 0
+    while pos + HEADER.size <= len(data):
+        (magic, sequence, uptime_ms, unix_time, interval_ms, record_count,
+         channels, record_size, _, *rest) = HEADER.unpack_from(data, pos)
+        keyframe, scale = rest[:4], rest[4:]
+        if magic != MAGIC or channels != 4 or record_size != channels:
+            raise ValueError("invalid sector header at offset %d" % pos)
+        pos += HEADER.size
+
+        running = [None if k == NO_KEYFRAME else k for k in keyframe]
+        for index in range(record_count):
+            record = struct.unpack_from("<4b", data, pos)
+            pos += record_size
+            values = []
+            for ch, delta in enumerate(record):
+                if delta == MISSING:
+                    values.append(None)
+                    continue
+                running[ch] = (running[ch] or 0) + delta
+                values.append(running[ch] / scale[ch] * CHANNEL_FACTORS[ch])
+            offset_ms = index * interval_ms
+            time = unix_time + offset_ms / 1000.0 if unix_time else None
+            yield (sequence, (uptime_ms + offset_ms) / 1000.0, time, values)
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        print(__doc__, file=sys.stderr)
+        return 1
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+    out = open(sys.argv[2], "w", newline="") if len(sys.argv) == 3 \
+        else sys.stdout
+    writer = csv.writer(out)
+    writer.writerow(("sector", "uptime_s", "unix_time") + CHANNEL_NAMES)
+    for sequence, uptime, time, values in decode(data):
+        writer.writerow([sequence, "%.3f" % uptime,
+                         "" if time is None else "%.3f" % time] +
+                        ["" if v is None else "%.2f" % v for v in values])
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Compare HALMET hot path benchmark results with a baseline.
+
+Usage: tools/hot_path_check.py [--baseline FILE] [--threshold PCT] [--update]
+                               <serial log> | --native
+
+The firmware built with ENABLE_HOT_PATH_BENCHMARK prints one line starting
+with "HOT_PATH_BENCHMARK " at boot, followed by the cycle counts as JSON.
+Capture the serial output, e.g. with "pio device monitor | tee boot.log",
+and pass the log ("-" for stdin).
+
+--native instead runs the host harness in test/test_hot_path, which times
+the per-sample code that does not need the Arduino core, in ns per call.
+It is run several times and the fastest time of each path is kept, since
+other processes only ever add time.
+
+The check fails if any path is slower than its baseline by more than the
+threshold percentage. Paths missing from the baseline are reported but do
+not fail. The baseline is tools/hot_path_baseline_<target>.json, where the
+target is "esp32" or "native". The native baseline is committed; it was
+measured on a desktop x86-64 machine, so regenerate it with --update when
+checking on a different machine. --update writes the results as the new
+baseline.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+MARKER = "HOT_PATH_BENCHMARK "
+NATIVE_RUNS = 3
+# Host timings vary more between runs than the cycle counts on the board
+DEFAULT_THRESHOLD = {"esp32": 10.0, "native": 25.0}
+
+
+def read_results(stream):
+    results = None
+    for line in stream:
+        index = line.find(MARKER)
+        if index >= 0:
+            results = json.loads(line[index + len(MARKER):])
+    return results
+
+
+def run_native():
+    """Run the host harness NATIVE_RUNS times and keep the fastest times."""
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    results = None
+    for _ in range(NATIVE_RUNS):
+        output = subprocess.run(
+            ["pio", "test", "-e", "native", "-f", "test_hot_path", "-v"],
+            cwd=root, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+            universal_newlines=True, check=False).stdout
+        run = read_results(output.splitlines())
+        if run is None:
+            sys.stderr.write(output)
+            return None
+        if results is None:
+            results = run
+            continue
+        for name, value in run["ns"].items():
+            results["ns"][name] = min(value, results["ns"].get(name, value))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", nargs="?")
+    parser.add_argument("--native", action="store_true",
+                        help="run the host harness instead of reading a log")
+    parser.add_argument("--baseline",
+                        help="baseline file (default "
+                        "tools/hot_path_baseline_<target>.json)")
+    parser.add_argument("--threshold", type=float,
+                        help="allowed slowdown in percent (default 10 on "
+                        "the board, 25 on the host)")
+    parser.add_argument("--update", action="store_true",
+                        help="store the results as the new baseline")
+    args = parser.parse_args()
+    if args.native == (args.log is not None):
+        parser.error("pass either a log or --native")
+
+    if args.native:
+        results = run_native()
+    elif args.log == "-":
+        results = read_results(sys.stdin)
+    else:
+        with open(args.log, errors="replace") as f:
+            results = read_results(f)
+    if results is None:
+        print("error: no %s line found" % MARKER.strip(), file=sys.stderr)
+        return 1
+
+    target = results.get("target", "esp32")
+    unit = "ns" if "ns" in results else "cycles"
+    if args.baseline is None:
+        args.baseline = os.path.join(os.path.dirname(__file__),
+                                     "hot_path_baseline_%s.json" % target)
+    if args.threshold is None:
+        args.threshold = DEFAULT_THRESHOLD.get(target, 10.0)
+
+    if args.update:
+        with open(args.baseline, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("baseline written to %s" % args.baseline)
+        return 0
+
+    if not os.path.exists(args.baseline):
+        print("error: no baseline %s; create it with --update" %
+              args.baseline, file=sys.stderr)
+        return 1
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    if baseline.get("cpu_mhz") != results.get("cpu_mhz"):
+        print("warning: CPU clock %s MHz, baseline %s MHz" %
+              (results.get("cpu_mhz"), baseline.get("cpu_mhz")),
+              file=sys.stderr)
+
+    regressions = []
+    print("%-26s %10s %10s %8s" % ("path", "baseline", unit, "change"))
+    for name, cycles in results[unit].items():
+        base = baseline[unit].get(name)
+        if base is None:
+            print("%-26s %10s %10.1f %8s" % (name, "-", cycles, "new"))
+            continue
+        change = 100.0 * (cycles - base) / base if base > 0 else 0.0
+        print("%-26s %10.1f %10.1f %+7.1f%%" % (name, base, cycles, change))
+        if change > args.threshold:
+            regressions.append(name)
+
+    for name in regressions:
+        print("error: %s regressed by more than %.0f%%" %
+              (name, args.threshold), file=sys.stderr)
+    return 2 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
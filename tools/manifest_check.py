@@ -0,0 +1,469 @@
+#!/usr/bin/env python3
+"""Validate a HALMET channel manifest and estimate its RAM and timer cost.
+
+Usage: tools/manifest_check.py [--no-signalk] [--no-n2k] [--no-onewire]
+                              [--fuel-flow-meter] [--max-latency MS]
+                              [--arena-size BYTES] [--node-bytes LOG]
+                              <channels.json>
+
+The validation rules match BuildGraphFromManifest() in
+src/channel_manifest.cpp. The cost estimate counts the graph nodes each
+channel allocates, the strings it formats into the graph arena and the
+ReactESP repeat events it registers.
+
+The built-in per-node byte counts are rough ESP32 estimates, not measured
+sizes. A firmware built with ENABLE_STATIC_ARENA logs a GRAPH_NODE_BYTES line
+at the end of setup() with the sizeof of each node kind; pass a log
+containing it with --node-bytes to use those sizes instead. The string
+sizes are exact: test/test_channel_strings checks CHANNEL_STRING_BYTES
+against src/halmet_channels.h.
+
+The arena line compares the estimate with the arena size, STATIC_ARENA_SIZE
+in src/graph_arena.h unless --arena-size is given. The check fails if the
+channels alone would not fit. The firmware halts at boot when the arena
+overflows, so leave a margin when sizing it from estimated node sizes.
+
+The latency column is the worst case from an input change to the NMEA 2000
+message carrying it: the input's read or averaging interval plus the sender
+period. With --max-latency, the check fails if any channel exceeds it. The
+firmware built with ENABLE_LATENCY_PROBES logs the measured latency from the
+hardware read (for the tacho, the start of the counting window) to the
+message; test/test_latency_replay replays the same timing on the host.
+"""
+
+import argparse
+import json
+import sys
+
+RESISTIVE_TYPES = ("tank", "temperature", "oil_pressure")
+ADC_TYPES = RESISTIVE_TYPES + ("voltage",)
+INPUT_TYPES = ("tacho", "alarm")
+KNOWN_TYPES = ADC_TYPES + INPUT_TYPES + ("onewire",)
+MAX_ENGINES = 2
+# OLED rows 0 and 1 show the hostname and IP address
+DISPLAY_ROWS = range(2, 8)
+# Digital input counting the fuel flow meter with ENABLE_FUEL_FLOW_METER
+FUEL_FLOW_METER_INPUT = 4
+ENGINE_FLAGS = (
+    "over_temperature", "low_oil_pressure", "low_oil_level",
+    "low_fuel_pressure", "low_system_voltage", "low_coolant_level",
+    "water_flow", "water_in_fuel", "charge_indicator", "preheat_indicator",
+)
+
+# Estimated bytes per node. Replaced by the sizes the firmware logs when
+# --node-bytes is given; see LogGraphNodeBytes() in src/channel_manifest.cpp.
+NODE_BYTES = {
+    "sensor": 120,
+    "sk_output": 280,  # SKOutputFloat + SKMetadata
+    "curve": 260,      # CurveInterpolator
+    "linear": 120,
+    "lambda": 64,
+    "repeat_expiring": 112,
+    "n2k_sender": 200,
+    "display_row": 64,
+    "demand_gate": 64,
+    "throttle": 96,
+}
+# Nodes the senders allocate on the heap with std::make_shared, outside the
+# graph arena.
+HEAP_NODES = ("repeat_expiring",)
+# Prefix of the node size line logged at boot
+NODE_BYTES_TAG = "GRAPH_NODE_BYTES "
+
+# Bytes of the strings expanded into the graph arena for each resistive
+# sender and tacho channel from the HALMET_*_CHANNEL_STRINGS lists in
+# src/halmet_channels.h: fixed characters, characters per character of the
+# name and per character of the sk_id.
+CHANNEL_STRING_BYTES = {
+    "tank": (703, 24, 4),
+    "temperature": (542, 16, 3),
+    "oil_pressure": (564, 16, 3),
+    "tacho": (152, 7, 0),
+}
+
+# Default size of the graph arena, STATIC_ARENA_SIZE in src/graph_arena.h.
+DEFAULT_ARENA_SIZE = 24576
+# Allocations in the arena are aligned to the largest member alignment.
+ARENA_ALIGNMENT = 8
+
+# Transmission periods of the NMEA 2000 senders in src/n2k_senders.h, in ms.
+DYNAMIC_SENDER_PERIOD = 500
+RAPID_SENDER_PERIOD = 100
+SLOW_SENDER_PERIOD = 2500  # fluid level, bilge alarm, exhaust temperature
+
+# Number of RepeatExpiring inputs in each engine sender.
+DYNAMIC_SENDER_INPUTS = 34
+RAPID_SENDER_INPUTS = 3
+
+
+def align(size):
+    return (size + ARENA_ALIGNMENT - 1) // ARENA_ALIGNMENT * ARENA_ALIGNMENT
+
+
+class Cost:
+    def __init__(self):
+        self.bytes = 0
+        self.arena_bytes = 0  # bytes plus alignment padding
+        self.timers = 0
+        self.firings_per_s = 0.0
+        self.latency_ms = None
+
+    def path(self, *intervals_ms):
+        latency = sum(intervals_ms)
+        if self.latency_ms is None or latency > self.latency_ms:
+            self.latency_ms = latency
+
+    def node(self, kind, count=1):
+        self.bytes += NODE_BYTES[kind] * count
+        if kind not in HEAP_NODES:
+            self.arena_bytes += align(NODE_BYTES[kind]) * count
+
+    def text(self, *strings):
+        """Strings copied into the graph arena with Format() or
+        GraphStrdup()."""
+        for string in strings:
+            self.bytes += len(string) + 1
+            self.arena_bytes += len(string) + 1
+
+    def channel_strings(self, kind, name, sk_id):
+        fixed, per_name, per_sk_id = CHANNEL_STRING_BYTES[kind]
+        size = fixed + per_name * len(name) + per_sk_id * len(sk_id)
+        self.bytes += size
+        self.arena_bytes += size
+
+    def timer(self, interval_ms, count=1):
+        self.timers += count
+        self.firings_per_s += count * 1000.0 / interval_ms
+
+
+def read_node_bytes(log_path):
+    """The node sizes from the last GRAPH_NODE_BYTES line in a boot log."""
+    sizes = None
+    with open(log_path, errors="replace") as f:
+        for line in f:
+            start = line.find(NODE_BYTES_TAG)
+            if start >= 0:
+                text = line[start + len(NODE_BYTES_TAG):]
+                sizes = json.loads(text[:text.rfind("}") + 1])
+    if sizes is None:
+        raise ValueError("no %s line in %s; build with ENABLE_STATIC_ARENA" %
+                         (NODE_BYTES_TAG.strip(), log_path))
+    missing = set(NODE_BYTES) - set(sizes)
+    if missing:
+        raise ValueError("%s in %s lacks %s" % (
+            NODE_BYTES_TAG.strip(), log_path, ", ".join(sorted(missing))))
+    return sizes
+
+
+def is_int(value):
+    """An integer in the JSON sense; ArduinoJson does not take true as 1."""
+    return isinstance(value, int) and not isinstance(value, bool)
+
+
+def is_number(value):
+    return isinstance(value, (int, float)) and not isinstance(value, bool)
+
+
+def channel_name(ch):
+    """The name the channel's config paths are derived from."""
+    if ch.get("type") == "oil_pressure":
+        return ch.get("name", "Oil")
+    return ch.get("name", "")
+
+
+def validate(manifest, fuel_flow_meter=False, onewire=True):
+    errors = []
+    channels = manifest.get("channels")
+    if not isinstance(channels, list):
+        return ["'channels' must be an array"]
+    adc_used, input_used, rows_used, names_used = set(), set(), set(), set()
+    if fuel_flow_meter:
+        input_used.add(FUEL_FLOW_METER_INPUT)
+    for index, ch in enumerate(channels):
+        if not isinstance(ch, dict):
+            errors.append("channel %d: unknown type" % index)
+            continue
+        kind = ch.get("type", "")
+
+        def fail(message):
+            errors.append("channel %d (%s): %s" % (index, kind, message))
+
+        if kind not in KNOWN_TYPES:
+            fail("unknown type")
+            continue
+        if kind == "onewire" and not onewire:
+            fail("firmware built without ENABLE_ONE_WIRE")
+        if kind in ("tank", "temperature", "voltage") + INPUT_TYPES + (
+                "onewire",) and not isinstance(ch.get("name"), str):
+            fail("missing name")
+        if kind == "oil_pressure" and "name" in ch and not isinstance(
+                ch["name"], str):
+            fail("name must be a string")
+        if kind in RESISTIVE_TYPES and not isinstance(ch.get("sk_id"), str):
+            fail("missing sk_id")
+        if kind in ADC_TYPES:
+            adc = ch.get("channel", -1)
+            if not is_int(adc) or not 0 <= adc <= 3:
+                fail("channel must be 0-3")
+            elif adc in adc_used:
+                fail("ADC channel used twice")
+            else:
+                adc_used.add(adc)
+        if kind in INPUT_TYPES:
+            pin = ch.get("input", 0)
+            if not is_int(pin) or not 1 <= pin <= 4:
+                fail("input must be 1-4")
+            elif pin in input_used:
+                fail("digital input used twice")
+            else:
+                input_used.add(pin)
+        if "limits" in ch:
+            limits = ch["limits"]
+            if kind not in RESISTIVE_TYPES:
+                fail("limits only apply to resistive senders")
+            elif not isinstance(limits, dict) or any(
+                    key not in ("short", "min", "max", "open")
+                    or not is_number(value)
+                    for key, value in limits.items()):
+                fail("limits must map short/min/max/open to ohms")
+        if kind == "onewire" and not isinstance(ch.get("config_path"), str):
+            fail("missing config_path")
+        if "engine_flag" in ch and ch["engine_flag"] not in ENGINE_FLAGS:
+            fail("unknown engine_flag")
+        if "engine" in ch and not (is_int(ch["engine"])
+                                   and 0 <= ch["engine"] < MAX_ENGINES):
+            fail("engine instance out of range")
+        if "display_row" in ch:
+            row = ch["display_row"]
+            if not is_int(row) or row not in DISPLAY_ROWS:
+                fail("display_row must be 2-7")
+            elif row in rows_used:
+                fail("display row used twice")
+            else:
+                rows_used.add(row)
+        name = channel_name(ch)
+        if isinstance(name, str) and name:
+            if (kind, name) in names_used:
+                fail("another channel of this type has the same name")
+            names_used.add((kind, name))
+    return errors
+
+
+def estimate(manifest, signalk, n2k):
+    per_channel = []
+    total = Cost()
+    dynamic_engines, rapid_engines = set(), set()
+    onewire_bus = False
+
+    for ch in manifest["channels"]:
+        kind = ch["type"]
+        cost = Cost()
+        engine = ch.get("engine") if n2k else None
+        name = channel_name(ch)
+        if kind in RESISTIVE_TYPES:
+            cost.node("sensor")
+            cost.timer(500)
+            cost.node("curve")
+            cost.channel_strings(kind, name, ch["sk_id"])
+            # Including the sender fault output
+            sk_outputs = {"tank": 4, "temperature": 3, "oil_pressure": 3}[kind]
+            if signalk:
+                cost.node("sk_output", sk_outputs)
+                # The fault and value outputs are gated, the resistance
+                # output gated and throttled
+                cost.node("demand_gate", 3)
+                cost.node("throttle")
+            if kind == "tank":
+                if not signalk:
+                    # The level gate also feeds the volume
+                    cost.node("demand_gate")
+                cost.node("linear")
+                if n2k and "n2k" in ch:
+                    cost.node("n2k_sender")
+                    cost.text("/Tanks/%s/NMEA 2000" % name,
+                              "%s Tank NMEA 2000" % name,
+                              "NMEA 2000 tank sender for %s" % name)
+                    cost.node("lambda")
+                    cost.node("repeat_expiring")
+                    cost.timer(2500, 2)
+                    cost.path(500, SLOW_SENDER_PERIOD)
+            if kind == "oil_pressure" and engine is not None:
+                cost.node("linear")
+            if kind != "tank" and engine is not None:
+                cost.path(500, DYNAMIC_SENDER_PERIOD)
+        elif kind == "voltage":
+            cost.node("sensor")
+            cost.timer(500)
+            cost.text("/Voltage %s" % name, "Analog Voltage %s" % name,
+                      "Voltage level of analog input %s" % name)
+            if signalk and "sk_path" in ch:
+                cost.node("sk_output")
+                cost.node("demand_gate")
+                cost.text("Analog Voltage %s" % name)
+        elif kind == "tacho":
+            cost.node("sensor")
+            cost.timer(500)
+            cost.node("linear")  # Frequency
+            cost.channel_strings(kind, name, "")
+            if signalk:
+                cost.node("sk_output")
+                cost.node("demand_gate")
+            if ch.get("engine_hours"):
+                cost.node("sensor")
+                cost.timer(1000)
+                cost.text("/Engine %s/Engine Hours" % name,
+                          "Engine %s Hours" % name,
+                          "Running time of engine %s" % name)
+                if signalk:
+                    cost.node("sk_output")
+                    cost.text("propulsion.%s.runTime" % name,
+                              "Engine %s running time" % name)
+                if engine is not None:
+                    cost.node("lambda")
+                    dynamic_engines.add(engine)
+            if engine is not None:
+                rapid_engines.add(engine)
+                # The frequency is averaged over the 500 ms counter window
+                cost.path(500, RAPID_SENDER_PERIOD)
+        elif kind == "alarm":
+            cost.node("sensor")
+            cost.timer(100)
+            if signalk:
+                cost.node("sk_output")
+                cost.node("demand_gate")
+            if ch.get("inverted"):
+                cost.node("lambda")
+            if n2k and "bilge_instance" in ch:
+                cost.node("n2k_sender")
+                cost.text("/Alarm %s/Bilge" % name)
+                cost.timer(2500)
+                cost.path(100, SLOW_SENDER_PERIOD)
+            if engine is not None and "engine_flag" in ch:
+                cost.path(100, DYNAMIC_SENDER_PERIOD)
+        elif kind == "onewire":
+            if not onewire_bus:
+                cost.node("sensor")
+                onewire_bus = True
+            cost.node("sensor")
+            cost.timer(ch.get("read_delay", 500))
+            cost.text("1Wire Temp %s" % name,
+                      "Temp from 1 Wire sensor %s" % name)
+            if signalk and "sk_path" in ch:
+                cost.node("sk_output")
+                cost.node("demand_gate")
+                cost.text("1Wire Temp Value %s" % name)
+            if n2k and "exhaust_instance" in ch:
+                cost.node("n2k_sender")
+                cost.text("/Exhaust %s" % name)
+                cost.timer(2500)
+                cost.path(ch.get("read_delay", 500), SLOW_SENDER_PERIOD)
+        if engine is not None and kind != "tacho":
+            dynamic_engines.add(engine)
+        if "display_row" in ch:
+            cost.node("throttle")
+            cost.node("display_row")
+            cost.text(ch.get("display_title", name))
+        per_channel.append((ch.get("name", ch.get("sk_id", "?")), kind, cost))
+
+    for engine in sorted(dynamic_engines):
+        cost = Cost()
+        cost.node("n2k_sender")
+        cost.node("repeat_expiring", DYNAMIC_SENDER_INPUTS)
+        cost.text("/NMEA 2000/Engine %d Dynamic" % (engine + 1),
+                  "Engine %d Dynamic" % (engine + 1),
+                  "NMEA 2000 dynamic engine parameters for engine %d" %
+                  (engine + 1))
+        cost.timer(500, DYNAMIC_SENDER_INPUTS + 1)
+        per_channel.append(("engine %d" % engine, "127489 dynamic", cost))
+    for engine in sorted(rapid_engines):
+        cost = Cost()
+        cost.node("n2k_sender")
+        cost.node("lambda")
+        cost.node("repeat_expiring", RAPID_SENDER_INPUTS)
+        cost.text("/NMEA 2000/Engine %d Rapid Update" % (engine + 1),
+                  "Engine %d Rapid Update" % (engine + 1),
+                  "NMEA 2000 rapid update engine parameters for engine %d" %
+                  (engine + 1))
+        cost.timer(100, RAPID_SENDER_INPUTS + 1)
+        per_channel.append(("engine %d" % engine, "127488 rapid", cost))
+
+    for _, _, cost in per_channel:
+        total.bytes += cost.bytes
+        total.arena_bytes += cost.arena_bytes
+        total.timers += cost.timers
+        total.firings_per_s += cost.firings_per_s
+    return per_channel, total
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("manifest")
+    parser.add_argument("--no-signalk", action="store_true",
+                        help="firmware built without ENABLE_SIGNALK")
+    parser.add_argument("--no-n2k", action="store_true",
+                        help="firmware built without ENABLE_NMEA2000_OUTPUT")
+    parser.add_argument("--no-onewire", action="store_true",
+                        help="firmware built without ENABLE_ONE_WIRE")
+    parser.add_argument("--fuel-flow-meter", action="store_true",
+                        help="firmware built with ENABLE_FUEL_FLOW_METER, "
+                        "which uses input 4")
+    parser.add_argument("--max-latency", type=int, metavar="MS",
+                        help="fail if an input-to-bus latency exceeds MS")
+    parser.add_argument("--arena-size", type=int, metavar="BYTES",
+                        default=DEFAULT_ARENA_SIZE,
+                        help="graph arena size (STATIC_ARENA_SIZE), "
+                        "default %(default)d")
+    parser.add_argument("--node-bytes", metavar="LOG",
+                        help="boot log of a firmware built with "
+                        "ENABLE_STATIC_ARENA, for the measured node sizes")
+    args = parser.parse_args()
+
+    if args.node_bytes is not None:
+        try:
+            NODE_BYTES.update(read_node_bytes(args.node_bytes))
+        except (OSError, ValueError) as e:
+            print("error: %s" % e, file=sys.stderr)
+            return 1
+
+    with open(args.manifest) as f:
+        manifest = json.load(f)
+
+    errors = validate(manifest, args.fuel_flow_meter, not args.no_onewire)
+    for error in errors:
+        print("error: " + error, file=sys.stderr)
+    if errors:
+        return 1
+
+    per_channel, total = estimate(manifest, not args.no_signalk,
+                                  not args.no_n2k)
+    print("%-12s %-16s %8s %7s %10s %11s" % ("channel", "type", "bytes",
+                                             "timers", "firings/s",
+                                             "latency ms"))
+    too_slow = []
+    for name, kind, cost in per_channel:
+        latency = "-" if cost.latency_ms is None else "%d" % cost.latency_ms
+        print("%-12s %-16s %8d %7d %10.1f %11s" % (
+            name, kind, cost.bytes, cost.timers, cost.firings_per_s, latency))
+        if (args.max_latency is not None and cost.latency_ms is not None
+                and cost.latency_ms > args.max_latency):
+            too_slow.append(name)
+    print("%-12s %-16s %8d %7d %10.1f" % ("total", "", total.bytes,
+                                          total.timers, total.firings_per_s))
+    print("arena: %d bytes used, %d bytes left of %d by the channels (%s "
+          "node sizes)" % (total.arena_bytes,
+                           args.arena_size - total.arena_bytes,
+                           args.arena_size,
+                           "estimated" if args.node_bytes is None
+                           else "measured"))
+    for name in too_slow:
+        print("error: %s exceeds %d ms from input to bus" %
+              (name, args.max_latency), file=sys.stderr)
+    if total.arena_bytes > args.arena_size:
+        print("error: the channels need about %d bytes of graph arena; "
+              "increase STATIC_ARENA_SIZE" % total.arena_bytes,
+              file=sys.stderr)
+    return 2 if too_slow or total.arena_bytes > args.arena_size else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""Receive and decode the HALMET binary telemetry stream.
+
+Usage: tools/telemetry_decode.py <halmet host> [--port 4210]
+
+The schema is fetched once from http://<host>/telemetry/schema and fetched
+again whenever a frame carries a different schema id. The frame format is
+described in src/binary_telemetry.h.
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+import urllib.request
+
+MAGIC = 0x5448
+HEADER = struct.Struct("<HBBHHI")
+CHANNEL = struct.Struct("<BHh")
+NOT_AVAILABLE = -32768
+
+
+def fetch_schema(host):
+    with urllib.request.urlopen("http://%s/telemetry/schema" % host) as f:
+        return json.load(f)
+
+
+def decode(frame, schema):
+    """Return (sequence, timestamp_ms, {name: (value, age_ms)}).
+
+    Raises ValueError for frames that do not match the schema.
+    """
+    magic, version, count, sequence, schema_id, timestamp = \
+        HEADER.unpack_from(frame, 0)
+    if magic != MAGIC or version != schema["version"]:
+        raise ValueError("not a telemetry frame")
+    if schema_id != schema["schema_id"]:
+        raise ValueError("schema changed")
+    channels = schema["channels"]
+    values = {}
+    for i in range(count):
+        channel_id, age, packed = CHANNEL.unpack_from(
+            frame, HEADER.size + i * CHANNEL.size)
+        channel = channels[channel_id]
+        value = None if packed == NOT_AVAILABLE else packed / channel["scale"]
+        values[channel["name"]] = (value, age)
+    return sequence, timestamp, values
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=4210)
+    args = parser.parse_args()
+
+    schema = fetch_schema(args.host)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(("", args.port))
+
+    while True:
+        frame, _ = sock.recvfrom(1500)
+        try:
+            sequence, timestamp, values = decode(frame, schema)
+        except ValueError as e:
+            if str(e) != "schema changed":
+                continue
+            schema = fetch_schema(args.host)
+            sequence, timestamp, values = decode(frame, schema)
+        print("%5d %10.3f  %s" % (sequence, timestamp / 1000.0, "  ".join(
+            "%s=%s" % (name, "n/a" if value is None else "%.2f" % value)
+            for name, (value, _) in values.items())))
+        sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    sys.exit(main())